@@ -36,7 +36,7 @@ typedef Common::BinSearchValue<uint32, const char *> SonicFileHash;
 
 /** All currently known Sonic file names, together with their DJB2 hashes.
  *
- *  Note: For the binary search to work, this list needs to stay sorted by hash value!
+ *  Note: For the search to work, this list needs to stay sorted by hash value!
  */
 static const SonicFileHash kSonicFilesHashes[] = {
 	{0x00021EC9, "prtl_gglgen_1.ncgr.small"            },
@@ -8755,7 +8755,11 @@ static const SonicFileHash kSonicFilesHashes[] = {
 };
 
 const char *findSonicFile(uint32 hash) {
-	const SonicFileHash *file = Common::binarySearch(kSonicFilesHashes, ARRAYSIZE(kSonicFilesHashes), hash);
+	// Built on first use, since this is looked up once per resource in hashed archives
+	static const Common::EytzingerIndex<uint32, const char *>
+		kSonicFilesIndex(kSonicFilesHashes, ARRAYSIZE(kSonicFilesHashes));
+
+	const SonicFileHash *file = kSonicFilesIndex.find(hash);
 	if (!file)
 		return 0;
 
@@ -25,6 +25,8 @@
 #include <cstdio>
 
 #include <vector>
+#include <mutex>
+#include <exception>
 
 #include "src/common/util.h"
 #include "src/common/strutil.h"
@@ -34,6 +36,8 @@
 #include "src/common/filepath.h"
 #include "src/common/readstream.h"
 #include "src/common/writefile.h"
+#include "src/common/ptrvector.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/util.h"
 #include "src/aurora/archive.h"
@@ -193,13 +197,37 @@ static void dumpStream(Common::SeekableReadStream &stream, const Common::UString
 	file.close();
 }
 
-void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
-                  const std::set<Common::UString> &files) {
+/** A resource to be extracted. */
+struct ExtractJob {
+	uint32 index;  ///< The resource's index within the archive.
+	size_t number; ///< The resource's position in the archive, for the progress display.
+
+	Aurora::FileType type; ///< The resource's type, aliased for the game.
+
+	Common::UString name;   ///< The file to extract the resource to.
+	Common::UString target; ///< The file to convert the resource into, if any.
+
+	bool done; ///< Has this job finished?
+
+	std::exception_ptr error;        ///< The exception thrown by this job, if any.
+	std::exception_ptr convertError; ///< The exception thrown by converting the resource, if any.
+
+	ExtractJob(uint32 i, size_t n, Aurora::FileType t, const Common::UString &na) :
+		index(i), number(n), type(t), name(na), done(false) { }
+};
+
+/** Figure out which resources to extract into which files.
+ *
+ *  This also creates the directories the files go into, so it must not
+ *  run concurrently with anything else using the type manager.
+ */
+static void createExtractJobs(std::vector<ExtractJob> &jobs, const Aurora::Archive &archive,
+                              Aurora::GameID game, bool directories, const std::set<Common::UString> &files,
+                              const ResourceConverter &converter) {
 
 	const Aurora::Archive::ResourceList &resources = archive.getResources();
-	const size_t fileCount = resources.size();
 
-	std::printf("Number of files: %s\n\n", Common::composeString(fileCount).c_str());
+	jobs.reserve(resources.size());
 
 	size_t i = 1;
 	for (Aurora::Archive::ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r, ++i) {
@@ -216,23 +244,182 @@ void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool dire
 		if (directories && !dirName.empty())
 			Common::FilePath::createDirectories(dirName);
 
-		std::printf("Extracting %s/%s: %s ... ", Common::composeString(i).c_str(),
-		                                         Common::composeString(fileCount).c_str(),
-		                                         name.c_str());
+		jobs.push_back(ExtractJob(r->index, i, type, name));
+
+		if (converter.getTarget && converter.convert)
+			jobs.back().target = converter.getTarget(type, name);
+	}
+
+	/* Several resources might be converted into the same file, for example
+	 * foo.dds and foo.tpc into foo.tga, or into the file of a resource that is
+	 * extracted as is. Only convert the first of them, and extract the others
+	 * as is, so that no two resources write the same file. */
+
+	std::set<Common::UString> written;
+	for (std::vector<ExtractJob>::const_iterator j = jobs.begin(); j != jobs.end(); ++j)
+		if (j->target.empty())
+			written.insert(j->name);
+
+	for (std::vector<ExtractJob>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		if (j->target.empty())
+			continue;
+
+		if (!written.insert(j->target).second) {
+			warning("Not converting \"%s\": \"%s\" is already written by another resource",
+			        j->name.c_str(), j->target.c_str());
+
+			j->target.clear();
+		}
+	}
+}
+
+/** Extract or convert this resource. */
+static void extractResource(Common::SeekableReadStream &stream, ExtractJob &job,
+                            const ResourceConverter &converter) {
+
+	if (!job.target.empty()) {
+		try {
+			converter.convert(stream, job.type, job.target);
+			return;
+		} catch (Common::Exception &) {
+			/* The conversion failed, so just extract the resource as is. Don't
+			 * leave a partially written target file lying around, though. */
+			job.convertError = std::current_exception();
+
+			std::remove(job.target.c_str());
+			stream.seek(0);
+		}
+	}
+
+	dumpStream(stream, job.name);
+}
+
+static void printExtractStart(const ExtractJob &job, size_t fileCount) {
+	std::printf("Extracting %s/%s: %s ... ", Common::composeString(job.number).c_str(),
+	                                         Common::composeString(fileCount).c_str(),
+	                                         job.name.c_str());
+}
+
+static void printExtractDone(const ExtractJob &job) {
+	if (!job.convertError) {
+		std::printf("Done\n");
+		return;
+	}
+
+	std::printf("Done (failed to convert, extracted as is)\n");
+	std::fflush(stdout);
+
+	try {
+		std::rethrow_exception(job.convertError);
+	} catch (Common::Exception &e) {
+		Common::printException(e, "WARNING: ");
+	}
+}
+
+void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
+                  const std::set<Common::UString> &files, const ResourceConverter &converter) {
+
+	const size_t fileCount = archive.getResources().size();
+
+	std::printf("Number of files: %s\n\n", Common::composeString(fileCount).c_str());
+
+	std::vector<ExtractJob> jobs;
+	createExtractJobs(jobs, archive, game, directories, files, converter);
+
+	for (std::vector<ExtractJob>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		printExtractStart(*j, fileCount);
 		std::fflush(stdout);
 
 		try {
-			Common::ScopedPtr<Common::SeekableReadStream> stream(archive.getResource(r->index));
+			Common::ScopedPtr<Common::SeekableReadStream> stream(archive.getResource(j->index, true));
 
-			dumpStream(*stream, name);
+			extractResource(*stream, *j, converter);
 
-			std::printf("Done\n");
+			printExtractDone(*j);
 		} catch (Common::Exception &e) {
 			Common::printException(e, "");
 		}
 	}
 }
 
+static void printExtractJob(const ExtractJob &job, size_t fileCount) {
+	printExtractStart(job, fileCount);
+
+	if (!job.error) {
+		printExtractDone(job);
+		return;
+	}
+
+	std::fflush(stdout);
+
+	try {
+		std::rethrow_exception(job.error);
+	} catch (Common::Exception &e) {
+		Common::printException(e, "");
+	}
+}
+
+void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
+                  const std::set<Common::UString> &files, size_t threadCount, const ArchiveOpener &opener,
+                  const ResourceConverter &converter) {
+
+	if (threadCount == 0)
+		threadCount = Common::getHardwareThreadCount();
+
+	if ((threadCount <= 1) || !opener) {
+		extractFiles(archive, game, directories, files, converter);
+		return;
+	}
+
+	const size_t fileCount = archive.getResources().size();
+
+	std::printf("Number of files: %s\n\n", Common::composeString(fileCount).c_str());
+
+	/* Figure out the file names up front, in this thread. The type manager,
+	 * as well as creating directories, is not safe to be used concurrently. */
+
+	std::vector<ExtractJob> jobs;
+	createExtractJobs(jobs, archive, game, directories, files, converter);
+
+	threadCount = MIN(threadCount, jobs.size());
+
+	/* Every thread needs its own read handle on the archive. The first thread
+	 * uses the archive we were given, the others get freshly opened copies.
+	 * We open them here, because loading an archive might need the (not
+	 * thread-safe) encoding conversion. */
+
+	Common::PtrVector<Aurora::Archive> handles;
+	handles.resize(threadCount);
+
+	std::vector<const Aurora::Archive *> archives(threadCount, &archive);
+	for (size_t t = 1; t < threadCount; t++)
+		archives[t] = handles[t] = opener();
+
+	/* Print the progress in archive order. Whichever thread finishes the job
+	 * we're waiting on also prints all the finished jobs following it. */
+
+	std::mutex printMutex;
+	size_t nextPrint = 0;
+
+	Common::runParallel(threadCount, jobs.size(), [&](size_t worker, size_t j) {
+		ExtractJob &job = jobs[j];
+
+		try {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(archives[worker]->getResource(job.index, true));
+
+			extractResource(*stream, job, converter);
+		} catch (Common::Exception &) {
+			job.error = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock(printMutex);
+
+		job.done = true;
+		while ((nextPrint < jobs.size()) && jobs[nextPrint].done)
+			printExtractJob(jobs[nextPrint++], fileCount);
+	});
+}
+
 void extractFiles(const Aurora::NSBTXFile &nsbtx, const std::set<Common::UString> &files,
                   void (*dumper)(Common::SeekableReadStream &stream, const Common::UString &fileName)) {
 
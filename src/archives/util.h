@@ -26,11 +26,16 @@
 #define ARCHIVES_UTIL_H
 
 #include <set>
+#include <functional>
 
 #include "src/common/ustring.h"
 
 #include "src/aurora/types.h"
 
+namespace Common {
+	class SeekableReadStream;
+}
+
 namespace Aurora {
 	class Archive;
 
@@ -53,6 +58,32 @@ void listFiles(const Aurora::KEYFile &key, const Common::UString &keyName, Auror
 /** List the images found in an NSBTX file on stdout. */
 void listFiles(const Aurora::NSBTXFile &nsbtx);
 
+/** Converting resources while they are extracted.
+ *
+ *  For each resource, getTarget() is called with its type and the name of the
+ *  file the resource would have been extracted to. If it returns the name of
+ *  a file to convert the resource into, convert() is called with the
+ *  resource's data to write it. Otherwise, the resource is extracted as is.
+ *
+ *  Resources whose conversion would write a file already written by another
+ *  resource, as well as resources whose conversion fails, are extracted as is.
+ *
+ *  When extracting with several threads, convert() is called from all of them
+ *  at the same time.
+ */
+struct ResourceConverter {
+	typedef std::function<Common::UString (Aurora::FileType type,
+	                                       const Common::UString &fileName)> TargetFunc;
+	typedef std::function<void (Common::SeekableReadStream &stream, Aurora::FileType type,
+	                            const Common::UString &target)> ConvertFunc;
+
+	TargetFunc getTarget;
+	ConvertFunc convert;
+
+	ResourceConverter() { }
+	ResourceConverter(const TargetFunc &t, const ConvertFunc &c) : getTarget(t), convert(c) { }
+};
+
 /** Extract files from an archive.
  *
  *  @param archive The archive to extract from.
@@ -61,9 +92,35 @@ void listFiles(const Aurora::NSBTXFile &nsbtx);
  *         will be written directly into the current directory.
  *  @param files A list of files to extract. If empty, all files from the archive will be
  *         extracted.
+ *  @param converter If given, convert the resources it handles instead of writing them as is.
+ */
+void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
+                  const std::set<Common::UString> &files,
+                  const ResourceConverter &converter = ResourceConverter());
+
+/** A function opening a new, independent instance of an archive. */
+typedef std::function<Aurora::Archive *()> ArchiveOpener;
+
+/** Extract files from an archive, using several threads.
+ *
+ *  Each thread reads from its own instance of the archive: the first one
+ *  uses the archive given, while the others are opened with the opener.
+ *  The progress is still printed in archive order.
+ *
+ *  @param archive The archive to extract from.
+ *  @param game The game to alias types with.
+ *  @param directories Create directories? If false, directories will be stripped and the file
+ *         will be written directly into the current directory.
+ *  @param files A list of files to extract. If empty, all files from the archive will be
+ *         extracted.
+ *  @param threadCount The number of threads to use. 0 means one per CPU core.
+ *  @param opener Opens another instance of the archive. If empty, the files are extracted
+ *         one by one, in this thread.
+ *  @param converter If given, convert the resources it handles instead of writing them as is.
  */
 void extractFiles(const Aurora::Archive &archive, Aurora::GameID game, bool directories,
-                  const std::set<Common::UString> &files);
+                  const std::set<Common::UString> &files, size_t threadCount, const ArchiveOpener &opener,
+                  const ResourceConverter &converter = ResourceConverter());
 
 /** Extract files from an NSBTX. */
 void extractFiles(const Aurora::NSBTXFile &nsbtx, const std::set<Common::UString> &files,
@@ -23,6 +23,9 @@
  */
 
 #include "src/common/system.h"
+#include "src/common/readstream.h"
+#include "src/common/writestream.h"
+#include "src/common/encoding.h"
 
 #include "src/aurora/archive.h"
 
@@ -31,7 +34,18 @@ namespace Aurora {
 Archive::Resource::Resource() : hash(0), type(kFileTypeNone), index(0xFFFFFFFF) {
 }
 
-Archive::Archive() {
+Archive::NameTypeKey::NameTypeKey(const Common::UString &n, FileType t) : name(n), type(t) {
+}
+
+bool Archive::NameTypeKey::operator==(const NameTypeKey &key) const {
+	return (type == key.type) && name.equalsIgnoreCase(key.name);
+}
+
+size_t Archive::hashNameTypeKey::operator()(const NameTypeKey &key) const {
+	return Common::hashUStringCaseInsensitive()(key.name) * 31 + (size_t) key.type;
+}
+
+Archive::Archive() : _hasIndex(false) {
 }
 
 Archive::~Archive() {
@@ -45,23 +59,90 @@ Common::HashAlgo Archive::getNameHashAlgo() const {
 	return Common::kHashNone;
 }
 
+void Archive::invalidateResourceIndex() {
+	std::lock_guard<std::mutex> lock(_indexMutex);
+
+	_hasIndex.store(false, std::memory_order_release);
+
+	_hashIndex.clear();
+	_nameIndex.clear();
+}
+
+void Archive::buildResourceIndex() const {
+	if (_hasIndex.load(std::memory_order_acquire))
+		return;
+
+	std::lock_guard<std::mutex> lock(_indexMutex);
+
+	// Another thread might have built the index while we were waiting for the lock
+	if (_hasIndex.load(std::memory_order_relaxed))
+		return;
+
+	const ResourceList &resources = getResources();
+
+	_hashIndex.clear();
+	_nameIndex.clear();
+
+	_hashIndex.reserve(resources.size());
+	_nameIndex.reserve(resources.size());
+
+	// insert() never overwrites, so the first resource of a name wins, like in a linear search
+	for (ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+		_hashIndex.insert(std::make_pair(r->hash, r->index));
+		_nameIndex.insert(std::make_pair(NameTypeKey(r->name, r->type), r->index));
+	}
+
+	_hasIndex.store(true, std::memory_order_release);
+}
+
 uint32 Archive::findResource(uint64 hash) const {
 	if (getNameHashAlgo() == Common::kHashNone)
 		return 0xFFFFFFFF;
 
-	for (ResourceList::const_iterator r = getResources().begin(); r != getResources().end(); ++r)
-		if (r->hash == hash)
-			return r->index;
+	buildResourceIndex();
 
-	return 0xFFFFFFFF;
+	HashIndex::const_iterator r = _hashIndex.find(hash);
+	if (r == _hashIndex.end())
+		return 0xFFFFFFFF;
+
+	return r->second;
 }
 
 uint32 Archive::findResource(const Common::UString &name, FileType type) const {
-	for (ResourceList::const_iterator r = getResources().begin(); r != getResources().end(); ++r)
-		if ((r->type == type) && (r->name == name))
-			return r->index;
+	buildResourceIndex();
 
-	return 0xFFFFFFFF;
+	NameIndex::const_iterator r = _nameIndex.find(NameTypeKey(name, type));
+	if (r == _nameIndex.end())
+		return 0xFFFFFFFF;
+
+	return r->second;
+}
+
+void Archive::writeIndexResources(Common::WriteStream &index, const ResourceList &resources) {
+	index.writeUint32LE(resources.size());
+
+	for (ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+		Common::writeString(index, r->name, Common::kEncodingUTF8);
+
+		index.writeUint64LE(r->hash);
+		index.writeUint32LE((uint32) r->type);
+		index.writeUint32LE(r->index);
+	}
+}
+
+void Archive::readIndexResources(Common::SeekableReadStream &index, ResourceList &resources) {
+	resources.clear();
+
+	const uint32 count = index.readUint32LE();
+	for (uint32 i = 0; i < count; i++) {
+		resources.push_back(Resource());
+		Resource &r = resources.back();
+
+		r.name  = Common::readString(index, Common::kEncodingUTF8);
+		r.hash  = index.readUint64LE();
+		r.type  = (FileType) index.readUint32LE();
+		r.index = index.readUint32LE();
+	}
 }
 
 } // End of namespace Aurora
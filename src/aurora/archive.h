@@ -26,8 +26,11 @@
 #define AURORA_ARCHIVE_H
 
 #include <list>
+#include <mutex>
+#include <atomic>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
@@ -37,6 +40,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 }
 
 namespace Aurora {
@@ -76,10 +80,60 @@ public:
 	/** Return with which algorithm the name is hashed. */
 	virtual Common::HashAlgo getNameHashAlgo() const;
 
-	/** Return the index of the resource matching the hash, or 0xFFFFFFFF if not found. */
+	/** Return the index of the resource matching the hash, or 0xFFFFFFFF if not found.
+	 *
+	 *  Like getResource(), this can be called from several threads at once.
+	 */
 	uint32 findResource(uint64 hash) const;
-	/** Return the index of the resource matching the name and type, or 0xFFFFFFFF if not found. */
+	/** Return the index of the resource matching the name and type, or 0xFFFFFFFF if not found.
+	 *
+	 *  The name is matched case-insensitively. Like getResource(), this can
+	 *  be called from several threads at once.
+	 */
 	uint32 findResource(const Common::UString &name, FileType type) const;
+
+protected:
+	/** Drop the resource lookup index, because the resource list has changed.
+	 *
+	 *  The index is rebuilt on the next call to findResource(). Like any
+	 *  change to the resource list, this must not run concurrently with
+	 *  lookups.
+	 */
+	void invalidateResourceIndex();
+
+	/** Write a list of resources into an archive index, see IndexCache. */
+	static void writeIndexResources(Common::WriteStream &index, const ResourceList &resources);
+	/** Read a list of resources written by writeIndexResources() out of an archive index. */
+	static void readIndexResources(Common::SeekableReadStream &index, ResourceList &resources);
+
+private:
+	/** A resource's name and type, as a key for the name lookup index. */
+	struct NameTypeKey {
+		Common::UString name;
+		FileType        type;
+
+		NameTypeKey(const Common::UString &n, FileType t);
+
+		bool operator==(const NameTypeKey &key) const;
+	};
+
+	struct hashNameTypeKey {
+		size_t operator()(const NameTypeKey &key) const;
+	};
+
+	typedef boost::unordered_map<uint64, uint32> HashIndex;
+	typedef boost::unordered_map<NameTypeKey, uint32, hashNameTypeKey> NameIndex;
+
+	/** Has the lookup index been built? Only set once the index is complete. */
+	mutable std::atomic<bool> _hasIndex;
+	/** Serializes building the lookup index, on the first lookups from several threads. */
+	mutable std::mutex _indexMutex;
+
+	mutable HashIndex _hashIndex; ///< Resource indices by hashed name.
+	mutable NameIndex _nameIndex; ///< Resource indices by name and type.
+
+	/** Build the lookup index, if it doesn't already exist. Thread-safe. */
+	void buildResourceIndex() const;
 };
 
 } // End of namespace Aurora
@@ -98,10 +98,10 @@ void BIFFile::readVarResTable(Common::SeekableReadStream &bif, uint32 offset) {
 
 void BIFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 	const KEYFile::ResourceList &keyResList = key.getResources();
+	const KEYFile::ResourceIndexList &keyResIndices = key.getBIFResources(dataFileIndex);
 
-	for (KEYFile::ResourceList::const_iterator keyRes = keyResList.begin(); keyRes != keyResList.end(); ++keyRes) {
-		if (keyRes->bifIndex != dataFileIndex)
-			continue;
+	for (KEYFile::ResourceIndexList::const_iterator i = keyResIndices.begin(); i != keyResIndices.end(); ++i) {
+		const KEYFile::Resource *keyRes = &keyResList[*i];
 
 		if (keyRes->resIndex >= _iResources.size()) {
 			warning("Resource index out of range (%d/%d)", keyRes->resIndex, (int) _iResources.size());
@@ -121,6 +121,7 @@ void BIFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 		_resources.push_back(res);
 	}
 
+	invalidateResourceIndex();
 }
 
 uint32 BIFFile::getInternalResourceCount() const {
@@ -146,11 +147,9 @@ Common::SeekableReadStream *BIFFile::getResource(uint32 index, bool tryNoCopy) c
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_bif.get(), res.offset, res.offset + res.size);
-
-	_bif->seek(res.offset);
+		return _bif->getPositionalSubStream(res.offset, res.offset + res.size);
 
-	return _bif->readStream(res.size);
+	return _bif->readStreamAt(res.offset, res.size);
 }
 
 } // End of namespace Aurora
@@ -30,6 +30,7 @@
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
 #include "src/common/lzma.h"
 
@@ -100,10 +101,10 @@ void BZFFile::readVarResTable(Common::SeekableReadStream &bzf, uint32 offset) {
 
 void BZFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 	const KEYFile::ResourceList &keyResList = key.getResources();
+	const KEYFile::ResourceIndexList &keyResIndices = key.getBIFResources(dataFileIndex);
 
-	for (KEYFile::ResourceList::const_iterator keyRes = keyResList.begin(); keyRes != keyResList.end(); ++keyRes) {
-		if (keyRes->bifIndex != dataFileIndex)
-			continue;
+	for (KEYFile::ResourceIndexList::const_iterator i = keyResIndices.begin(); i != keyResIndices.end(); ++i) {
+		const KEYFile::Resource *keyRes = &keyResList[*i];
 
 		if (keyRes->resIndex >= _iResources.size()) {
 			warning("Resource index out of range (%d/%d)", keyRes->resIndex, (int) _iResources.size());
@@ -123,6 +124,7 @@ void BZFFile::mergeKEY(const KEYFile &key, uint32 dataFileIndex) {
 		_resources.push_back(res);
 	}
 
+	invalidateResourceIndex();
 }
 
 uint32 BZFFile::getInternalResourceCount() const {
@@ -147,9 +149,16 @@ uint32 BZFFile::getResourceSize(uint32 index) const {
 Common::SeekableReadStream *BZFFile::getResource(uint32 index, bool UNUSED(tryNoCopy)) const {
 	const IResource &res = getIResource(index);
 
-	_bzf->seek(res.offset);
+	Common::ScopedPtr<Common::SeekableReadStream>
+		packed(_bzf->getPositionalSubStream(res.offset, res.offset + res.packedSize));
+
+	// Decompress directly out of the BZF's memory, if we can
+	const byte *packedData = packed->getData();
+	if (packedData)
+		return new Common::MemoryReadStream(Common::decompressLZMA1(packedData, res.packedSize, res.size, true),
+		                                    res.size, true);
 
-	return Common::decompressLZMA1(*_bzf, res.packedSize, res.size, true);
+	return Common::decompressLZMA1(*packed, res.packedSize, res.size, true);
 }
 
 } // End of namespace Aurora
@@ -30,6 +30,7 @@
 
 #include "src/common/memreadstream.h"
 #include "src/common/readfile.h"
+#include "src/common/writestream.h"
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
@@ -155,6 +156,12 @@ ERFFile::ERFFile(Common::SeekableReadStream *erf, const std::vector<byte> &passw
 	load();
 }
 
+ERFFile::ERFFile(Common::SeekableReadStream *erf, Common::SeekableReadStream &index) : _erf(erf) {
+	assert(_erf);
+
+	loadIndex(index);
+}
+
 ERFFile::~ERFFile() {
 }
 
@@ -299,6 +306,78 @@ void ERFFile::load() {
 
 }
 
+bool ERFFile::writeIndex(Common::WriteStream &index) const {
+	/* An encrypted ERF always comes with a password, and needs the full
+	 * treatment of password verification or decryption on load. */
+	if (!_password.empty() || (_header.encryption != kEncryptionNone))
+		return false;
+
+	index.writeUint32BE(_id);
+	index.writeUint32BE(_version);
+	index.writeByte(_utf16le ? 1 : 0);
+
+	index.writeUint32LE(_header.resCount);
+	index.writeUint32LE(_header.langCount);
+	index.writeUint32LE(_header.descriptionID);
+	index.writeUint32LE(_header.offDescription);
+	index.writeUint32LE(_header.descriptionSize);
+	index.writeUint32LE(_header.buildYear);
+	index.writeUint32LE(_header.buildDay);
+	index.writeUint32LE(_header.moduleID);
+	index.writeUint32LE((uint32) _header.compression);
+
+	writeIndexResources(index, _resources);
+
+	index.writeUint32LE(_iResources.size());
+	for (IResourceList::const_iterator r = _iResources.begin(); r != _iResources.end(); ++r) {
+		index.writeUint32LE(r->offset);
+		index.writeUint32LE(r->packedSize);
+		index.writeUint32LE(r->unpackedSize);
+	}
+
+	return true;
+}
+
+void ERFFile::loadIndex(Common::SeekableReadStream &index) {
+	_id      = index.readUint32BE();
+	_version = index.readUint32BE();
+	_utf16le = index.readByte() != 0;
+
+	verifyVersion(_id, _version, _utf16le);
+
+	try {
+
+		_header.resCount        = index.readUint32LE();
+		_header.langCount       = index.readUint32LE();
+		_header.descriptionID   = index.readUint32LE();
+		_header.offDescription  = index.readUint32LE();
+		_header.descriptionSize = index.readUint32LE();
+		_header.buildYear       = index.readUint32LE();
+		_header.buildDay        = index.readUint32LE();
+		_header.moduleID        = index.readUint32LE();
+		_header.compression     = (Compression) index.readUint32LE();
+
+		// The description is small enough to be read out of the ERF itself
+		readDescription(_description, *_erf, _header);
+
+		readIndexResources(index, _resources);
+
+		_iResources.resize(index.readUint32LE());
+		for (IResourceList::iterator r = _iResources.begin(); r != _iResources.end(); ++r) {
+			r->offset       = index.readUint32LE();
+			r->packedSize   = index.readUint32LE();
+			r->unpackedSize = index.readUint32LE();
+		}
+
+		if ((_resources.size() != _header.resCount) || (_iResources.size() != _header.resCount))
+			throw Common::Exception("Resource count mismatch");
+
+	} catch (Common::Exception &e) {
+		e.add("Failed reading ERF index");
+		throw;
+	}
+}
+
 void ERFFile::decryptNWNPremium() {
 	assert(_header.encryption == kEncryptionBlowfishNWN);
 
@@ -713,12 +792,29 @@ Common::SeekableReadStream *ERFFile::getResource(uint32 index, bool tryNoCopy) c
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy && (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone))
-		return new Common::SeekableSubReadStream(_erf.get(), res.offset, res.offset + res.packedSize);
-
-	_erf->seek(res.offset);
+		return _erf->getPositionalSubStream(res.offset, res.offset + res.packedSize);
 
 	// Read
-	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
+	Common::SeekableReadStream *stream = 0;
+
+	if (tryNoCopy && (_header.encryption == kEncryptionNone)) {
+		/* The caller doesn't need a copy, so we can decompress on demand,
+		 * straight out of the ERF, while the resource is being read. */
+
+		stream = _erf->getPositionalSubStream(res.offset, res.offset + res.packedSize);
+
+	} else if ((_header.encryption != kEncryptionNone) && _erf->getData()) {
+		/* The ERF is already fully in memory (or memory-mapped), and decryption
+		 * creates a new buffer anyway. So we can work directly on the packed
+		 * data, without copying it first. */
+
+		if ((res.offset > _erf->size()) || (res.packedSize > (_erf->size() - res.offset)))
+			throw Common::Exception(Common::kReadError);
+
+		stream = new Common::MemoryReadStream(_erf->getData() + res.offset, res.packedSize);
+
+	} else
+		stream = _erf->readStreamAt(res.offset, res.packedSize);
 
 	// Decrypt
 	if (_header.encryption != kEncryptionNone)
@@ -763,10 +859,10 @@ Common::SeekableReadStream *ERFFile::decrypt(Common::SeekableReadStream &erf, si
 	return decrypt(erf, erf.pos(), size, encryption, password);
 }
 
-Common::SeekableReadStream *ERFFile::decompress(Common::MemoryReadStream *packedStream,
+Common::SeekableReadStream *ERFFile::decompress(Common::SeekableReadStream *packedStream,
                                                 uint32 unpackedSize) const {
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
+	Common::ScopedPtr<Common::SeekableReadStream> stream(packedStream);
 
 	switch (_header.compression) {
 		case kCompressionNone:
@@ -791,58 +887,46 @@ Common::SeekableReadStream *ERFFile::decompress(Common::MemoryReadStream *packed
 	throw Common::Exception("Invalid ERF compression %u", (uint) _header.compression);
 }
 
-Common::SeekableReadStream *ERFFile::decompressBiowareZlib(Common::MemoryReadStream *packedStream,
+Common::SeekableReadStream *ERFFile::decompressBiowareZlib(Common::SeekableReadStream *packedStream,
                                                            uint32 unpackedSize) const {
 
 	/* Decompress using raw inflate. An extra one byte header specifies the window size. */
 
 	assert(packedStream);
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
+	Common::ScopedPtr<Common::SeekableReadStream> stream(packedStream);
 
-	const byte * const compressedData = stream->getData();
-	const uint32 packedSize = stream->size();
+	const byte windowBits = stream->readByte() >> 4;
 
-	return decompressZlib(compressedData + 1, packedSize - 1, unpackedSize, *compressedData >> 4);
+	return decompressZlib(stream.release(), unpackedSize, windowBits);
 }
 
-Common::SeekableReadStream *ERFFile::decompressHeaderlessZlib(Common::MemoryReadStream *packedStream,
+Common::SeekableReadStream *ERFFile::decompressHeaderlessZlib(Common::SeekableReadStream *packedStream,
                                                               uint32 unpackedSize) const {
 
 	/* Decompress using raw inflate. Use the default maximum window size (15). */
 
 	assert(packedStream);
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
-
-	const byte * const compressedData = stream->getData();
-	const uint32 packedSize = stream->size();
-
-	return decompressZlib(compressedData, packedSize, unpackedSize, Common::kWindowBitsMax);
+	return decompressZlib(packedStream, unpackedSize, Common::kWindowBitsMax);
 }
 
-Common::SeekableReadStream *ERFFile::decompressStandardZlib(Common::MemoryReadStream *packedStream,
+Common::SeekableReadStream *ERFFile::decompressStandardZlib(Common::SeekableReadStream *packedStream,
                                                             uint32 unpackedSize) const {
 
 	/* Decompress using raw inflate. Use the default maximum window size (15), and with zlib header. */
 
 	assert(packedStream);
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream);
-
-	const byte * const compressedData = stream->getData();
-	const uint32 packedSize = stream->size();
-
-	return decompressZlib(compressedData, packedSize, unpackedSize, -Common::kWindowBitsMax);
+	return decompressZlib(packedStream, unpackedSize, -Common::kWindowBitsMax);
 }
 
-Common::SeekableReadStream *ERFFile::decompressZlib(const byte *compressedData, uint32 packedSize,
+Common::SeekableReadStream *ERFFile::decompressZlib(Common::SeekableReadStream *packedStream,
                                                     uint32 unpackedSize, int windowBits) const {
 
-	// Decompress. Negative window size to signal not to look for a gzip header.
-	const byte *data = Common::decompressDeflate(compressedData, packedSize, unpackedSize, -windowBits);
-
-	return new Common::MemoryReadStream(data, unpackedSize, true);
+	/* Decompress on demand, while the resource is being read. Negative window
+	 * size to signal not to look for a gzip header. */
+	return new Common::DeflateReadStream(packedStream, true, unpackedSize, -windowBits);
 }
 
 Common::HashAlgo ERFFile::getNameHashAlgo() const {
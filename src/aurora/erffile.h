@@ -38,6 +38,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 }
 
 namespace Aurora {
@@ -118,6 +119,13 @@ public:
 	 *  to calculate the key to decrypt the .hak file.
 	 */
 	ERFFile(Common::SeekableReadStream *erf, const std::vector<byte> &password = std::vector<byte>());
+
+	/** Take over this stream of an ERF file, but restore the parsed ERF out
+	 *  of an index written by writeIndex() instead of reading the ERF's
+	 *  resource tables.
+	 */
+	ERFFile(Common::SeekableReadStream *erf, Common::SeekableReadStream &index);
+
 	~ERFFile();
 
 	/** Return the list of resources. */
@@ -140,6 +148,14 @@ public:
 	/** Return with which algorithm the name is hashed. */
 	Common::HashAlgo getNameHashAlgo() const;
 
+	/** Write the parsed ERF into an index, see IndexCache.
+	 *
+	 *  Encrypted ERFs can't be restored from an index, so nothing is written for them.
+	 *
+	 *  @return true if the index was written.
+	 */
+	bool writeIndex(Common::WriteStream &index) const;
+
 	static LocString getDescription(Common::SeekableReadStream &erf);
 	static LocString getDescription(const Common::UString &fileName);
 
@@ -223,6 +239,7 @@ private:
 	std::vector<byte> _password;
 
 	void load();
+	void loadIndex(Common::SeekableReadStream &index);
 
 	// .--- Header
 	static void verifyVersion(uint32 id, uint32 version, bool utf16le);
@@ -290,17 +307,17 @@ private:
 	// '---
 
 	// .--- Compression
-	Common::SeekableReadStream *decompress(Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompress(Common::SeekableReadStream *packedStream,
 	                                       uint32 unpackedSize) const;
 
-	Common::SeekableReadStream *decompressBiowareZlib   (Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompressBiowareZlib   (Common::SeekableReadStream *packedStream,
 	                                                     uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressHeaderlessZlib(Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompressHeaderlessZlib(Common::SeekableReadStream *packedStream,
 	                                                     uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressStandardZlib  (Common::MemoryReadStream *packedStream,
+	Common::SeekableReadStream *decompressStandardZlib  (Common::SeekableReadStream *packedStream,
 	                                                     uint32 unpackedSize) const;
 
-	Common::SeekableReadStream *decompressZlib(const byte *compressedData, uint32 packedSize,
+	Common::SeekableReadStream *decompressZlib(Common::SeekableReadStream *packedStream,
 	                                           uint32 unpackedSize, int windowBits) const;
 	// '---
 
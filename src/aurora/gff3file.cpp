@@ -28,6 +28,8 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
@@ -41,6 +43,13 @@
 static const uint32 kVersion32 = MKTAG('V', '3', '.', '2');
 static const uint32 kVersion33 = MKTAG('V', '3', '.', '3'); // Found in The Witcher, different language table
 
+static const uint32 kListNone  = 0xFFFFFFFF;
+
+static const uint32 kStructSize = 12;
+
+/** Structs with up to this many fields find their fields by a linear search. */
+static const size_t kMaxLinearFieldSearch = 16;
+
 namespace Aurora {
 
 GFF3File::Header::Header() {
@@ -62,8 +71,11 @@ void GFF3File::Header::read(Common::SeekableReadStream &gff3) {
 }
 
 
-GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPremium) :
-	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+const uint32 GFF3File::kLabelNone;
+
+GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPremium, bool lazy) :
+	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0), _lazy(lazy),
+	_allLabelsLoaded(false) {
 
 	assert(_stream);
 
@@ -87,6 +99,7 @@ void GFF3File::load(uint32 id) {
 	try {
 
 		loadHeader(id);
+		loadLabels();
 		loadStructs();
 		loadLists();
 
@@ -169,8 +182,48 @@ void GFF3File::loadHeader(uint32 id) {
 		throw Common::Exception("GFF3 header broken: section offset points outside stream");
 }
 
+void GFF3File::loadLabels() {
+	/* Read all the labels in the label table at once, so that the fields
+	 * only need to store a label ID. Labels that appear several times get
+	 * folded into one ID, so that comparing IDs equals comparing labels. */
+
+	if (_lazy) {
+		// Only read the labels once they're needed, in getLabelID()
+		_labelIndexToID.resize(_header.labelCount, kLabelNone);
+		return;
+	}
+
+	_labelIndexToID.reserve(_header.labelCount);
+	for (uint32 i = 0; i < _header.labelCount; i++) {
+		_labelIndexToID.push_back(kLabelNone);
+		loadLabel(i);
+	}
+}
+
+uint32 GFF3File::loadLabel(uint32 index) const {
+	static const uint32 kLabelSize = 16;
+
+	const Common::UString label =
+		Common::readStringFixed(getStream(_header.labelOffset + index * kLabelSize), Common::kEncodingASCII, kLabelSize);
+
+	std::pair<LabelMap::iterator, bool> id =
+		_labelIDs.insert(std::make_pair(label, static_cast<uint32>(_labels.size())));
+
+	if (id.second)
+		_labels.push_back(label);
+
+	return _labelIndexToID[index] = id.first->second;
+}
+
 void GFF3File::loadStructs() {
-	static const uint32 kStructSize = 12;
+	if (((_stream->size() - _header.structOffset) / kStructSize) < _header.structCount)
+		throw Common::Exception("GFF3: Struct section points outside stream");
+
+	if (_lazy) {
+		// Only create the structs once they're needed, in getStruct()
+		_structs.resize(_header.structCount);
+		return;
+	}
 
 	_structs.reserve(_header.structCount);
 	for (uint32 i = 0; i < _header.structCount; i++)
@@ -193,6 +246,12 @@ void GFF3File::loadLists() {
 	 * list of lists into a list index.
 	 */
 
+	if (_lazy) {
+		// Only read the lists once they're needed, in getList()
+		_listOffsetToIndex.resize(_header.listIndicesCount / 4, kListNone);
+		return;
+	}
+
 	_stream->seek(_header.listIndicesOffset);
 
 	// Read list array
@@ -214,7 +273,7 @@ void GFF3File::loadLists() {
 	}
 
 	_lists.resize(listCount);
-	_listOffsetToIndex.resize(rawLists.size(), 0xFFFFFFFF);
+	_listOffsetToIndex.resize(rawLists.size(), kListNone);
 
 	// Converting the raw list array into real, usable lists
 	uint32 listIndex = 0;
@@ -237,12 +296,42 @@ void GFF3File::loadLists() {
 	}
 }
 
+void GFF3File::loadList(uint32 offset) const {
+	assert(_lazy);
+
+	Common::SeekableReadStream &data = getStream(_header.listIndicesOffset + offset * 4);
+
+	const uint32 n = data.readUint32LE();
+	if (n >= (_listOffsetToIndex.size() - offset))
+		throw Common::Exception("GFF3: List indices broken at %u", offset);
+
+	std::vector<uint32> structIndices(n);
+	for (std::vector<uint32>::iterator it = structIndices.begin(); it != structIndices.end(); ++it)
+		*it = data.readUint32LE();
+
+	// Create the structs in the list, if they haven't been yet
+	GFF3List list(n);
+	for (uint32 i = 0; i < n; i++)
+		list[i] = &getStruct(structIndices[i]);
+
+	_lists.push_back(GFF3List());
+	_lists.back().swap(list);
+
+	_listOffsetToIndex[offset] = _lists.size() - 1;
+}
+
 // --- Helpers for GFF3Struct ---
 
 const GFF3Struct &GFF3File::getStruct(uint32 i) const {
 	if (i >= _structs.size())
 		throw Common::Exception("GFF3: Struct index out of range (%u >= %u)", i, (uint) _structs.size());
 
+	if (!_structs[i]) {
+		assert(_lazy);
+
+		_structs[i] = new GFF3Struct(*this, _header.structOffset + i * kStructSize);
+	}
+
 	return *_structs[i];
 }
 
@@ -251,9 +340,12 @@ const GFF3List &GFF3File::getList(uint32 i) const {
 		throw Common::Exception("GFF3: List offset index out of range (%u >= %u)",
 		                        i, (uint) _listOffsetToIndex.size());
 
+	if (_lazy && (_listOffsetToIndex[i] == kListNone))
+		loadList(i);
+
 	const uint32 listIndex = _listOffsetToIndex[i];
 
-	if (listIndex == 0xFFFFFFFF)
+	if (listIndex == kListNone)
 		throw Common::Exception("GFF3: Empty list index at %u", i);
 
 	assert(listIndex < _lists.size());
@@ -261,6 +353,48 @@ const GFF3List &GFF3File::getList(uint32 i) const {
 	return _lists[listIndex];
 }
 
+uint32 GFF3File::getLabelID(uint32 index) const {
+	if (index >= _labelIndexToID.size())
+		throw Common::Exception("GFF3: Label index out of range (%u >= %u)",
+		                        index, (uint) _labelIndexToID.size());
+
+	if (_labelIndexToID[index] == kLabelNone)
+		return loadLabel(index);
+
+	return _labelIndexToID[index];
+}
+
+void GFF3File::loadAllLabels() const {
+	for (uint32 i = 0; i < _labelIndexToID.size(); i++)
+		if (_labelIndexToID[i] == kLabelNone)
+			loadLabel(i);
+
+	_allLabelsLoaded = true;
+}
+
+uint32 GFF3File::findLabelID(const Common::UString &label) const {
+	LabelMap::const_iterator id = _labelIDs.find(label);
+	if (id != _labelIDs.end())
+		return id->second;
+
+	// When loading lazily, the label might just not have been read yet
+	if (_lazy && !_allLabelsLoaded) {
+		loadAllLabels();
+
+		id = _labelIDs.find(label);
+		if (id != _labelIDs.end())
+			return id->second;
+	}
+
+	return kLabelNone;
+}
+
+const Common::UString &GFF3File::getLabel(uint32 id) const {
+	assert(id < _labels.size());
+
+	return _labels[id];
+}
+
 Common::SeekableReadStream &GFF3File::getStream(uint32 offset) const {
 	_stream->seek(offset);
 
@@ -272,10 +406,10 @@ Common::SeekableReadStream &GFF3File::getFieldData() const {
 }
 
 
-GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFF3Struct::Field::Field() : type(kFieldTypeNone), label(GFF3File::kLabelNone), data(0), extended(false) {
 }
 
-GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
+GFF3Struct::Field::Field(FieldType t, uint32 l, uint32 d) : type(t), label(l), data(d) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -331,13 +465,8 @@ void GFF3Struct::readField(Common::SeekableReadStream &data, uint32 index) {
 	const uint32 fieldLabel = data.readUint32LE();
 	const uint32 fieldData  = data.readUint32LE();
 
-	// Read the name
-	Common::UString fieldName = readLabel(data, fieldLabel);
-
-	// And add the field to the map and name list
-	_fields[fieldName] = Field((FieldType) fieldType, fieldData);
-
-	_fieldNames.push_back(fieldName);
+	// And add the field, with the ID of its label
+	_fields.push_back(Field((FieldType) fieldType, _parent->getLabelID(fieldLabel), fieldData));
 }
 
 void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32 index, uint32 count) {
@@ -354,8 +483,11 @@ void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32 index, uint
 	readIndices(data, indices, count);
 
 	// Read the fields
+	_fields.reserve(count);
 	for (std::vector<uint32>::const_iterator i = indices.begin(); i != indices.end(); ++i)
 		readField(data, *i);
+
+	indexFields();
 }
 
 void GFF3Struct::readIndices(Common::SeekableReadStream &data,
@@ -365,10 +497,62 @@ void GFF3Struct::readIndices(Common::SeekableReadStream &data,
 		indices.push_back(data.readUint32LE());
 }
 
-Common::UString GFF3Struct::readLabel(Common::SeekableReadStream &data, uint32 index) const {
-	data.seek(_parent->_header.labelOffset + index * 16);
+void GFF3Struct::indexFields() {
+	/* A label should only appear once in each struct. If it does appear
+	 * several times, the last field with that label wins, but it keeps
+	 * the position of the first one. */
+
+	if (_fields.size() <= kMaxLinearFieldSearch) {
+		for (size_t i = 1; i < _fields.size(); i++) {
+			for (size_t j = 0; j < i; j++) {
+				if (_fields[j].label == _fields[i].label) {
+					_fields[j] = _fields[i];
+					_fields.erase(_fields.begin() + i--);
+					break;
+				}
+			}
+		}
+
+		return;
+	}
+
+	// Larger structs get an index of their fields, sorted by label ID
+
+	_fieldsByLabel.resize(_fields.size());
+	for (size_t i = 0; i < _fieldsByLabel.size(); i++)
+		_fieldsByLabel[i] = i;
 
-	return Common::readStringFixed(data, Common::kEncodingASCII, 16);
+	std::stable_sort(_fieldsByLabel.begin(), _fieldsByLabel.end(), [this](uint32 a, uint32 b) {
+		return _fields[a].label < _fields[b].label;
+	});
+
+	bool duplicates = false;
+	for (size_t i = 1; i < _fieldsByLabel.size(); i++) {
+		Field &first = _fields[_fieldsByLabel[i - 1]];
+		Field &field = _fields[_fieldsByLabel[i]];
+
+		if (field.label != first.label)
+			continue;
+
+		// Move the field to the position of the first field with that label
+		first = field;
+		field.label = GFF3File::kLabelNone;
+
+		_fieldsByLabel[i] = _fieldsByLabel[i - 1];
+		duplicates = true;
+	}
+
+	if (!duplicates)
+		return;
+
+	// Remove the fields we merged away, and rebuild the index
+	_fields.erase(std::remove_if(_fields.begin(), _fields.end(), [](const Field &field) {
+		return field.label == GFF3File::kLabelNone;
+	}), _fields.end());
+
+	_fieldsByLabel.clear();
+
+	indexFields();
 }
 
 Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
@@ -387,15 +571,31 @@ size_t GFF3Struct::getFieldCount() const {
 }
 
 bool GFF3Struct::hasField(const Common::UString &field) const {
-	return getField(field) != 0;
+	return hasField(_parent->findLabelID(field));
+}
+
+bool GFF3Struct::hasField(uint32 label) const {
+	return getField(label) != 0;
 }
 
 const std::vector<Common::UString> &GFF3Struct::getFieldNames() const {
+	if (_fieldNames.size() != _fields.size()) {
+		_fieldNames.clear();
+		_fieldNames.reserve(_fields.size());
+
+		for (FieldArray::const_iterator f = _fields.begin(); f != _fields.end(); ++f)
+			_fieldNames.push_back(_parent->getLabel(f->label));
+	}
+
 	return _fieldNames;
 }
 
 GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getFieldType(_parent->findLabelID(field));
+}
+
+GFF3Struct::FieldType GFF3Struct::getFieldType(uint32 label) const {
+	const Field *f = getField(label);
 	if (!f)
 		return kFieldTypeNone;
 
@@ -404,16 +604,32 @@ GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) con
 
 // --- Field value reader helpers ---
 
-const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
+const GFF3Struct::Field *GFF3Struct::getField(uint32 label) const {
+	if (_fieldsByLabel.empty()) {
+		for (FieldArray::const_iterator f = _fields.begin(); f != _fields.end(); ++f)
+			if (f->label == label)
+				return &*f;
+
+		return 0;
+	}
+
+	std::vector<uint32>::const_iterator f =
+		std::lower_bound(_fieldsByLabel.begin(), _fieldsByLabel.end(), label, [this](uint32 index, uint32 l) {
+			return _fields[index].label < l;
+		});
+
+	if ((f == _fieldsByLabel.end()) || (_fields[*f].label != label))
 		return 0;
 
-	return &field->second;
+	return &_fields[*f];
 }
 
 char GFF3Struct::getChar(const Common::UString &field, char def) const {
-	const Field *f = getField(field);
+	return getChar(_parent->findLabelID(field), def);
+}
+
+char GFF3Struct::getChar(uint32 label, char def) const {
+	const Field *f = getField(label);
 	if (!f)
 		return def;
 	if (f->type != kFieldTypeChar)
@@ -423,7 +639,11 @@ char GFF3Struct::getChar(const Common::UString &field, char def) const {
 }
 
 uint64 GFF3Struct::getUint(const Common::UString &field, uint64 def) const {
-	const Field *f = getField(field);
+	return getUint(_parent->findLabelID(field), def);
+}
+
+uint64 GFF3Struct::getUint(uint32 label, uint64 def) const {
+	const Field *f = getField(label);
 	if (!f)
 		return def;
 
@@ -460,7 +680,11 @@ uint64 GFF3Struct::getUint(const Common::UString &field, uint64 def) const {
 }
 
 int64 GFF3Struct::getSint(const Common::UString &field, int64 def) const {
-	const Field *f = getField(field);
+	return getSint(_parent->findLabelID(field), def);
+}
+
+int64 GFF3Struct::getSint(uint32 label, int64 def) const {
+	const Field *f = getField(label);
 	if (!f)
 		return def;
 
@@ -497,11 +721,19 @@ int64 GFF3Struct::getSint(const Common::UString &field, int64 def) const {
 }
 
 bool GFF3Struct::getBool(const Common::UString &field, bool def) const {
-	return getUint(field, def) != 0;
+	return getBool(_parent->findLabelID(field), def);
+}
+
+bool GFF3Struct::getBool(uint32 label, bool def) const {
+	return getUint(label, def) != 0;
 }
 
 double GFF3Struct::getDouble(const Common::UString &field, double def) const {
-	const Field *f = getField(field);
+	return getDouble(_parent->findLabelID(field), def);
+}
+
+double GFF3Struct::getDouble(uint32 label, double def) const {
+	const Field *f = getField(label);
 	if (!f)
 		return def;
 
@@ -516,7 +748,13 @@ double GFF3Struct::getDouble(const Common::UString &field, double def) const {
 Common::UString GFF3Struct::getString(const Common::UString &field,
                                       const Common::UString &def) const {
 
-	const Field *f = getField(field);
+	return getString(_parent->findLabelID(field), def);
+}
+
+Common::UString GFF3Struct::getString(uint32 label,
+                                      const Common::UString &def) const {
+
+	const Field *f = getField(label);
 	if (!f)
 		return def;
 
@@ -545,7 +783,7 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	// LocString, a localized string
 	if (f->type == kFieldTypeLocString) {
 		LocString locString;
-		getLocString(field, locString);
+		getLocString(label, locString);
 
 		return locString.getString();
 	}
@@ -557,7 +795,7 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	    (f->type == kFieldTypeUint64) ||
 	    (f->type == kFieldTypeStrRef)) {
 
-		return Common::composeString(getUint(field));
+		return Common::composeString(getUint(label));
 	}
 
 	// Signed integer type, compose a string representation
@@ -566,21 +804,21 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	    (f->type == kFieldTypeSint32) ||
 	    (f->type == kFieldTypeSint64)) {
 
-		return Common::composeString(getSint(field));
+		return Common::composeString(getSint(label));
 	}
 
 	// Floating point type, compose a string representation
 	if ((f->type == kFieldTypeFloat) ||
 	    (f->type == kFieldTypeDouble)) {
 
-		return Common::composeString(getDouble(field));
+		return Common::composeString(getDouble(label));
 	}
 
 	// Vector, consisting of 3 floats
 	if (f->type == kFieldTypeVector) {
 		float x = 0.0, y = 0.0, z = 0.0;
 
-		getVector(field, x, y, z);
+		getVector(label, x, y, z);
 		return Common::composeString(x) + "/" +
 		       Common::composeString(y) + "/" +
 		       Common::composeString(z);
@@ -590,7 +828,7 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 	if (f->type == kFieldTypeOrientation) {
 		float a = 0.0, b = 0.0, c = 0.0, d = 0.0;
 
-		getOrientation(field, a, b, c, d);
+		getOrientation(label, a, b, c, d);
 		return Common::composeString(a) + "/" +
 		       Common::composeString(b) + "/" +
 		       Common::composeString(c) + "/" +
@@ -601,7 +839,11 @@ Common::UString GFF3Struct::getString(const Common::UString &field,
 }
 
 bool GFF3Struct::getLocString(const Common::UString &field, LocString &str) const {
-	const Field *f = getField(field);
+	return getLocString(_parent->findLabelID(field), str);
+}
+
+bool GFF3Struct::getLocString(uint32 label, LocString &str) const {
+	const Field *f = getField(label);
 	if (!f || (f->type != kFieldTypeLocString))
 		return false;
 
@@ -625,7 +867,11 @@ bool GFF3Struct::getLocString(const Common::UString &field, LocString &str) cons
 }
 
 Common::SeekableReadStream *GFF3Struct::getData(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getData(_parent->findLabelID(field));
+}
+
+Common::SeekableReadStream *GFF3Struct::getData(uint32 label) const {
+	const Field *f = getField(label);
 	if (!f)
 		return 0;
 	if ((f->type != kFieldTypeVoid) &&
@@ -649,7 +895,13 @@ Common::SeekableReadStream *GFF3Struct::getData(const Common::UString &field) co
 void GFF3Struct::getVector(const Common::UString &field,
                            float &x, float &y, float &z) const {
 
-	const Field *f = getField(field);
+	getVector(_parent->findLabelID(field), x, y, z);
+}
+
+void GFF3Struct::getVector(uint32 label,
+                           float &x, float &y, float &z) const {
+
+	const Field *f = getField(label);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeVector)
@@ -665,7 +917,13 @@ void GFF3Struct::getVector(const Common::UString &field,
 void GFF3Struct::getOrientation(const Common::UString &field,
                                 float &a, float &b, float &c, float &d) const {
 
-	const Field *f = getField(field);
+	getOrientation(_parent->findLabelID(field), a, b, c, d);
+}
+
+void GFF3Struct::getOrientation(uint32 label,
+                                float &a, float &b, float &c, float &d) const {
+
+	const Field *f = getField(label);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeOrientation)
@@ -682,7 +940,13 @@ void GFF3Struct::getOrientation(const Common::UString &field,
 void GFF3Struct::getVector(const Common::UString &field,
                            double &x, double &y, double &z) const {
 
-	const Field *f = getField(field);
+	getVector(_parent->findLabelID(field), x, y, z);
+}
+
+void GFF3Struct::getVector(uint32 label,
+                           double &x, double &y, double &z) const {
+
+	const Field *f = getField(label);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeVector)
@@ -698,7 +962,13 @@ void GFF3Struct::getVector(const Common::UString &field,
 void GFF3Struct::getOrientation(const Common::UString &field,
                                 double &a, double &b, double &c, double &d) const {
 
-	const Field *f = getField(field);
+	getOrientation(_parent->findLabelID(field), a, b, c, d);
+}
+
+void GFF3Struct::getOrientation(uint32 label,
+                                double &a, double &b, double &c, double &d) const {
+
+	const Field *f = getField(label);
 	if (!f)
 		return;
 	if (f->type != kFieldTypeOrientation)
@@ -715,7 +985,11 @@ void GFF3Struct::getOrientation(const Common::UString &field,
 // --- Struct reader ---
 
 const GFF3Struct &GFF3Struct::getStruct(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getStruct(_parent->findLabelID(field));
+}
+
+const GFF3Struct &GFF3Struct::getStruct(uint32 label) const {
+	const Field *f = getField(label);
 	if (!f)
 		throw Common::Exception("GFF3: No such field");
 	if (f->type != kFieldTypeStruct)
@@ -728,7 +1002,11 @@ const GFF3Struct &GFF3Struct::getStruct(const Common::UString &field) const {
 // --- Struct list reader ---
 
 const GFF3List &GFF3Struct::getList(const Common::UString &field) const {
-	const Field *f = getField(field);
+	return getList(_parent->findLabelID(field));
+}
+
+const GFF3List &GFF3Struct::getList(uint32 label) const {
+	const Field *f = getField(label);
 	if (!f)
 		throw Common::Exception("GFF3: No such field");
 	if (f->type != kFieldTypeList)
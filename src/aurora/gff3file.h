@@ -26,9 +26,10 @@
 #define AURORA_GFF3FILE_H
 
 #include <vector>
-#include <map>
+#include <deque>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
@@ -73,6 +74,13 @@ class GFF3Struct;
  *  parameter is set to false, no detection will take place, and these
  *  broken files will lead the loader to throw an exception.
  *
+ *  When the constructor parameter lazy is set to true, structs and lists
+ *  are only read once they are first accessed, through getTopLevel(),
+ *  getStruct() and getList(). Only querying a few values, like reading
+ *  the module name out of a module.ifo, then only touches a tiny fraction
+ *  of the GFF3. However, errors in the GFF3 data are then only detected,
+ *  and thrown as exceptions, when the broken parts are accessed.
+ *
  *  There is no functional difference between GFF V3.2 and V3.3 files. GFF
  *  V3.3 files exclusively appear in The Witcher (and every GFF file there
  *  is of version V3.3), simply to denote that the language table used for
@@ -85,7 +93,8 @@ class GFF3Struct;
 class GFF3File : boost::noncopyable, public AuroraFile {
 public:
 	/** Take over this stream and read a GFF3 file out of it. */
-	GFF3File(Common::SeekableReadStream *gff3, uint32 id = 0xFFFFFFFF, bool repairNWNPremium = false);
+	GFF3File(Common::SeekableReadStream *gff3, uint32 id = 0xFFFFFFFF, bool repairNWNPremium = false,
+	         bool lazy = false);
 	virtual ~GFF3File();
 
 	/** Return the GFF3's specific type. */
@@ -94,6 +103,17 @@ public:
 	/** Returns the top-level struct. */
 	const GFF3Struct &getTopLevel() const;
 
+	/** The label ID returned for labels no field in the GFF3 has. */
+	static const uint32 kLabelNone = 0xFFFFFFFF;
+
+	/** Return the ID of this field label, or kLabelNone if no field has such a label.
+	 *
+	 *  A label ID stays valid for the lifetime of the GFF3File and can be
+	 *  used with all its structs. Resolving a label once and then reading
+	 *  fields by label ID saves looking up the label on every access.
+	 */
+	uint32 findLabelID(const Common::UString &label) const;
+
 
 private:
 	/** A GFF3 header. */
@@ -117,7 +137,9 @@ private:
 	};
 
 	typedef Common::PtrVector<GFF3Struct> StructArray;
-	typedef std::vector<GFF3List> ListArray;
+	typedef std::deque<GFF3List> ListArray;
+
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> LabelMap;
 
 
 	Common::ScopedPtr<Common::SeekableReadStream> _stream;
@@ -129,18 +151,45 @@ private:
 	/** The correctional value for offsets to repair Neverwinter Nights premium modules. */
 	uint32 _offsetCorrection;
 
-	StructArray _structs; ///< Our structs.
-	ListArray   _lists;   ///< Our lists.
+	/** Only read structs and lists when they are first accessed? */
+	bool _lazy;
+
+	/** Our structs. When loading lazily, structs not yet read are 0. */
+	mutable StructArray _structs;
+	/** Our lists. When loading lazily, lists are added as they are read. */
+	mutable ListArray   _lists;
 
 	/** To convert list offsets found in GFF3 to real indices. */
-	std::vector<uint32> _listOffsetToIndex;
+	mutable std::vector<uint32> _listOffsetToIndex;
+
+	/** All different field labels, indexed by label ID. */
+	mutable std::vector<Common::UString> _labels;
+	/** The IDs of all field labels, indexed by label. */
+	mutable LabelMap _labelIDs;
+	/** To convert label indices found in the GFF3 into label IDs.
+	 *
+	 *  Labels that appear several times in the GFF3's label table all
+	 *  share the same label ID. When loading lazily, labels are only read
+	 *  when a struct using them is read.
+	 */
+	mutable std::vector<uint32> _labelIndexToID;
+	/** Have all labels been read, even when loading lazily? */
+	mutable bool _allLabelsLoaded;
 
 
 	// .--- Loading helpers
 	void load(uint32 id);
 	void loadHeader(uint32 id);
+	void loadLabels();
 	void loadStructs();
 	void loadLists();
+
+	/** Read the label at this label index, and return its ID. */
+	uint32 loadLabel(uint32 index) const;
+	/** Read all labels not yet read, when loading lazily. */
+	void loadAllLabels() const;
+	/** Read the list at this list offset, when loading lazily. */
+	void loadList(uint32 offset) const;
 	// '---
 
 	// .--- Helper methods called by GFF3Struct
@@ -153,6 +202,11 @@ private:
 	const GFF3Struct &getStruct(uint32 i) const;
 	/** Return a list within the GFF3. */
 	const GFF3List   &getList  (uint32 i) const;
+
+	/** Return the ID of the label at this index in the GFF3's label table. */
+	uint32 getLabelID(uint32 index) const;
+	/** Return the label with this ID. */
+	const Common::UString &getLabel(uint32 id) const;
 	// '---
 
 	friend class GFF3Struct;
@@ -200,12 +254,16 @@ public:
 	size_t getFieldCount() const;
 	/** Does this specific field exist? */
 	bool hasField(const Common::UString &field) const;
+	/** Does a field with this label ID exist? */
+	bool hasField(uint32 label) const;
 
 	/** Return a list of all field names in this struct. */
 	const std::vector<Common::UString> &getFieldNames() const;
 
 	/** Return the type of this field, or kFieldTypeNone if such a field doesn't exist. */
 	FieldType getFieldType(const Common::UString &field) const;
+	/** Return the type of the field with this label ID, or kFieldTypeNone if it doesn't exist. */
+	FieldType getFieldType(uint32 label) const;
 
 
 	// .--- Read field values
@@ -239,18 +297,43 @@ public:
 	const GFF3List   &getList  (const Common::UString &field) const;
 	// '---
 
+	// .--- Read field values by label ID, see GFF3File::findLabelID()
+	char   getChar(uint32 label, char   def = '\0' ) const;
+	uint64 getUint(uint32 label, uint64 def = 0    ) const;
+	 int64 getSint(uint32 label,  int64 def = 0    ) const;
+	bool   getBool(uint32 label, bool   def = false) const;
+
+	double getDouble(uint32 label, double def = 0.0) const;
+
+	Common::UString getString(uint32 label, const Common::UString &def = "") const;
+
+	bool getLocString(uint32 label, LocString &str) const;
+
+	void getVector     (uint32 label, float &x, float &y, float &z          ) const;
+	void getOrientation(uint32 label, float &a, float &b, float &c, float &d) const;
+
+	void getVector     (uint32 label, double &x, double &y, double &z           ) const;
+	void getOrientation(uint32 label, double &a, double &b, double &c, double &d) const;
+
+	Common::SeekableReadStream *getData(uint32 label) const;
+
+	const GFF3Struct &getStruct(uint32 label) const;
+	const GFF3List   &getList  (uint32 label) const;
+	// '---
+
 private:
 	/** A field in the GFF3 struct. */
 	struct Field {
 		FieldType type;     ///< Type of the field.
+		uint32    label;    ///< ID of the field's label.
 		uint32    data;     ///< Data of the field.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32 d);
+		Field(FieldType t, uint32 l, uint32 d);
 	};
 
-	typedef std::map<Common::UString, Field> FieldMap;
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF3File *_parent; ///< The parent GFF3.
@@ -259,10 +342,14 @@ private:
 	uint32 _fieldIndex; ///< Field / Field indices index.
 	uint32 _fieldCount; ///< Field count.
 
-	FieldMap _fields; ///< The fields, indexed by their label.
+	/** The fields, in the order they appear in the GFF3. */
+	FieldArray _fields;
+
+	/** Indices into _fields, sorted by label ID. Only used in larger structs. */
+	std::vector<uint32> _fieldsByLabel;
 
-	/** The names of all fields in this struct. */
-	std::vector<Common::UString> _fieldNames;
+	/** The names of all fields in this struct, created on demand. */
+	mutable std::vector<Common::UString> _fieldNames;
 
 
 	// .--- Loader
@@ -276,12 +363,13 @@ private:
 	void readIndices(Common::SeekableReadStream &data,
 	                 std::vector<uint32> &indices, uint32 count) const;
 
-	Common::UString readLabel(Common::SeekableReadStream &data, uint32 index) const;
+	/** Merge fields with the same label and create the label lookup index. */
+	void indexFields();
 	// '---
 
 	// .--- Field and field data accessors
-	/** Returns the field with this tag. */
-	const Field *getField(const Common::UString &name) const;
+	/** Returns the field with this label ID. */
+	const Field *getField(uint32 label) const;
 	/** Returns the extended field data for this field. */
 	Common::SeekableReadStream &getData(const Field &field) const;
 	// '---
@@ -24,10 +24,11 @@
 
 #include <cstring>
 
-#include <algorithm>
-
 #include <boost/make_shared.hpp>
+#include <boost/functional/hash.hpp>
 
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
 #include "src/common/writestream.h"
 #include "src/common/memreadstream.h"
 
@@ -52,6 +53,101 @@ GFF3Writer::VoidData &GFF3Writer::VoidData::operator=(const VoidData &rhs) {
 	return *this;
 }
 
+/** Return the complete contents of a void data stream.
+ *
+ *  If the data is not directly available in memory, it is read into buffer.
+ */
+static const byte *getVoidContents(Common::SeekableReadStream &stream, Common::ScopedArray<byte> &buffer) {
+	const byte *data = stream.getData();
+	if (data)
+		return data;
+
+	const size_t size = stream.size();
+
+	buffer.reset(new byte[size]);
+
+	stream.seek(0);
+	const size_t bytesRead = stream.read(buffer.get(), size);
+	stream.seek(0);
+
+	if (bytesRead != size)
+		throw Common::Exception(Common::kReadError);
+
+	return buffer.get();
+}
+
+bool GFF3Writer::VoidData::operator==(const VoidData &rhs) const {
+	if (!data || !rhs.data)
+		return data.get() == rhs.data.get();
+
+	if (data.get() == rhs.data.get())
+		return true;
+
+	if (data->size() != rhs.data->size())
+		return false;
+
+	Common::ScopedArray<byte> buffer1, buffer2;
+	const byte *contents1 = getVoidContents(*data, buffer1);
+	const byte *contents2 = getVoidContents(*rhs.data, buffer2);
+
+	return std::memcmp(contents1, contents2, data->size()) == 0;
+}
+
+
+/** Hash the contents of the data of a value. */
+class GFF3Writer::ValueDataHash : public boost::static_visitor<size_t> {
+public:
+	template<typename T> size_t operator()(const T &v) const {
+		return boost::hash<T>()(v);
+	}
+
+	size_t operator()(const Vector4 &v) const {
+		size_t seed = 0;
+
+		boost::hash_combine(seed, v.x);
+		boost::hash_combine(seed, v.y);
+		boost::hash_combine(seed, v.z);
+		boost::hash_combine(seed, v.w);
+
+		return seed;
+	}
+
+	size_t operator()(const Common::UString &v) const {
+		return Common::hashUStringCaseSensitive()(v);
+	}
+
+	size_t operator()(const LocString &v) const {
+		std::vector<LocString::SubLocString> strings;
+		v.getStrings(strings);
+
+		size_t seed = v.getID();
+		for (const auto &string : strings) {
+			boost::hash_combine(seed, string.language);
+			boost::hash_combine(seed, Common::hashUStringCaseSensitive()(string.str));
+		}
+
+		return seed;
+	}
+
+	size_t operator()(const VoidData &v) const {
+		if (!v.data)
+			return 0;
+
+		Common::ScopedArray<byte> buffer;
+		const byte *contents = getVoidContents(*v.data, buffer);
+
+		return boost::hash_range(contents, contents + v.data->size());
+	}
+};
+
+size_t GFF3Writer::hashValue::operator()(const Value *value) const {
+	size_t seed = boost::apply_visitor(ValueDataHash(), value->data);
+
+	boost::hash_combine(seed, static_cast<int>(value->type));
+
+	return seed;
+}
+
 
 GFF3Writer::GFF3Writer(uint32 id, uint32 version) : _id(id), _version(version) {
 	_structs.push_back(boost::make_shared<GFF3WriterStruct>(this));
@@ -62,11 +158,27 @@ GFF3WriterStructPtr GFF3Writer::getTopLevel() {
 }
 
 void GFF3Writer::write(Common::WriteStream &stream) {
-	// Extract all individual values of the fields.
-	std::list<Value> individualValues;
-	for (const auto &field : _fields) {
-		if (std::find(individualValues.begin(), individualValues.end(), field->value) == individualValues.end())
-			individualValues.push_back(field->value);
+	/* Extract all individual values of the complex fields, and assign each
+	 * an offset into the field data. Equivalent values share their data. */
+	std::vector<const Value *> individualValues;
+	std::vector<uint32> fieldDataOffsets(_fields.size(), 0);
+
+	ValueOffsets valueOffsets;
+	valueOffsets.reserve(_fields.size());
+
+	uint32 fieldDataCount = 0;
+	for (size_t i = 0; i < _fields.size(); ++i) {
+		const Value &value = _fields[i]->value;
+		if (isSimpleField(value.type))
+			continue;
+
+		std::pair<ValueOffsets::iterator, bool> offset = valueOffsets.insert(std::make_pair(&value, fieldDataCount));
+		if (offset.second) {
+			individualValues.push_back(&value);
+			fieldDataCount += getFieldDataSize(value);
+		}
+
+		fieldDataOffsets[i] = offset.first->second;
 	}
 
 	stream.writeUint32BE(_id);
@@ -82,12 +194,6 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 	uint32 labelCount = static_cast<uint32>(_labels.size());
 
 	uint32 fieldDataOffset = labelOffset + labelCount * 16;
-	uint32 fieldDataCount = 0;
-
-	// Count the total size of field data
-	for (const auto &value : individualValues) {
-		fieldDataCount += getFieldDataSize(value);
-	}
 
 	uint32 fieldIndicesOffset = fieldDataOffset + fieldDataCount;
 	uint32 fieldIndicesCount = 0;
@@ -147,31 +253,14 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 	}
 
 	// Write fields
-	size_t fieldDataIndex = 0;
 	size_t listDataIndex = 0;
 
-	// Maps for checking for already existing values
-	std::map<Value, size_t> valueIndices;
-
 	for (size_t i = 0; i < _fields.size(); ++i) {
 		FieldPtr field = _fields[i];
 		stream.writeUint32LE(field->value.type);
 		stream.writeUint32LE(field->labelIndex);
 
-		/* Determine if this field has simple values (less equal 32 bit) which are written in the field
-		 * or complex values, bigger than 32bit like strings written in the field data section. */
-		const bool simple =
-			field->value.type == GFF3Struct::kFieldTypeByte ||
-			field->value.type == GFF3Struct::kFieldTypeChar ||
-			field->value.type == GFF3Struct::kFieldTypeUint16 ||
-			field->value.type == GFF3Struct::kFieldTypeUint32 ||
-			field->value.type == GFF3Struct::kFieldTypeStruct ||
-			field->value.type == GFF3Struct::kFieldTypeSint16 ||
-			field->value.type == GFF3Struct::kFieldTypeSint32 ||
-			field->value.type == GFF3Struct::kFieldTypeFloat ||
-			field->value.type == GFF3Struct::kFieldTypeList;
-
-		if (simple) {
+		if (isSimpleField(field->value.type)) {
 			// If the values are simple (less equal 4 bytes) write them to the field
 			switch (field->value.type) {
 				case GFF3Struct::kFieldTypeByte:
@@ -197,17 +286,7 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 			}
 		} else {
 			// If the values are complex (greater then 4 bytes) write the index to the field data
-
-			size_t index = 0;
-			if (valueIndices.find(field->value) == valueIndices.end()) {
-				index = fieldDataIndex;
-				fieldDataIndex += getFieldDataSize(field->value);
-				valueIndices[field->value] = index;
-			} else {
-				index = valueIndices[field->value];
-			}
-
-			stream.writeUint32LE(index);
+			stream.writeUint32LE(fieldDataOffsets[i]);
 		}
 	}
 
@@ -219,7 +298,9 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 	}
 
 	// Write field data
-	for (const auto &value : individualValues) {
+	for (const auto *individualValue : individualValues) {
+		const Value &value = *individualValue;
+
 		switch (value.type) {
 			case GFF3Struct::kFieldTypeUint64:
 				stream.writeUint64LE(boost::get<uint64>(value.data));
@@ -314,16 +395,30 @@ void GFF3Writer::write(Common::WriteStream &stream) {
 }
 
 uint32 GFF3Writer::addLabel(const Common::UString &label) {
-	std::vector<Common::UString>::iterator iter = std::find(_labels.begin(), _labels.end(), label);
-	if (iter != _labels.end()) {
-		return static_cast<uint32>(std::distance(_labels.begin(), iter));
-	} else {
+	std::pair<LabelIndices::iterator, bool> index =
+		_labelIndices.insert(std::make_pair(label, static_cast<uint32>(_labels.size())));
+
+	if (index.second)
 		_labels.push_back(label);
-		return static_cast<uint32>(_labels.size() - 1);
-	}
+
+	return index.first->second;
+}
+
+bool GFF3Writer::isSimpleField(GFF3Struct::FieldType type) {
+	/* Simple values (less equal 32 bit) are written in the field, complex
+	 * values bigger than 32bit, like strings, are written in the field data section. */
+	return type == GFF3Struct::kFieldTypeByte   ||
+	       type == GFF3Struct::kFieldTypeChar   ||
+	       type == GFF3Struct::kFieldTypeUint16 ||
+	       type == GFF3Struct::kFieldTypeUint32 ||
+	       type == GFF3Struct::kFieldTypeStruct ||
+	       type == GFF3Struct::kFieldTypeSint16 ||
+	       type == GFF3Struct::kFieldTypeSint32 ||
+	       type == GFF3Struct::kFieldTypeFloat  ||
+	       type == GFF3Struct::kFieldTypeList;
 }
 
-uint32 GFF3Writer::getFieldDataSize(Value value) {
+uint32 GFF3Writer::getFieldDataSize(const Value &value) {
 	switch (value.type) {
 		case GFF3Struct::kFieldTypeUint64:
 		case GFF3Struct::kFieldTypeSint64:
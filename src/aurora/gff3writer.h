@@ -25,13 +25,14 @@
 #ifndef AURORA_GFF3WRITER_H
 #define AURORA_GFF3WRITER_H
 
-#include <list>
-#include <functional>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/variant.hpp>
+#include <boost/unordered/unordered_map.hpp>
 
+#include "src/common/ustring.h"
 #include "src/common/readstream.h"
 #include "src/common/memwritestream.h"
 
@@ -67,30 +68,6 @@ private:
 		bool operator==(const Vector4 &v)  const {
 			return x == v.x && y == v.y && z == v.z && w == v.w;
 		}
-
-		bool operator<(const Vector4 &v) const {
-			if (x < v.x)
-				return true;
-			if (x > v.x)
-				return false;
-
-			if (y < v.y)
-				return true;
-			if (y > v.y)
-				return false;
-
-			if (z < v.z)
-				return true;
-			if (z > v.z)
-				return false;
-
-			if (w < v.w)
-				return true;
-			if (w > v.w)
-				return false;
-
-			return false;
-		}
 	};
 
 	/** A special struct type for representing void data. */
@@ -105,13 +82,8 @@ private:
 
 		VoidData &operator=(const VoidData &rhs);
 
-		bool operator==(const VoidData &rhs) const {
-			return data.get() == rhs.data.get();
-		}
-
-		bool operator<(const VoidData &rhs) const {
-			return std::less<Common::SeekableReadStream*>{}(data.get(), rhs.data.get());
-		}
+		/** Compare the contents of the void data. */
+		bool operator==(const VoidData &rhs) const;
 	};
 
 	/** A variant containing all possible types of GFF data. */
@@ -128,12 +100,7 @@ private:
 		VoidData
 	> ValueData;
 
-	class ValueDataLess : public boost::static_visitor<bool> {
-	public:
-		template<typename T, typename U> bool operator()(const T &UNUSED(v1), const U &UNUSED(v2)) const { return false; }
-
-		template<typename T> bool operator()(const T &v1, const T &v2) const { return v1 < v2; }
-	};
+	class ValueDataHash;
 
 	/** A value holds a type and data. */
 	struct Value {
@@ -141,24 +108,30 @@ private:
 		ValueData data;
 		bool isRaw { false };
 
-		/** Equality operator for std::find. */
+		/** Equality operator for finding equivalent values. */
 		bool operator==(const Value &rhs) const {
 			return type == rhs.type &&
 			       data == rhs.data;
 		}
+	};
 
-		/** Relational operator for map find. */
-		bool operator<(const Value &rhs) const {
-			if (type != rhs.type) {
-				return type < rhs.type;
-			} else if (data.which() != rhs.data.which()) {
-				return data.which() < rhs.data.which();
-			} else {
-				return boost::apply_visitor(ValueDataLess(), data, rhs.data);
-			}
+	/** Hash a value, by its type and the contents of its data. */
+	struct hashValue {
+		size_t operator()(const Value *value) const;
+	};
+
+	/** Compare two values by their type and the contents of their data. */
+	struct equalValue {
+		bool operator()(const Value *value1, const Value *value2) const {
+			return *value1 == *value2;
 		}
 	};
 
+	/** Offsets into the field data section, by value. */
+	typedef boost::unordered_map<const Value *, uint32, hashValue, equalValue> ValueOffsets;
+	/** Label indices, by label. */
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> LabelIndices;
+
 	/** An implementation for a field. */
 	struct Field : boost::noncopyable {
 		uint32 labelIndex;
@@ -174,6 +147,8 @@ private:
 	std::vector<GFF3WriterListPtr> _lists;
 
 	std::vector<Common::UString> _labels;
+	LabelIndices _labelIndices;
+
 	std::vector<FieldPtr> _fields;
 
 	friend class GFF3WriterList;
@@ -181,8 +156,10 @@ private:
 
 	/** Adds a label to the writer and returns the corresponding index. */
 	uint32 addLabel(const Common::UString &label);
+	/** Is this field type written directly into the field, instead of into the field data? */
+	static bool isSimpleField(GFF3Struct::FieldType type);
 	/** Get the actual size of the field. */
-	static uint32 getFieldDataSize(Value field);
+	static uint32 getFieldDataSize(const Value &field);
 
 	size_t createField(GFF3Struct::FieldType type, const Common::UString &label);
 };
@@ -28,6 +28,7 @@
 #include "src/common/error.h"
 #include "src/common/filepath.h"
 #include "src/common/memreadstream.h"
+#include "src/common/writestream.h"
 #include "src/common/encoding.h"
 #include "src/common/hash.h"
 
@@ -42,6 +43,14 @@ HERFFile::HERFFile(Common::SeekableReadStream *herf) : _herf(herf), _dictOffset(
 	load(*_herf);
 }
 
+HERFFile::HERFFile(Common::SeekableReadStream *herf, Common::SeekableReadStream &index) :
+	_herf(herf), _dictOffset(0xFFFFFFFF), _dictSize(0) {
+
+	assert(_herf);
+
+	loadIndex(index);
+}
+
 HERFFile::~HERFFile() {
 }
 
@@ -160,15 +169,52 @@ Common::SeekableReadStream *HERFFile::getResource(uint32 index, bool tryNoCopy)
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_herf.get(), res.offset, res.offset + res.size);
-
-	_herf->seek(res.offset);
+		return _herf->getPositionalSubStream(res.offset, res.offset + res.size);
 
-	return _herf->readStream(res.size);
+	return _herf->readStreamAt(res.offset, res.size);
 }
 
 Common::HashAlgo HERFFile::getNameHashAlgo() const {
 	return Common::kHashDJB2;
 }
 
+void HERFFile::writeIndex(Common::WriteStream &index) const {
+	index.writeUint32LE(_dictOffset);
+	index.writeUint32LE(_dictSize);
+
+	writeIndexResources(index, _resources);
+
+	index.writeUint32LE(_iResources.size());
+	for (IResourceList::const_iterator r = _iResources.begin(); r != _iResources.end(); ++r) {
+		index.writeUint32LE(r->offset);
+		index.writeUint32LE(r->size);
+	}
+}
+
+void HERFFile::loadIndex(Common::SeekableReadStream &index) {
+	try {
+
+		_dictOffset = index.readUint32LE();
+		_dictSize   = index.readUint32LE();
+
+		readIndexResources(index, _resources);
+
+		_iResources.resize(index.readUint32LE());
+		for (IResourceList::iterator r = _iResources.begin(); r != _iResources.end(); ++r) {
+			r->offset = index.readUint32LE();
+			r->size   = index.readUint32LE();
+
+			if (r->offset >= (uint32)_herf->size())
+				throw Common::Exception("Resource goes beyond end of file");
+		}
+
+		if (_resources.size() != _iResources.size())
+			throw Common::Exception("Resource count mismatch");
+
+	} catch (Common::Exception &e) {
+		e.add("Failed reading HERF index");
+		throw;
+	}
+}
+
 } // End of namespace Aurora
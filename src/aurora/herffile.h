@@ -37,6 +37,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 }
 
 namespace Aurora {
@@ -54,6 +55,13 @@ class HERFFile : public Archive {
 public:
 	/** Take over this stream and read an HERF file out of it. */
 	HERFFile(Common::SeekableReadStream *herf);
+
+	/** Take over this stream of an HERF file, but restore the parsed HERF out
+	 *  of an index written by writeIndex() instead of reading the HERF's
+	 *  resource list and dictionary.
+	 */
+	HERFFile(Common::SeekableReadStream *herf, Common::SeekableReadStream &index);
+
 	~HERFFile();
 
 	/** Return the list of resources. */
@@ -68,6 +76,9 @@ public:
 	/** Return with which algorithm the name is hashed. */
 	Common::HashAlgo getNameHashAlgo() const;
 
+	/** Write the parsed HERF into an index, see IndexCache. */
+	void writeIndex(Common::WriteStream &index) const;
+
 private:
 	/** Internal resource information. */
 	struct IResource {
@@ -89,6 +100,7 @@ private:
 	uint32 _dictSize;   ///< The size of the dict file (if available).
 
 	void load(Common::SeekableReadStream &herf);
+	void loadIndex(Common::SeekableReadStream &index);
 	void searchDictionary(Common::SeekableReadStream &herf, uint32 resCount);
 	void readDictionary(Common::SeekableReadStream &herf, std::map<uint32, Common::UString> &dict);
 	void readResList(Common::SeekableReadStream &herf);
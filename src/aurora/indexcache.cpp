@@ -0,0 +1,143 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent on-disk cache of parsed archive indices.
+ */
+
+#include <cstdio>
+
+#include <random>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/hash.h"
+#include "src/common/filepath.h"
+#include "src/common/encoding.h"
+#include "src/common/readstream.h"
+#include "src/common/mappedreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/indexcache.h"
+
+static const uint32 kIndexCacheID = MKTAG('X', 'I', 'D', 'X');
+static const uint32 kVersion10    = MKTAG('V', '1', '.', '0');
+
+namespace Aurora {
+
+IndexCache::IndexCache(const Common::UString &directory) {
+	Common::FilePath::createDirectories(directory);
+
+	_directory = Common::FilePath::canonicalize(directory);
+}
+
+IndexCache::~IndexCache() {
+}
+
+Common::UString IndexCache::getCacheFile(const Common::UString &file) const {
+	const uint64 hash = Common::hashStringFNV64(file);
+
+	return _directory + "/" + Common::UString::format("%08X%08X.idx", (uint)(hash >> 32), (uint)(hash & 0xFFFFFFFF));
+}
+
+Common::SeekableReadStream *IndexCache::getIndex(const Common::UString &file, uint32 type) const {
+	const Common::UString path      = Common::FilePath::canonicalize(file);
+	const Common::UString cacheFile = getCacheFile(path);
+
+	if (!Common::FilePath::isRegularFile(cacheFile))
+		return 0;
+
+	const size_t fileSize = Common::FilePath::getFileSize(path);
+	const int64  fileTime = Common::FilePath::getModificationTime(path);
+	if ((fileSize == Common::kFileInvalid) || (fileTime < 0))
+		return 0;
+
+	try {
+		Common::ScopedPtr<Common::SeekableReadStream> cache(new Common::MappedReadStream(cacheFile));
+
+		if ((cache->readUint32BE() != kIndexCacheID) || (cache->readUint32BE() != kVersion10))
+			return 0;
+
+		if (cache->readUint32BE() != type)
+			return 0;
+
+		if ((cache->readUint64LE() != fileSize) || ((int64) cache->readUint64LE() != fileTime))
+			return 0;
+
+		// Different paths can have the same hash, so we do need to check the full path
+		if (Common::readString(*cache, Common::kEncodingUTF8) != path)
+			return 0;
+
+		const size_t indexSize  = cache->readUint32LE();
+		const size_t indexBegin = cache->pos();
+		if (indexSize > (cache->size() - indexBegin))
+			return 0;
+
+		return new Common::SeekableSubReadStream(cache.release(), indexBegin, indexBegin + indexSize, true);
+
+	} catch (...) {
+	}
+
+	return 0;
+}
+
+void IndexCache::putIndex(const Common::UString &file, uint32 type, Common::MemoryWriteStreamDynamic &index) const {
+	const Common::UString path      = Common::FilePath::canonicalize(file);
+	const Common::UString cacheFile = getCacheFile(path);
+
+	const size_t fileSize = Common::FilePath::getFileSize(path);
+	const int64  fileTime = Common::FilePath::getModificationTime(path);
+	if ((fileSize == Common::kFileInvalid) || (fileTime < 0))
+		return;
+
+	/* Write into a temporary file first, and then move it into place. That way,
+	 * other processes reading the same cache never see a partially written file. */
+	const Common::UString tempFile = cacheFile + Common::UString::format(".%08X", (uint) std::random_device()());
+
+	try {
+		Common::WriteFile cache(tempFile);
+
+		cache.writeUint32BE(kIndexCacheID);
+		cache.writeUint32BE(kVersion10);
+		cache.writeUint32BE(type);
+
+		cache.writeUint64LE(fileSize);
+		cache.writeUint64LE(fileTime);
+
+		Common::writeString(cache, path, Common::kEncodingUTF8);
+
+		cache.writeUint32LE(index.size());
+		cache.write(index.getData(), index.size());
+
+		cache.flush();
+		cache.close();
+
+		if (!Common::FilePath::renameFile(tempFile, cacheFile))
+			throw Common::Exception("Failed to rename \"%s\" to \"%s\"", tempFile.c_str(), cacheFile.c_str());
+
+	} catch (...) {
+		std::remove(tempFile.c_str());
+
+		Common::exceptionDispatcherWarnAndIgnore("Failed to write the index cache of \"" + path + "\"");
+	}
+}
+
+} // End of namespace Aurora
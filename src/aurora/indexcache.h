@@ -0,0 +1,90 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent on-disk cache of parsed archive indices.
+ */
+
+#ifndef AURORA_INDEXCACHE_H
+#define AURORA_INDEXCACHE_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+	class SeekableReadStream;
+	class MemoryWriteStreamDynamic;
+}
+
+namespace Aurora {
+
+/** A persistent on-disk cache of parsed archive indices.
+ *
+ *  Parsing the resource tables of big archives (the key and resource
+ *  lists of an ERF, the dictionary of an HERF, the resource list of
+ *  a KEY) can take a noticeable amount of time. When the same archives
+ *  are opened again and again, the parsed tables can instead be stored
+ *  in this cache, and restored with a single mapping of the cache file.
+ *
+ *  Each archive file has one cache file, named after the hash of the
+ *  archive's canonical path. A cached index is only considered valid
+ *  if the archive's path, size and modification time all still match,
+ *  together with the type of the index. The content of the index itself
+ *  is opaque to the cache: each archive class writes and reads its own.
+ *
+ *  Cache files are replaced atomically, so several processes can share
+ *  one cache directory.
+ */
+class IndexCache : boost::noncopyable {
+public:
+	/** Keep the cached indices in this directory, creating it if necessary. */
+	IndexCache(const Common::UString &directory);
+	~IndexCache();
+
+	/** Return the cached index of this type for this archive file.
+	 *
+	 *  @param  file The archive file the index belongs to.
+	 *  @param  type The type of the index, usually the archive's ID.
+	 *  @return The contents of the index, or 0 if there is no valid index.
+	 */
+	Common::SeekableReadStream *getIndex(const Common::UString &file, uint32 type) const;
+
+	/** Store an index of this type for this archive file in the cache.
+	 *
+	 *  Failing to write the cache is not an error, it only prints a warning.
+	 *
+	 *  @param file The archive file the index belongs to.
+	 *  @param type The type of the index, usually the archive's ID.
+	 *  @param index The contents of the index.
+	 */
+	void putIndex(const Common::UString &file, uint32 type, Common::MemoryWriteStreamDynamic &index) const;
+
+private:
+	Common::UString _directory;
+
+	/** Return the path of the cache file for this archive file. */
+	Common::UString getCacheFile(const Common::UString &file) const;
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_INDEXCACHE_H
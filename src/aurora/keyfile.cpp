@@ -29,7 +29,9 @@
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/readstream.h"
+#include "src/common/writestream.h"
 #include "src/common/encoding.h"
 
 #include "src/aurora/keyfile.h"
@@ -42,6 +44,10 @@ namespace Aurora {
 
 KEYFile::KEYFile(Common::SeekableReadStream &key) {
 	load(key);
+	sortBIFResources();
+}
+
+KEYFile::KEYFile() {
 }
 
 KEYFile::~KEYFile() {
@@ -138,6 +144,63 @@ void KEYFile::readResList(Common::SeekableReadStream &key, uint32 offset) {
 	}
 }
 
+void KEYFile::sortBIFResources() {
+	_bifResources.clear();
+	_bifResources.resize(_bifs.size());
+
+	for (size_t i = 0; i < _resources.size(); i++)
+		if (_resources[i].bifIndex < _bifResources.size())
+			_bifResources[_resources[i].bifIndex].push_back(i);
+}
+
+void KEYFile::writeIndex(Common::WriteStream &index) const {
+	index.writeUint32BE(_id);
+	index.writeUint32BE(_version);
+
+	index.writeUint32LE(_bifs.size());
+	for (BIFList::const_iterator bif = _bifs.begin(); bif != _bifs.end(); ++bif)
+		Common::writeString(index, *bif, Common::kEncodingUTF8);
+
+	index.writeUint32LE(_resources.size());
+	for (ResourceList::const_iterator res = _resources.begin(); res != _resources.end(); ++res) {
+		Common::writeString(index, res->name, Common::kEncodingUTF8);
+
+		index.writeUint32LE((uint32) res->type);
+		index.writeUint32LE(res->bifIndex);
+		index.writeUint32LE(res->resIndex);
+	}
+}
+
+KEYFile *KEYFile::readIndex(Common::SeekableReadStream &index) {
+	Common::ScopedPtr<KEYFile> key(new KEYFile);
+
+	key->loadIndex(index);
+	key->sortBIFResources();
+
+	return key.release();
+}
+
+void KEYFile::loadIndex(Common::SeekableReadStream &index) {
+	_id      = index.readUint32BE();
+	_version = index.readUint32BE();
+
+	if (_id != kKEYID)
+		throw Common::Exception("Not a KEY index (%s)", Common::debugTag(_id).c_str());
+
+	_bifs.resize(index.readUint32LE());
+	for (BIFList::iterator bif = _bifs.begin(); bif != _bifs.end(); ++bif)
+		*bif = Common::readString(index, Common::kEncodingUTF8);
+
+	_resources.resize(index.readUint32LE());
+	for (ResourceList::iterator res = _resources.begin(); res != _resources.end(); ++res) {
+		res->name = Common::readString(index, Common::kEncodingUTF8);
+
+		res->type     = (FileType) index.readUint32LE();
+		res->bifIndex = index.readUint32LE();
+		res->resIndex = index.readUint32LE();
+	}
+}
+
 const KEYFile::BIFList &KEYFile::getBIFs() const {
 	return _bifs;
 }
@@ -146,4 +209,13 @@ const KEYFile::ResourceList &KEYFile::getResources() const {
 	return _resources;
 }
 
+const KEYFile::ResourceIndexList &KEYFile::getBIFResources(uint32 bifIndex) const {
+	static const ResourceIndexList kEmptyList;
+
+	if (bifIndex >= _bifResources.size())
+		return kEmptyList;
+
+	return _bifResources[bifIndex];
+}
+
 } // End of namespace Aurora
@@ -37,6 +37,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 }
 
 namespace Aurora {
@@ -80,6 +81,7 @@ public:
 
 	typedef std::vector<Resource> ResourceList;
 	typedef std::vector<Common::UString> BIFList;
+	typedef std::vector<uint32> ResourceIndexList;
 
 	KEYFile(Common::SeekableReadStream &key);
 	~KEYFile();
@@ -90,11 +92,28 @@ public:
 	/** Return a list of all containing resources. */
 	const ResourceList &getResources() const;
 
+	/** Return the indices into the resource list of all resources found in this bif. */
+	const ResourceIndexList &getBIFResources(uint32 bifIndex) const;
+
+	/** Write the parsed KEY into an index, see IndexCache. */
+	void writeIndex(Common::WriteStream &index) const;
+
+	/** Restore a KEY out of an index written by writeIndex(). */
+	static KEYFile *readIndex(Common::SeekableReadStream &index);
+
 private:
 	BIFList      _bifs;      ///< All managed bifs.
 	ResourceList _resources; ///< All containing resources.
 
+	/** The indices of all resources, by bif. */
+	std::vector<ResourceIndexList> _bifResources;
+
+	KEYFile();
+
 	void load(Common::SeekableReadStream &key);
+	void loadIndex(Common::SeekableReadStream &index);
+
+	void sortBIFResources();
 
 	void readBIFList(Common::SeekableReadStream &key, uint32 offset);
 	void readResList(Common::SeekableReadStream &key, uint32 offset);
@@ -191,7 +191,11 @@ Common::SeekableReadStream *OBBFile::getResource(uint32 index, bool UNUSED(tryNo
 
 	const IResource &res = getIResource(index);
 
-	_obb->seek(res.offset);
+	if (res.offset > _obb->size())
+		throw Common::Exception(Common::kSeekError);
+
+	// Read the chunks through a substream, to leave the OBB stream's position alone
+	Common::PositionalSubReadStream obb(_obb.get(), res.offset, _obb->size());
 
 	Common::ScopedArray<byte> data(new byte[res.uncompressedSize]);
 
@@ -200,7 +204,7 @@ Common::SeekableReadStream *OBBFile::getResource(uint32 index, bool UNUSED(tryNo
 
 	while (bytesLeft > 0) {
 		const size_t bytesChunk =
-			Common::decompressDeflateChunk(*_obb, Common::kWindowBitsMax,
+			Common::decompressDeflateChunk(obb, Common::kWindowBitsMax,
 			                               data.get() + offset, bytesLeft, 4096);
 
 		offset    += bytesChunk;
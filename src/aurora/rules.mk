@@ -28,6 +28,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/language.h \
     src/aurora/language_strings.h \
     src/aurora/archive.h \
+    src/aurora/indexcache.h \
     src/aurora/aurorafile.h \
     src/aurora/erffile.h \
     src/aurora/rimfile.h \
@@ -70,6 +71,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/util.cpp \
     src/aurora/language.cpp \
     src/aurora/archive.cpp \
+    src/aurora/indexcache.cpp \
     src/aurora/aurorafile.cpp \
     src/aurora/erffile.cpp \
     src/aurora/rimfile.cpp \
@@ -213,12 +213,10 @@ void TalkTable_TLK::setEntry(uint32 strRef, const Common::UString &string, const
                              uint32 soundID) {
 
 	if (strRef >= _entries.size()) {
+		// All existing strRefs are lower than the current size, so the list stays sorted
 		for (size_t i = _entries.size(); i < strRef; i++)
 			_strRefs.push_back(i);
 
-		_strRefs.sort();
-		_strRefs.unique();
-
 		_entries.resize(strRef + 1);
 	}
 
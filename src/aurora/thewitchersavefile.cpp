@@ -49,12 +49,9 @@ Common::SeekableReadStream *TheWitcherSaveFile::getResource(uint32 index, bool t
 	IResource resource = _resources[index];
 
 	if (tryNoCopy)
-		return new Common::SeekableSubReadStream(_tws.get(), resource.offset, resource.offset + resource.length);
-	else {
-		_tws->seek(resource.offset);
-		Common::SeekableReadStream *readStream = _tws->readStream(resource.length);
-		return readStream;
-	}
+		return _tws->getPositionalSubStream(resource.offset, resource.offset + resource.length);
+	else
+		return _tws->readStreamAt(resource.offset, resource.length);
 }
 
 void TheWitcherSaveFile::load() {
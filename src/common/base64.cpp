@@ -25,6 +25,7 @@
 #include <cassert>
 
 #include "src/common/base64.h"
+#include "src/common/util.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 #include "src/common/error.h"
@@ -47,35 +48,8 @@ static const uint8 kBase64Values[128] = {
 	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
 };
 
-/** Write a character into our base64 string, and update the remaining
- *  string length.
- *
- *  Returns false if we ran out of remaining characters in this string.
- */
-static bool writeCharacter(UString &base64, uint32 c, size_t &maxLength) {
-	assert(maxLength > 0);
-
-	base64 += c;
-
-	return --maxLength > 0;
-}
-
-/** Write multiple characters into our base64 string, and update the remaining
- *  string length.
- *
- *  Returns false if we ran out of remaining characters in this string.
- */
-static bool writeCharacters(UString &base64, UString &str, size_t &lineLength) {
-	while (!str.empty()) {
-		writeCharacter(base64, *str.begin(), lineLength);
-		str.erase(str.begin());
-
-		if (lineLength == 0)
-			return false;
-	}
-
-	return lineLength > 0;
-}
+/** The number of input bytes encoded in one go. Needs to be divisible by 3. */
+static const size_t kEncodeBlockSize = 3 * 1024;
 
 /** Find the raw value of a base64-encoded character. */
 static uint8 findCharacterValue(uint32 c) {
@@ -85,56 +59,51 @@ static uint8 findCharacterValue(uint32 c) {
 	return kBase64Values[c];
 }
 
-/** Encode data into base64 and write the result into the string, but only up
- *  to maxLength characters.
+/** Read a block of up to kEncodeBlockSize bytes of data.
  *
- *  The string overhang is and input/output string of both the overhang from
- *  the previous run of this function (which will get written into the base64
- *  string first) and the newly produced overhang.
+ *  Only the last block of the data can be shorter than kEncodeBlockSize,
+ *  so that padding is only ever added at the very end.
  *
- *  Returns false if we have written all data there is to write, both from the
- *  overhang and the input data stream.
+ *  Returns the number of bytes read, 0 if we reached the end of the data.
  */
-static bool encodeBase64(ReadStream &data, UString &base64, size_t maxLength, UString &overhang) {
-	if (maxLength == 0)
-		throw Exception("Invalid base64 max line length");
-
-	// First write the overhang, and return if we already maxed out the length there
-	if (!writeCharacters(base64, overhang, maxLength))
-		return true;
-
-	overhang.clear();
-
-	uint8 n;
-	byte input[3];
-
-	// Read up to 3 characters at a time
-	while ((n = data.read(input, 3)) != 0) {
-		uint32 code = 0;
+static size_t readBlock(ReadStream &data, byte *block) {
+	size_t size = 0;
 
-		// Concat the input characters
-		for (uint8 i = 0; i < n; i++)
-			code |= input[i] << (24 - i * 8);
+	while (size < kEncodeBlockSize) {
+		const size_t n = data.read(block + size, kEncodeBlockSize - size);
+		if (n == 0)
+			break;
 
-		// Create up to 4 6-bit base64-characters out of them
-		for (uint8 i = 0; i < (n + 1); i++) {
-			overhang += kBase64Char[(code >> 26) & 0x0000003F];
-			code <<= 6;
-		}
-
-		// Add padding
-		for (int i = 0; i < (3 - n); i++)
-			overhang += '=';
+		size += n;
+	}
 
-		// Write the base64 characters into the string, and return if we maxed out the length
-		if (!writeCharacters(base64, overhang, maxLength))
-			return true;
+	return size;
+}
 
-		overhang.clear();
+/** Encode a block of data into base64 characters, padding an incomplete last group.
+ *
+ *  Returns the number of base64 characters written.
+ */
+static size_t encodeBlock(const byte *data, size_t size, char *base64) {
+	char *out = base64;
+
+	// Create 4 6-bit base64-characters out of each 3 input bytes
+	for (size_t i = 0; i < size; i += 3) {
+		const size_t n = MIN<size_t>(size - i, 3);
+
+		uint32 code = data[i] << 16;
+		if (n > 1)
+			code |= data[i + 1] << 8;
+		if (n > 2)
+			code |= data[i + 2];
+
+		*out++ = kBase64Char[(code >> 18) & 0x3F];
+		*out++ = kBase64Char[(code >> 12) & 0x3F];
+		*out++ = (n > 1) ? kBase64Char[(code >> 6) & 0x3F] : '=';
+		*out++ = (n > 2) ? kBase64Char[ code       & 0x3F] : '=';
 	}
 
-	// We reached the end of input the data
-	return false;
+	return out - base64;
 }
 
 static void decodeBase64(WriteStream &data, const UString &base64, UString &overhang) {
@@ -189,22 +158,42 @@ static size_t countLength(const std::list<UString> &str) {
 
 
 void encodeBase64(ReadStream &data, UString &base64) {
-	UString overhang;
+	byte input[kEncodeBlockSize];
+	char output[(kEncodeBlockSize / 3) * 4];
 
-	encodeBase64(data, base64, SIZE_MAX, overhang);
+	size_t n;
+	while ((n = readBlock(data, input)) != 0)
+		base64 += UString(output, encodeBlock(input, n, output));
 }
 
 void encodeBase64(ReadStream &data, std::list<UString> &base64, size_t lineLength) {
-	UString overhang;
+	if (lineLength == 0)
+		throw Exception("Invalid base64 max line length");
+
+	byte input[kEncodeBlockSize];
+	char output[(kEncodeBlockSize / 3) * 4];
 
 	// Base64-encode the data, creating a new string after every lineLength characters
-	do {
-		base64.push_back(UString());
-	} while (encodeBase64(data, base64.back(), lineLength, overhang));
+	size_t lineLeft = 0;
+
+	size_t n;
+	while ((n = readBlock(data, input)) != 0) {
+		const size_t length = encodeBlock(input, n, output);
+
+		for (size_t i = 0; i < length; ) {
+			if (lineLeft == 0) {
+				base64.push_back(UString());
+				lineLeft = lineLength;
+			}
 
-	// Trim empty strings from the back
-	while (!base64.empty() && base64.back().empty())
-		base64.pop_back();
+			const size_t count = MIN(lineLeft, length - i);
+
+			base64.back() += UString(output + i, count);
+
+			i        += count;
+			lineLeft -= count;
+		}
+	}
 }
 
 SeekableReadStream *decodeBase64(const UString &base64) {
@@ -19,7 +19,7 @@
  */
 
 /** @file
- *  Simple utility template for searching through static const maps.
+ *  Simple utility templates for searching through static const maps.
  */
 
 #ifndef COMMON_BINSEARCH_H
@@ -27,6 +27,10 @@
 
 #include <cstddef>
 
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
 namespace Common {
 
 /** Struct template for a generic searchable key/value pair. */
@@ -55,6 +59,71 @@ const BinSearchValue<TK, TV> *binarySearch(const BinSearchValue<TK, TV> *map, si
 	return 0;
 }
 
+/** A search index over a sorted list of key/value pairs.
+ *
+ *  For big lists that are searched often, binarySearch() spends most
+ *  of its time waiting on cache misses: every step of the search jumps
+ *  to a far-away part of the list.
+ *
+ *  This index instead stores a copy of the keys in Eytzinger layout,
+ *  ordered like a binary heap: the children of the node k are at 2k and
+ *  2k + 1. The first levels of the search tree all share a few cache
+ *  lines, the following levels are close to each other, and the search
+ *  itself compiles down to a loop without unpredictable branches.
+ *
+ *  The list of key/value pairs has to be sorted by key, and has to stay
+ *  valid for the lifetime of the index.
+ */
+template<typename TK, typename TV>
+class EytzingerIndex : boost::noncopyable {
+public:
+	EytzingerIndex(const BinSearchValue<TK, TV> *map, size_t size) : _map(map), _size(size) {
+		_keys.resize(_size + 1);
+		_indices.resize(_size + 1);
+
+		build(0, 1);
+	}
+
+	/** Search for this key, returning its key/value pair or 0 if not found. */
+	const BinSearchValue<TK, TV> *find(const TK &value) const {
+		size_t k = 1;
+		while (k <= _size)
+			k = 2 * k + (_keys[k] < value);
+
+		/* We went one level below the leaves. The node we're looking for is
+		 * the one where the search went left for the last time, so strip all
+		 * the right turns (set bits) at the end, and then the left turn. */
+		while (k & 1)
+			k >>= 1;
+		k >>= 1;
+
+		if ((k == 0) || !(_keys[k] == value))
+			return 0;
+
+		return &_map[_indices[k]];
+	}
+
+private:
+	const BinSearchValue<TK, TV> *_map;
+	size_t _size;
+
+	std::vector<TK>     _keys;    ///< The keys, in Eytzinger layout (1-based).
+	std::vector<size_t> _indices; ///< The indices of the keys in the original list.
+
+	/** Place the sorted list, starting at index i, into the subtree at node k. */
+	size_t build(size_t i, size_t k) {
+		if (k > _size)
+			return i;
+
+		i = build(i, 2 * k);
+
+		_keys[k]    = _map[i].key;
+		_indices[k] = i++;
+
+		return build(i, 2 * k + 1);
+	}
+};
+
 } // End of namespace Common
 
 #endif // COMMON_BINSEARCH_H
@@ -0,0 +1,182 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A buffering wrapper around a seekable read stream.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "src/common/bufferedreadstream.h"
+#include "src/common/error.h"
+#include "src/common/util.h"
+
+namespace Common {
+
+BufferedReadStream::BufferedReadStream(SeekableReadStream *parentStream, bool disposeParentStream,
+                                       size_t bufferSize) :
+	_parentStream(parentStream, disposeParentStream), _size(parentStream->size()),
+	_buffer(new byte[MAX<size_t>(bufferSize, 1)]), _bufferSize(MAX<size_t>(bufferSize, 1)),
+	_bufferPos(0), _bufferFill(0), _pos(0), _eos(false) {
+
+	assert(parentStream);
+
+	setPos(parentStream->pos());
+}
+
+BufferedReadStream::~BufferedReadStream() {
+}
+
+bool BufferedReadStream::fillBuffer(size_t pos) {
+	_bufferPos  = pos;
+	_bufferFill = 0;
+
+	if (pos < _size)
+		_bufferFill = _parentStream->readAt(pos, _buffer.get(), MIN(_bufferSize, _size - pos));
+
+	return _bufferFill > 0;
+}
+
+void BufferedReadStream::setPos(size_t pos) {
+	_pos = pos;
+
+	if ((pos >= _bufferPos) && (pos <= (_bufferPos + _bufferFill))) {
+		_readBufferPos = _buffer.get() + (pos - _bufferPos);
+		_readBufferEnd = _buffer.get() + _bufferFill;
+	} else {
+		_readBufferPos = 0;
+		_readBufferEnd = 0;
+	}
+}
+
+bool BufferedReadStream::eos() const {
+	return _eos;
+}
+
+size_t BufferedReadStream::read(void *dataPtr, size_t dataSize) {
+	assert(dataPtr);
+
+	byte *data = reinterpret_cast<byte *>(dataPtr);
+
+	size_t readSize = 0;
+	while (readSize < dataSize) {
+		// Take as much as possible out of the buffer
+		const size_t buffered = _readBufferEnd - _readBufferPos;
+		if (buffered > 0) {
+			const size_t copySize = MIN(buffered, dataSize - readSize);
+
+			std::memcpy(data + readSize, _readBufferPos, copySize);
+
+			_readBufferPos += copySize;
+			readSize       += copySize;
+			continue;
+		}
+
+		const size_t curPos = pos();
+		if (curPos >= _size) {
+			_eos = true;
+			break;
+		}
+
+		// Big reads go directly into the destination
+		const size_t leftSize = dataSize - readSize;
+		if (leftSize >= _bufferSize) {
+			const size_t directSize = _parentStream->readAt(curPos, data + readSize, MIN(leftSize, _size - curPos));
+
+			setPos(curPos + directSize);
+			readSize += directSize;
+
+			if (directSize < leftSize) {
+				_eos = true;
+				break;
+			}
+
+			continue;
+		}
+
+		const bool filled = fillBuffer(curPos);
+		setPos(curPos);
+
+		if (!filled) {
+			_eos = true;
+			break;
+		}
+	}
+
+	return readSize;
+}
+
+size_t BufferedReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	assert(dataPtr);
+
+	if (offset > _size)
+		throw Exception(kSeekError);
+
+	dataSize = MIN(dataSize, _size - offset);
+
+	// Big reads go directly into the destination
+	if (dataSize >= _bufferSize)
+		return _parentStream->readAt(offset, dataPtr, dataSize);
+
+	// Otherwise, make sure the range is in the buffer, without changing our current position
+	if ((offset < _bufferPos) || ((offset - _bufferPos) + dataSize > _bufferFill)) {
+		const size_t curPos = pos();
+
+		fillBuffer(offset);
+		setPos(curPos);
+	}
+
+	const size_t readSize = MIN(dataSize, _bufferFill - MIN(_bufferFill, offset - _bufferPos));
+
+	std::memcpy(dataPtr, _buffer.get() + (offset - _bufferPos), readSize);
+
+	return readSize;
+}
+
+size_t BufferedReadStream::pos() const {
+	if (_readBufferPos)
+		return _bufferPos + (_readBufferPos - _buffer.get());
+
+	return _pos;
+}
+
+size_t BufferedReadStream::size() const {
+	return _size;
+}
+
+size_t BufferedReadStream::seek(ptrdiff_t offset, Origin whence) {
+	const size_t oldPos = pos();
+	const size_t newPos = evalSeek(offset, whence, oldPos, 0, _size);
+	if (newPos > _size)
+		throw Exception(kSeekError);
+
+	setPos(newPos);
+
+	_eos = false;
+
+	return oldPos;
+}
+
+const byte *BufferedReadStream::getData() const {
+	return _parentStream->getData();
+}
+
+} // End of namespace Common
@@ -0,0 +1,99 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A buffering wrapper around a seekable read stream.
+ */
+
+#ifndef COMMON_BUFFEREDREADSTREAM_H
+#define COMMON_BUFFEREDREADSTREAM_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/disposableptr.h"
+#include "src/common/readstream.h"
+
+namespace Common {
+
+/** A stream that reads its parent stream in big blocks, and serves small
+ *  reads out of a memory buffer.
+ *
+ *  This is meant for parsers that read a file in lots of small pieces, like
+ *  single 16-bit or 32-bit values. The fixed-size read methods (readUint32LE(),
+ *  etc.) take the data straight out of the buffer, and only call the virtual
+ *  read() when the buffer needs to be refilled.
+ *
+ *  The buffered stream covers the whole parent stream, and starts reading at
+ *  the parent stream's current position. All reads from the parent stream
+ *  go through its readAt(), so the parent stream's position is never changed.
+ *
+ *  readAt() is served out of the same buffer, so substreams reading through
+ *  it profit as well. Unlike on a ReadFile, concurrent readAt() calls on a
+ *  BufferedReadStream are not safe.
+ */
+class BufferedReadStream : boost::noncopyable, public SeekableReadStream {
+public:
+	static const size_t kDefaultBufferSize = 16384;
+
+	BufferedReadStream(SeekableReadStream *parentStream, bool disposeParentStream = false,
+	                   size_t bufferSize = kDefaultBufferSize);
+	~BufferedReadStream();
+
+	bool eos() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+
+	const byte *getData() const;
+
+private:
+	DisposablePtr<SeekableReadStream> _parentStream;
+
+	const size_t _size; ///< The size of the parent stream.
+
+	ScopedArray<byte> _buffer;     ///< The read buffer.
+	const size_t      _bufferSize; ///< The capacity of the read buffer.
+	size_t            _bufferPos;  ///< The position within the parent stream the buffer starts at.
+	size_t            _bufferFill; ///< The number of valid bytes in the buffer.
+
+	/** The current position, if it lies outside the buffer.
+	 *
+	 *  Otherwise, the position is given by _readBufferPos.
+	 */
+	size_t _pos;
+
+	bool _eos;
+
+	/** Fill the buffer with data from this position within the parent stream. */
+	bool fillBuffer(size_t pos);
+	/** Move the current position, reading out of the buffer if the position lies within it. */
+	void setPos(size_t pos);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_BUFFEREDREADSTREAM_H
@@ -22,12 +22,16 @@
  *  Compress (deflate) and decompress (inflate) using zlib's DEFLATE algorithm.
  */
 
+#include <cassert>
+#include <cstring>
+
 #include <zlib.h>
 
 #include <boost/scope_exit.hpp>
 
 #include "src/common/deflate.h"
 #include "src/common/error.h"
+#include "src/common/util.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ptrvector.h"
 #include "src/common/memreadstream.h"
@@ -225,6 +229,157 @@ size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits,
 	return strm.total_out;
 }
 
+
+
+DeflateReadStream::DeflateReadStream(SeekableReadStream *input, bool disposeInput, size_t outputSize,
+                                     int windowBits, unsigned int frameSize) :
+	_input(input, disposeInput), _inputStart(input->pos()), _size(outputSize),
+	_windowBits(windowBits), _frameSize(MAX(frameSize, 1U)), _inputFrame(new byte[MAX(frameSize, 1U)]),
+	_pos(0), _streamEnd(false), _eos(false) {
+
+	assert(input);
+
+	initInflate();
+}
+
+DeflateReadStream::~DeflateReadStream() {
+	endInflate();
+}
+
+void DeflateReadStream::initInflate() {
+	_strm.reset(new z_stream);
+	std::memset(_strm.get(), 0, sizeof(z_stream));
+
+	try {
+		initInflateZStream(*_strm, _windowBits, 0, 0);
+	} catch (...) {
+		_strm.reset();
+		throw;
+	}
+
+	_input->seek(_inputStart);
+
+	_pos       = 0;
+	_streamEnd = false;
+}
+
+void DeflateReadStream::endInflate() {
+	if (_strm)
+		inflateEnd(_strm.get());
+
+	_strm.reset();
+}
+
+void DeflateReadStream::inflateData(byte *dataPtr, size_t dataSize) {
+	assert(_strm);
+
+	_strm->avail_out = dataSize;
+	_strm->next_out  = dataPtr;
+
+	while (_strm->avail_out > 0) {
+		if (_streamEnd)
+			throw Exception("Failed to inflate: output buffer not completely filled");
+
+		if (_strm->avail_in == 0) {
+			const size_t inputSize = MIN<size_t>(_input->size() - _input->pos(), _frameSize);
+			if (inputSize == 0)
+				throw Exception("Failed to inflate: input buffer empty, stream not ended");
+
+			if (_input->read(_inputFrame.get(), inputSize) != inputSize)
+				throw Exception(kReadError);
+
+			setZStreamInput(*_strm, inputSize, _inputFrame.get());
+		}
+
+		// Decompress. Z_SYNC_FLUSH, because we want to decompress partwise.
+		const int zResult = inflate(_strm.get(), Z_SYNC_FLUSH);
+		if (zResult == Z_STREAM_END)
+			_streamEnd = true;
+		else if (zResult != Z_OK)
+			throw Exception("Failed to inflate: %s (%d)", zError(zResult), zResult);
+	}
+
+	_pos += dataSize;
+}
+
+void DeflateReadStream::inflateAll() {
+	const size_t oldPos = _pos;
+
+	endInflate();
+	initInflate();
+
+	ScopedArray<byte> data(new byte[_size]);
+	inflateData(data.get(), _size);
+
+	endInflate();
+
+	_data.reset(new MemoryReadStream(data.release(), _size, true));
+	_data->seek(oldPos);
+}
+
+bool DeflateReadStream::eos() const {
+	return _eos;
+}
+
+size_t DeflateReadStream::read(void *dataPtr, size_t dataSize) {
+	assert(dataPtr);
+
+	if (_data) {
+		const size_t readSize = _data->read(dataPtr, dataSize);
+		_eos = _data->eos();
+
+		return readSize;
+	}
+
+	if (dataSize > (_size - _pos)) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	inflateData(reinterpret_cast<byte *>(dataPtr), dataSize);
+
+	return dataSize;
+}
+
+size_t DeflateReadStream::pos() const {
+	return _data ? _data->pos() : _pos;
+}
+
+size_t DeflateReadStream::size() const {
+	return _size;
+}
+
+size_t DeflateReadStream::seek(ptrdiff_t offset, Origin whence) {
+	const size_t oldPos = pos();
+	const size_t newPos = evalSeek(offset, whence, oldPos, 0, _size);
+	if (newPos > _size)
+		throw Exception(kSeekError);
+
+	// We can't go backwards in an inflating stream
+	if (!_data && (newPos < _pos))
+		inflateAll();
+
+	if (_data) {
+		_data->seek(newPos);
+
+	} else {
+		// Skip forward by decompressing into a scratch buffer
+
+		ScopedArray<byte> skipBuffer(new byte[_frameSize]);
+		while (_pos < newPos)
+			inflateData(skipBuffer.get(), MIN<size_t>(newPos - _pos, _frameSize));
+	}
+
+	_eos = false;
+
+	return oldPos;
+}
+
+const byte *DeflateReadStream::getData() const {
+	return _data ? _data->getData() : 0;
+}
+
+
 byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, int windowBits, unsigned int frameSize) {
 	z_stream strm;
 	BOOST_SCOPE_EXIT( (&strm) ) {
@@ -243,18 +398,17 @@ byte *compressDeflate(const byte *data, size_t inputSize, size_t &outputSize, in
 		strm.avail_out = frameSize;
 		strm.next_out = buffers.back();
 
-		// Compress.
+		// Compress. Even with all input consumed, there might still be output pending.
 		zResult = deflate(&strm, Z_FINISH);
 		if (zResult != Z_STREAM_END && zResult != Z_OK)
 			throw Exception("Failed to deflate: %s (%d)", zError(zResult), zResult);
-	} while (strm.avail_in != 0);
+	} while (zResult != Z_STREAM_END);
 
 	ScopedArray<byte> compressedData(new byte[strm.total_out]);
 	for (size_t i = 0; i < buffers.size(); ++i) {
-		if (i == buffers.size() - 1)
-			std::memcpy(compressedData.get() + i * frameSize, buffers[i], strm.total_out % frameSize);
-		else
-			std::memcpy(compressedData.get() + i * frameSize, buffers[i], frameSize);
+		const size_t offset = i * frameSize;
+
+		std::memcpy(compressedData.get() + offset, buffers[i], MIN<size_t>(strm.total_out - offset, frameSize));
 	}
 
 	outputSize = strm.total_out;
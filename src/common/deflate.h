@@ -25,7 +25,14 @@
 #ifndef COMMON_DEFLATE_H
 #define COMMON_DEFLATE_H
 
+#include <boost/noncopyable.hpp>
+
 #include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/disposableptr.h"
+#include "src/common/readstream.h"
+
+struct z_stream_s;
 
 namespace Common {
 
@@ -35,8 +42,7 @@ namespace Common {
  *   of the decompressed data beforehand
  */
 
-class ReadStream;
-class SeekableReadStream;
+class MemoryReadStream;
 
 static const int kWindowBitsMax    =  15;
 static const int kWindowBitsMaxRaw = -kWindowBitsMax;
@@ -117,6 +123,73 @@ SeekableReadStream *decompressDeflateWithoutOutputSize(ReadStream &input, size_t
 size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits, byte *output, size_t outputSize,
                               unsigned int frameSize = 4096);
 
+/** A stream that decompresses (inflates) its input using zlib's DEFLATE
+ *  algorithm on demand, while it is being read.
+ *
+ *  Only a small window of the compressed input is held in memory at any time.
+ *  Reading sequentially and seeking forward is cheap. Seeking backwards,
+ *  however, can't be done in an inflating stream: on the first backwards
+ *  seek, the whole data is decompressed into memory once, and all further
+ *  access is served from there.
+ *
+ *  The compressed data starts at the input stream's position at the time
+ *  of construction. The size of the decompressed data has to be known.
+ */
+class DeflateReadStream : boost::noncopyable, public SeekableReadStream {
+public:
+	/** Create an inflating stream.
+	 *
+	 *  @param input        The compressed input data.
+	 *  @param disposeInput Should the input stream be deleted together with this stream?
+	 *  @param outputSize   The size of the decompressed output data.
+	 *  @param windowBits   The base two logarithm of the window size (the size of
+	 *                      the history buffer). See the zlib documentation on
+	 *                      inflateInit2() for details.
+	 *  @param frameSize    The size of a frame for reading from the input stream.
+	 */
+	DeflateReadStream(SeekableReadStream *input, bool disposeInput, size_t outputSize,
+	                  int windowBits, unsigned int frameSize = 4096);
+	~DeflateReadStream();
+
+	bool eos() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+
+	const byte *getData() const;
+
+private:
+	DisposablePtr<SeekableReadStream> _input;
+
+	const size_t _inputStart; ///< The position of the compressed data within the input stream.
+	const size_t _size;       ///< The size of the decompressed data.
+
+	const int          _windowBits;
+	const unsigned int _frameSize;
+
+	ScopedPtr<z_stream_s> _strm;       ///< The zlib stream, while we're still inflating on demand.
+	ScopedArray<byte>     _inputFrame; ///< The current frame of compressed input data.
+
+	size_t _pos;       ///< The current position within the decompressed data.
+	bool   _streamEnd; ///< Has the zlib stream ended?
+	bool   _eos;
+
+	/** All the decompressed data, once we had to seek backwards. */
+	ScopedPtr<MemoryReadStream> _data;
+
+	void initInflate();
+	void endInflate();
+
+	/** Decompress the next dataSize bytes into dataPtr. */
+	void inflateData(byte *dataPtr, size_t dataSize);
+	/** Decompress the whole data into memory, for random access. */
+	void inflateAll();
+};
+
 /** Compress (deflate) using zlib's DEFLATE algorithm.
  *
  *  @param input      The input data to compress.
@@ -40,6 +40,8 @@ using boost::filesystem::exists;
 using boost::filesystem::is_regular_file;
 using boost::filesystem::is_directory;
 using boost::filesystem::file_size;
+using boost::filesystem::last_write_time;
+using boost::filesystem::rename;
 using boost::filesystem::directory_iterator;
 using boost::filesystem::create_directories;
 
@@ -78,6 +80,15 @@ size_t FilePath::getFileSize(const UString &p) {
 	return size;
 }
 
+int64 FilePath::getModificationTime(const UString &p) {
+	try {
+		return last_write_time(p.c_str());
+	} catch (...) {
+	}
+
+	return -1;
+}
+
 UString FilePath::getFile(const UString &p) {
 	path file(p.c_str());
 
@@ -348,6 +359,16 @@ bool FilePath::createDirectories(const UString &path) {
 	}
 }
 
+bool FilePath::renameFile(const UString &from, const UString &to) {
+	try {
+		rename(from.c_str(), to.c_str());
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
 UString FilePath::escapeStringLiteral(const UString &str) {
 	const std::regex esc("[\\^\\.\\$\\|\\(\\)\\[\\]\\*\\+\\?\\/\\\\]");
 	const std::string rep("\\$&");
@@ -58,6 +58,13 @@ public:
 	 */
 	static size_t getFileSize(const UString &p);
 
+	/** Return the time a file was last modified.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The modification time in seconds since the epoch or -1 if not a valid file.
+	 */
+	static int64 getModificationTime(const UString &p);
+
 	/** Return a file name without its path.
 	 *
 	 *  Example: "/path/to/file.ext" > "file.ext"
@@ -201,6 +208,17 @@ public:
 	 */
 	static bool createDirectories(const UString &path);
 
+	/** Rename a file, replacing the target file if it already exists.
+	 *
+	 *  On POSIX systems, the replacement is atomic: any other process sees
+	 *  either the old or the new file, but never a partially written one.
+	 *
+	 *  @param  from The file to rename.
+	 *  @param  to The new name of the file.
+	 *  @return true if the file was renamed.
+	 */
+	static bool renameFile(const UString &from, const UString &to);
+
 	/** Escape a string literal for use in a regexp. */
 	static UString escapeStringLiteral(const UString &str);
 
@@ -26,6 +26,7 @@
 #include "src/common/types.h"
 #include <lzma.h>
 
+#include <boost/noncopyable.hpp>
 #include <boost/scope_exit.hpp>
 
 #include "src/common/lzma.h"
@@ -63,6 +64,53 @@ static lzma_allocator kLZMAAllocator = {
 	&lzmaAlloc, &lzmaFree, 0
 };
 
+/** A raw LZMA1 decoder, kept around to be reused.
+ *
+ *  Setting up an LZMA1 decoder allocates its dictionary, which can be
+ *  several MB in size. liblzma reuses that memory when a decoder is
+ *  initialized on an lzma_stream that has already been used, so each
+ *  thread keeps its own decoder around for all its decompression calls.
+ */
+class LZMA1Decoder : boost::noncopyable {
+public:
+	LZMA1Decoder() {
+		const lzma_stream init = LZMA_STREAM_INIT;
+
+		_strm = init;
+	}
+
+	~LZMA1Decoder() {
+		lzma_end(&_strm);
+	}
+
+	/** (Re)initialize the decoder for these filters, and return its stream. */
+	lzma_stream &init(const lzma_filter *filters) {
+		lzma_ret lzmaRet = LZMA_OK;
+
+		if ((lzmaRet = lzma_raw_decoder(&_strm, filters)) != LZMA_OK) {
+			// Don't keep a possibly broken decoder around
+			lzma_end(&_strm);
+
+			const lzma_stream init = LZMA_STREAM_INIT;
+			_strm = init;
+
+			throw Exception("Failed to create raw LZMA1 decoder: %d", (int) lzmaRet);
+		}
+
+		return _strm;
+	}
+
+	/** Return the decoder of the calling thread. */
+	static LZMA1Decoder &get() {
+		static thread_local LZMA1Decoder decoder;
+
+		return decoder;
+	}
+
+private:
+	lzma_stream _strm;
+};
+
 byte *decompressLZMA1(const byte *data, size_t inputSize, size_t outputSize, bool noEndMarker) {
 	lzma_filter filters[2] = {
 		{ LZMA_FILTER_LZMA1, 0 },
@@ -85,16 +133,11 @@ byte *decompressLZMA1(const byte *data, size_t inputSize, size_t outputSize, boo
 	data      += propsSize;
 	inputSize -= propsSize;
 
-	lzma_stream strm = LZMA_STREAM_INIT;
-	BOOST_SCOPE_EXIT( (&strm) (&filters) ) {
+	BOOST_SCOPE_EXIT( (&filters) ) {
 		kLZMAAllocator.free(0, filters[0].options);
-		lzma_end(&strm);
 	} BOOST_SCOPE_EXIT_END
 
-	lzma_ret lzmaRet = LZMA_OK;
-
-	if ((lzmaRet = lzma_raw_decoder(&strm, filters)) != LZMA_OK)
-		throw Exception("Failed to create raw LZMA1 decoder: %d", (int) lzmaRet);
+	lzma_stream &strm = LZMA1Decoder::get().init(filters);
 
 	ScopedArray<byte> outputData(new byte[outputSize]);
 
@@ -103,16 +146,25 @@ byte *decompressLZMA1(const byte *data, size_t inputSize, size_t outputSize, boo
 	strm.next_out  = outputData.get();
 	strm.avail_out = outputSize;
 
-	lzmaRet = lzma_code(&strm, LZMA_FINISH);
+	const lzma_ret lzmaRet = lzma_code(&strm, LZMA_FINISH);
+
+	// Don't leave pointers to our buffers dangling in the reused stream
+	const size_t availIn  = strm.avail_in;
+	const size_t availOut = strm.avail_out;
+
+	strm.next_in  = 0;
+	strm.avail_in = 0;
+	strm.next_out  = 0;
+	strm.avail_out = 0;
 
-	if (noEndMarker && (lzmaRet == LZMA_OK) && (strm.avail_in == 0) && (strm.avail_out == 0))
+	if (noEndMarker && (lzmaRet == LZMA_OK) && (availIn == 0) && (availOut == 0))
 		return outputData.release();
 
-	if ((lzmaRet != LZMA_STREAM_END) || (strm.avail_out != 0)) {
+	if ((lzmaRet != LZMA_STREAM_END) || (availOut != 0)) {
 		if (lzmaRet == LZMA_OK)
 			throw Exception("Failed to uncompress LZMA1 data: premature end of output buffer");
 
-		if (strm.avail_out != 0)
+		if (availOut != 0)
 			throw Exception("Failed to uncompress LZMA1 data: output buffer not completely filled");
 
 		throw Exception("Failed to uncompress LZMA1 data: %d", (int) lzmaRet);
@@ -166,26 +218,25 @@ SeekableReadStream *compressLZMA1(ReadStream &input, size_t inputSize) {
 	if ((lzmaRet = lzma_raw_encoder(&strm, filters)) != LZMA_OK)
 		throw Exception("Failed to create raw LZMA1 encode: %d", (int) lzmaRet);
 
-	byte *data = new byte[inputSize];
-	input.read(data, inputSize);
+	ScopedArray<byte> data(new byte[inputSize]);
+	if (input.read(data.get(), inputSize) != inputSize)
+		throw Exception(kReadError);
 
 	strm.avail_in = inputSize;
-	strm.next_in = data;
+	strm.next_in = data.get();
 
+	// Keep going until the encoder has flushed everything, not just until it consumed all input
 	byte outputData[4096];
 	do {
 		strm.avail_out = 4096;
 		strm.next_out = outputData;
 
 		lzmaRet = lzma_code(&strm, LZMA_FINISH);
+		if ((lzmaRet != LZMA_OK) && (lzmaRet != LZMA_STREAM_END))
+			throw Exception("Failed to compress LZMA1 data: %d", (int) lzmaRet);
 
 		writeStream.write(outputData, 4096 - strm.avail_out);
-	} while (strm.avail_in != 0 && lzmaRet != LZMA_OK);
-
-	delete[] data;
-
-	if (lzmaRet == LZMA_OK)
-		throw Exception("Failed to compress LZMA1 data: premature end of output buffer");
+	} while (lzmaRet != LZMA_STREAM_END);
 
 	if (strm.avail_in != 0)
 		throw Exception("Failed to compress LZMA1 data: input buffer not completely used");
@@ -33,6 +33,9 @@ class ReadStream;
 class SeekableReadStream;
 
 /** Decompress using the LZMA1 algorithm.
+ *
+ *  Each thread keeps its decoder state (most importantly, the dictionary)
+ *  around, to be reused by its following calls to decompressLZMA1().
  *
  *  @param  data       The compressed input data.
  *  @param  inputSize  The size of the input data in bytes.
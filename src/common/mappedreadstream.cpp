@@ -0,0 +1,197 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A read stream over a memory-mapped file.
+ */
+
+#include "src/common/system.h"
+
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#endif
+
+#if defined(UNIX)
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <limits>
+
+#include <boost/filesystem/path.hpp>
+
+#include "src/common/mappedreadstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/readfile.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+
+MappedReadStream::MappedReadStream(const UString &fileName) :
+	_mapping(0), _mappingSize(0), _mappingHandle(0) {
+
+	if (map(fileName))
+		_stream.reset(new MemoryReadStream(_mapping, _mappingSize));
+	else
+		_stream.reset(ReadFile::readIntoMemory(fileName));
+}
+
+MappedReadStream::~MappedReadStream() {
+	_stream.reset();
+
+	unmap();
+}
+
+#if defined(UNIX)
+
+bool MappedReadStream::map(const UString &fileName) {
+	int fd = ::open(boost::filesystem::path(fileName.c_str()).c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	struct stat fileStat;
+	if ((fstat(fd, &fileStat) != 0) || !S_ISREG(fileStat.st_mode) || (fileStat.st_size <= 0) ||
+	    ((uint64)fileStat.st_size > (uint64)std::numeric_limits<size_t>::max())) {
+
+		::close(fd);
+		return false;
+	}
+
+	const size_t size = (size_t)fileStat.st_size;
+
+	void *mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid after closing the file descriptor
+	::close(fd);
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+	_mapping     = reinterpret_cast<const byte *>(mapping);
+	_mappingSize = size;
+
+	return true;
+}
+
+void MappedReadStream::unmap() {
+	if (_mapping)
+		munmap(const_cast<byte *>(_mapping), _mappingSize);
+
+	_mapping     = 0;
+	_mappingSize = 0;
+}
+
+#elif defined(WIN32)
+
+bool MappedReadStream::map(const UString &fileName) {
+	HANDLE file = CreateFileW(boost::filesystem::path(fileName.c_str()).c_str(), GENERIC_READ,
+	                          FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart <= 0) ||
+	    ((uint64)fileSize.QuadPart > (uint64)std::numeric_limits<size_t>::max())) {
+
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingW(file, 0, PAGE_READONLY, 0, 0, 0);
+
+	// The mapping object keeps the file open on its own
+	CloseHandle(file);
+
+	if (!mappingHandle)
+		return false;
+
+	void *mapping = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!mapping) {
+		CloseHandle(mappingHandle);
+		return false;
+	}
+
+	_mapping       = reinterpret_cast<const byte *>(mapping);
+	_mappingSize   = (size_t)fileSize.QuadPart;
+	_mappingHandle = mappingHandle;
+
+	return true;
+}
+
+void MappedReadStream::unmap() {
+	if (_mapping)
+		UnmapViewOfFile(_mapping);
+	if (_mappingHandle)
+		CloseHandle(static_cast<HANDLE>(_mappingHandle));
+
+	_mapping       = 0;
+	_mappingSize   = 0;
+	_mappingHandle = 0;
+}
+
+#else
+
+bool MappedReadStream::map(const UString &UNUSED(fileName)) {
+	return false;
+}
+
+void MappedReadStream::unmap() {
+}
+
+#endif
+
+bool MappedReadStream::isMapped() const {
+	return _mapping != 0;
+}
+
+size_t MappedReadStream::read(void *dataPtr, size_t dataSize) {
+	return _stream->read(dataPtr, dataSize);
+}
+
+size_t MappedReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	return _stream->readAt(offset, dataPtr, dataSize);
+}
+
+bool MappedReadStream::eos() const {
+	return _stream->eos();
+}
+
+size_t MappedReadStream::pos() const {
+	return _stream->pos();
+}
+
+size_t MappedReadStream::size() const {
+	return _stream->size();
+}
+
+size_t MappedReadStream::seek(ptrdiff_t offset, Origin whence) {
+	return _stream->seek(offset, whence);
+}
+
+const byte *MappedReadStream::getData() const {
+	return _stream->getData();
+}
+
+} // End of namespace Common
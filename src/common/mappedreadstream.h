@@ -0,0 +1,82 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A read stream over a memory-mapped file.
+ */
+
+#ifndef COMMON_MAPPEDREADSTREAM_H
+#define COMMON_MAPPEDREADSTREAM_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/readstream.h"
+#include "src/common/scopedptr.h"
+
+namespace Common {
+
+class UString;
+class MemoryReadStream;
+
+/** A read stream over a whole file, mapped into memory.
+ *
+ *  Unlike ReadFile, the contents of a MappedReadStream are directly
+ *  accessible through getData(), so archives can hand out MemoryReadStream
+ *  views of uncompressed resources without copying them.
+ *
+ *  On systems where mapping a file is not possible (or for files that can't
+ *  be mapped, like pipes), the file is read into memory instead.
+ */
+class MappedReadStream : boost::noncopyable, public SeekableReadStream {
+public:
+	/** Map the file with the given fileName. Throws an exception on failure. */
+	MappedReadStream(const UString &fileName);
+	~MappedReadStream();
+
+	/** Was the file actually mapped, or was it read into memory instead? */
+	bool isMapped() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	bool eos() const;
+
+	size_t pos() const;
+	size_t size() const;
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
+
+	const byte *getData() const;
+
+private:
+	ScopedPtr<MemoryReadStream> _stream; ///< The stream over the mapped memory.
+
+	const byte *_mapping;       ///< The start of the mapped memory, if mapped.
+	size_t      _mappingSize;   ///< The size of the mapped memory.
+	void       *_mappingHandle; ///< OS-specific handle of the mapping, if necessary.
+
+	bool map(const UString &fileName);
+	void unmap();
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDREADSTREAM_H
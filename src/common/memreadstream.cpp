@@ -72,6 +72,18 @@ size_t MemoryReadStream::read(void *dataPtr, size_t dataSize) {
 	return dataSize;
 }
 
+size_t MemoryReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	assert(dataPtr);
+
+	if (offset > _size)
+		throw Exception(kSeekError);
+
+	dataSize = MIN(dataSize, _size - offset);
+	std::memcpy(dataPtr, _ptrOrig.get() + offset, dataSize);
+
+	return dataSize;
+}
+
 size_t MemoryReadStream::seek(ptrdiff_t offset, Origin whence) {
 	assert((size_t)_pos <= _size);
 
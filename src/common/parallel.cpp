@@ -0,0 +1,91 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Running independent jobs on several threads.
+ */
+
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+#include "src/common/parallel.h"
+#include "src/common/util.h"
+
+namespace Common {
+
+size_t getHardwareThreadCount() {
+	return MAX<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void runParallel(size_t threadCount, size_t jobCount, const ParallelJob &job) {
+	if (threadCount == 0)
+		threadCount = getHardwareThreadCount();
+
+	threadCount = MIN(threadCount, jobCount);
+
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < jobCount; i++)
+			job(0, i);
+
+		return;
+	}
+
+	std::mutex mutex;
+
+	size_t nextJob = 0;
+	std::exception_ptr error;
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadCount);
+
+	for (size_t w = 0; w < threadCount; w++) {
+		workers.push_back(std::thread([&, w]() {
+			while (true) {
+				size_t current;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (error || (nextJob >= jobCount))
+						return;
+
+					current = nextJob++;
+				}
+
+				try {
+					job(w, current);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!error)
+						error = std::current_exception();
+				}
+			}
+		}));
+	}
+
+	for (std::vector<std::thread>::iterator w = workers.begin(); w != workers.end(); ++w)
+		w->join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+} // End of namespace Common
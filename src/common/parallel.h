@@ -0,0 +1,63 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Running independent jobs on several threads.
+ */
+
+#ifndef COMMON_PARALLEL_H
+#define COMMON_PARALLEL_H
+
+#include <functional>
+
+#include "src/common/types.h"
+
+namespace Common {
+
+/** A job for runParallel().
+ *
+ *  Called with the index of the worker thread running it, in the
+ *  range [0, threadCount), and the index of the job itself, in the
+ *  range [0, jobCount).
+ */
+typedef std::function<void (size_t worker, size_t job)> ParallelJob;
+
+/** Return the number of threads the system can run concurrently, or 1 if unknown. */
+size_t getHardwareThreadCount();
+
+/** Run jobCount jobs, spread over threadCount worker threads.
+ *
+ *  Jobs are handed out to the workers in ascending order. Each worker
+ *  only ever runs one job at a time, so the worker index can be used to
+ *  address per-thread state.
+ *
+ *  If threadCount is 0, getHardwareThreadCount() threads are used. If
+ *  only one thread is requested, all jobs are run directly in the
+ *  calling thread.
+ *
+ *  This function blocks until all jobs have finished. If a job throws,
+ *  no new jobs are started and the first exception is rethrown in the
+ *  calling thread once all workers have stopped.
+ */
+void runParallel(size_t threadCount, size_t jobCount, const ParallelJob &job);
+
+} // End of namespace Common
+
+#endif // COMMON_PARALLEL_H
@@ -32,6 +32,7 @@
 #endif
 
 #if defined(UNIX)
+	#include <sys/types.h>
 	#include <pwd.h>
 	#include <unistd.h>
 #endif
@@ -118,6 +119,38 @@ std::FILE *Platform::openFile(const UString &fileName, FileMode mode) {
 }
 // '--- openFile() ---'
 
+// .--- 64-bit file offsets ---.
+bool Platform::seekFile(std::FILE *file, int64 offset, int whence) {
+	assert(file);
+
+#if defined(WIN32)
+	return _fseeki64(file, offset, whence) == 0;
+#elif defined(UNIX)
+	if ((int64)((off_t)offset) != offset)
+		return false;
+
+	return fseeko(file, (off_t)offset, whence) == 0;
+#else
+	if ((int64)((long)offset) != offset)
+		return false;
+
+	return std::fseek(file, (long)offset, whence) == 0;
+#endif
+}
+
+int64 Platform::tellFile(std::FILE *file) {
+	assert(file);
+
+#if defined(WIN32)
+	return _ftelli64(file);
+#elif defined(UNIX)
+	return (int64)ftello(file);
+#else
+	return (int64)std::ftell(file);
+#endif
+}
+// '--- 64-bit file offsets ---'
+
 // .--- Windows utility functions ---.
 #if defined(WIN32)
 
@@ -29,6 +29,7 @@
 
 #include <vector>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 namespace Common {
@@ -51,6 +52,17 @@ public:
 	/** Open a file with an UTF-8 encoded name. */
 	static std::FILE *openFile(const UString &fileName, FileMode mode);
 
+	/** Seek within a file, with 64-bit offsets even on systems where long is 32-bit.
+	 *
+	 *  @param  file   the file to seek in.
+	 *  @param  offset the offset to seek to, relative to whence.
+	 *  @param  whence SEEK_SET, SEEK_CUR or SEEK_END.
+	 *  @return true if seeking was successful.
+	 */
+	static bool seekFile(std::FILE *file, int64 offset, int whence);
+	/** Return the current position within a file as a 64-bit value, or -1 on error. */
+	static int64 tellFile(std::FILE *file);
+
 	/** Return the OS-specific path of the user's home directory. */
 	static UString getHomeDirectory();
 	/** Return the OS-specific path of the config directory. */
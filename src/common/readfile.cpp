@@ -22,7 +22,17 @@
  *  Implementing the stream reading interfaces for files.
  */
 
+#include "src/common/system.h"
+
+#if defined(UNIX)
+	#include <sys/types.h>
+	#include <unistd.h>
+#endif
+
 #include <cassert>
+#include <cerrno>
+
+#include <limits>
 
 #include "src/common/readfile.h"
 #include "src/common/error.h"
@@ -43,16 +53,16 @@ ReadFile::~ReadFile() {
 	close();
 }
 
-static long getInitialSize(std::FILE *handle) {
+static int64 getInitialSize(std::FILE *handle) {
 	if (!handle)
 		return -1;
 
-	if (std::fseek(handle, 0, SEEK_END) != 0)
+	if (!Platform::seekFile(handle, 0, SEEK_END))
 		return -1;
 
-	long fileSize = std::ftell(handle);
+	int64 fileSize = Platform::tellFile(handle);
 
-	if (std::fseek(handle, 0, SEEK_SET) != 0)
+	if (!Platform::seekFile(handle, 0, SEEK_SET))
 		return -1;
 
 	return fileSize;
@@ -61,7 +71,7 @@ static long getInitialSize(std::FILE *handle) {
 bool ReadFile::open(const UString &fileName) {
 	close();
 
-	long fileSize = -1;
+	int64 fileSize = -1;
 	if (!(_handle  = Platform::openFile(fileName, Platform::kFileModeRead)) ||
 	    ((fileSize = getInitialSize(_handle)) < 0)) {
 
@@ -69,7 +79,8 @@ bool ReadFile::open(const UString &fileName) {
 		return false;
 	}
 
-	if ((uint64)((unsigned long)fileSize) > (uint64)0x7FFFFFFFULL) {
+	// We need to be able to address every byte with a signed seek offset
+	if ((uint64)fileSize > (uint64)std::numeric_limits<ptrdiff_t>::max()) {
 		warning("ReadFile \"%s\" is too big", fileName.c_str());
 
 		close();
@@ -104,7 +115,11 @@ size_t ReadFile::pos() const {
 	if (!_handle)
 		return kPositionInvalid;
 
-	return (size_t)std::ftell(_handle);
+	const int64 p = Platform::tellFile(_handle);
+	if (p < 0)
+		return kPositionInvalid;
+
+	return (size_t)p;
 }
 
 size_t ReadFile::size() const {
@@ -121,11 +136,11 @@ size_t ReadFile::seek(ptrdiff_t offset, Origin whence) {
 
 	size_t oldPos = pos();
 
-	if (std::fseek(_handle, offset, kSeekToWhence[whence]) != 0)
+	if (!Platform::seekFile(_handle, offset, kSeekToWhence[whence]))
 		throw Exception(kSeekError);
 
-	long p = std::ftell(_handle);
-	if ((p < 0) || ((size_t)p > _size))
+	const int64 p = Platform::tellFile(_handle);
+	if ((p < 0) || ((uint64)p > (uint64)_size))
 		throw Exception(kSeekError);
 
 	return oldPos;
@@ -139,6 +154,40 @@ size_t ReadFile::read(void *dataPtr, size_t dataSize) {
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+size_t ReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (!_handle)
+		return 0;
+
+	if (offset > _size)
+		throw Exception(kSeekError);
+
+	assert(dataPtr);
+
+#if defined(UNIX)
+	const int fd = fileno(_handle);
+
+	byte *data = reinterpret_cast<byte *>(dataPtr);
+
+	size_t readSize = 0;
+	while (readSize < dataSize) {
+		const ssize_t result = pread(fd, data + readSize, dataSize - readSize, (off_t)(offset + readSize));
+		if ((result < 0) && (errno == EINTR))
+			continue;
+
+		if (result <= 0)
+			break;
+
+		readSize += (size_t)result;
+	}
+
+	return readSize;
+#else
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return SeekableReadStream::readAt(offset, dataPtr, dataSize);
+#endif
+}
+
 MemoryReadStream *ReadFile::readIntoMemory(const UString &fileName) {
 	ReadFile file(fileName);
 
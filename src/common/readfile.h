@@ -27,6 +27,8 @@
 
 #include <cstdio>
 
+#include <mutex>
+
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
@@ -68,6 +70,15 @@ public:
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 	size_t read(void *dataPtr, size_t dataSize);
 
+	/** Read data from the given position in the file, without changing the
+	 *  file's position indicator.
+	 *
+	 *  On POSIX systems, this uses pread(), and several threads can read
+	 *  from the same file concurrently. Elsewhere, concurrent readAt() calls
+	 *  are serialized, and must not be mixed with concurrent read() calls.
+	 */
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
 	/** Read the whole file into memory and return a stream of its contents. */
 	static MemoryReadStream *readIntoMemory(const UString &fileName);
 
@@ -75,6 +86,8 @@ public:
 protected:
 	std::FILE *_handle; ///< The actual file handle.
 	size_t _size;       ///< The file's size.
+
+	std::mutex _mutex; ///< Serializing readAt() where pread() is not available.
 };
 
 } // End of namespace Common
@@ -52,13 +52,14 @@
 #include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
 #include "src/common/error.h"
+#include "src/common/util.h"
 #include "src/common/scopedptr.h"
 
 namespace Common {
 
 const uint32 ReadStream::kEOF;
 
-ReadStream::ReadStream() {
+ReadStream::ReadStream() : _readBufferPos(0), _readBufferEnd(0) {
 }
 
 ReadStream::~ReadStream() {
@@ -80,6 +81,54 @@ SeekableReadStream::SeekableReadStream() {
 SeekableReadStream::~SeekableReadStream() {
 }
 
+size_t SeekableReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		throw Exception(kSeekError);
+
+	const size_t oldPos = seek(offset);
+	const size_t result = read(dataPtr, dataSize);
+	seek(oldPos);
+
+	return result;
+}
+
+MemoryReadStream *SeekableReadStream::readStreamAt(size_t offset, size_t dataSize) {
+	ScopedArray<byte> buf(new byte[dataSize]);
+
+	if (readAt(offset, buf.get(), dataSize) != dataSize)
+		throw Exception(kReadError);
+
+	return new MemoryReadStream(buf.release(), dataSize, true);
+}
+
+const byte *SeekableReadStream::getData() const {
+	return 0;
+}
+
+SeekableReadStream *SeekableReadStream::getSubStream(size_t begin, size_t end) {
+	const byte *data = getData();
+	if (data) {
+		if ((begin > end) || (end > size()))
+			throw Exception(kSeekError);
+
+		return new MemoryReadStream(data + begin, end - begin);
+	}
+
+	return new SeekableSubReadStream(this, begin, end);
+}
+
+SeekableReadStream *SeekableReadStream::getPositionalSubStream(size_t begin, size_t end) {
+	const byte *data = getData();
+	if (data) {
+		if ((begin > end) || (end > size()))
+			throw Exception(kSeekError);
+
+		return new MemoryReadStream(data + begin, end - begin);
+	}
+
+	return new PositionalSubReadStream(this, begin, end);
+}
+
 size_t SeekableReadStream::evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size) {
 	switch (whence) {
 		case kOriginEnd:
@@ -134,9 +183,51 @@ SeekableSubReadStream::SeekableSubReadStream(SeekableReadStream *parentStream, s
 	_parentStream->seek(_pos);
 }
 
+SeekableSubReadStream::SeekableSubReadStream(SeekableReadStream *parentStream, size_t begin,
+                                             size_t end, bool disposeParentStream, bool seekParentStream) :
+	SubReadStream(parentStream, end, disposeParentStream), _parentStream(parentStream), _begin(begin) {
+
+	assert(_begin <= _end);
+
+	_pos = begin;
+	if (seekParentStream)
+		_parentStream->seek(_pos);
+}
+
 SeekableSubReadStream::~SeekableSubReadStream() {
 }
 
+bool SeekableSubReadStream::eos() const {
+	return _eos;
+}
+
+size_t SeekableSubReadStream::read(void *dataPtr, size_t dataSize) {
+	assert(_pos >= _begin);
+	assert(_pos <= _end);
+
+	if (dataSize > (size_t)(_end - _pos)) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	const size_t readSize = _parentStream->read(dataPtr, dataSize);
+	if (readSize != dataSize)
+		_eos = true;
+
+	_pos += readSize;
+
+	return readSize;
+}
+
+size_t SeekableSubReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset > size())
+		throw Exception(kSeekError);
+
+	dataSize = MIN<size_t>(dataSize, size() - offset);
+
+	return _parentStream->readAt(_begin + offset, dataPtr, dataSize);
+}
+
 size_t SeekableSubReadStream::pos() const {
 	return _pos - _begin;
 }
@@ -162,6 +253,58 @@ size_t SeekableSubReadStream::seek(ptrdiff_t offset, Origin whence) {
 	return oldPos;
 }
 
+const byte *SeekableSubReadStream::getData() const {
+	const byte *data = _parentStream->getData();
+	if (!data)
+		return 0;
+
+	return data + _begin;
+}
+
+
+PositionalSubReadStream::PositionalSubReadStream(SeekableReadStream *parentStream, size_t begin,
+                                                 size_t end, bool disposeParentStream) :
+	SeekableSubReadStream(parentStream, begin, end, disposeParentStream, false) {
+
+}
+
+PositionalSubReadStream::~PositionalSubReadStream() {
+}
+
+size_t PositionalSubReadStream::read(void *dataPtr, size_t dataSize) {
+	assert(_pos >= _begin);
+	assert(_pos <= _end);
+
+	if (dataSize > (size_t)(_end - _pos)) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	const size_t readSize = _parentStream->readAt(_pos, dataPtr, dataSize);
+	if (readSize != dataSize)
+		_eos = true;
+
+	_pos += readSize;
+
+	return readSize;
+}
+
+size_t PositionalSubReadStream::seek(ptrdiff_t offset, Origin whence) {
+	assert(_pos >= _begin);
+	assert(_pos <= _end);
+
+	const size_t oldPos = _pos;
+	const size_t newPos = evalSeek(offset, whence, _pos, _begin, size());
+	if ((newPos < _begin) || (newPos > _end))
+		throw Exception(kSeekError);
+
+	_pos = newPos;
+
+	_eos = false; // reset eos on successful seek
+
+	return oldPos;
+}
+
 
 SeekableSubReadStreamEndian::SeekableSubReadStreamEndian(SeekableReadStream *parentStream,
 		size_t begin, size_t end, bool bigEndian, bool disposeParentStream) :
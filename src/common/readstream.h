@@ -50,6 +50,8 @@
 #ifndef COMMON_READSTREAM_H
 #define COMMON_READSTREAM_H
 
+#include <cstring>
+
 #include "src/common/types.h"
 #include "src/common/endianness.h"
 #include "src/common/disposableptr.h"
@@ -88,11 +90,30 @@ public:
 
 	// --- The following methods should generally not be overloaded ---
 
+	/** Read exactly dataSize bytes from the stream.
+	 *
+	 *  If the stream provides a read buffer (see _readBufferPos), and that
+	 *  buffer holds enough data, the data is directly copied out of it.
+	 *  Otherwise, this falls back to the virtual read().
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	FORCEINLINE void readFixed(void *dataPtr, size_t dataSize) {
+		if ((size_t)(_readBufferEnd - _readBufferPos) >= dataSize) {
+			std::memcpy(dataPtr, _readBufferPos, dataSize);
+			_readBufferPos += dataSize;
+
+			return;
+		}
+
+		if (read(dataPtr, dataSize) != dataSize)
+			throw Exception(kReadError);
+	}
+
 	/** Read an unsigned byte from the stream and return it. */
 	byte readByte() {
 		byte b;
-		if (read(&b, 1) != 1)
-			throw Exception(kReadError);
+		readFixed(&b, 1);
 
 		return b;
 	}
@@ -121,8 +142,7 @@ public:
 	 */
 	uint16 readUint16LE() {
 		uint16 val;
-		if (read(&val, 2) != 2)
-			throw Exception(kReadError);
+		readFixed(&val, 2);
 
 		return FROM_LE_16(val);
 	}
@@ -132,8 +152,7 @@ public:
 	 */
 	uint32 readUint32LE() {
 		uint32 val;
-		if (read(&val, 4) != 4)
-			throw Exception(kReadError);
+		readFixed(&val, 4);
 
 		return FROM_LE_32(val);
 	}
@@ -143,8 +162,7 @@ public:
 	 */
 	uint64 readUint64LE() {
 		uint64 val;
-		if (read(&val, 8) != 8)
-			throw Exception(kReadError);
+		readFixed(&val, 8);
 
 		return FROM_LE_64(val);
 	}
@@ -154,8 +172,7 @@ public:
 	 */
 	uint16 readUint16BE() {
 		uint16 val;
-		if (read(&val, 2) != 2)
-			throw Exception(kReadError);
+		readFixed(&val, 2);
 
 		return FROM_BE_16(val);
 	}
@@ -165,8 +182,7 @@ public:
 	 */
 	uint32 readUint32BE() {
 		uint32 val;
-		if (read(&val, 4) != 4)
-			throw Exception(kReadError);
+		readFixed(&val, 4);
 
 		return FROM_BE_32(val);
 	}
@@ -176,8 +192,7 @@ public:
 	 */
 	uint64 readUint64BE() {
 		uint64 val;
-		if (read(&val, 8) != 8)
-			throw Exception(kReadError);
+		readFixed(&val, 8);
 
 		return FROM_BE_64(val);
 	}
@@ -258,6 +273,20 @@ public:
 	 *  When reading fails, a kReadError exception is thrown.
 	 */
 	MemoryReadStream *readStream(size_t dataSize);
+
+protected:
+	/** The current position within the stream's read buffer.
+	 *
+	 *  Streams that keep their data in a buffer can point _readBufferPos and
+	 *  _readBufferEnd at the part of the buffer that has not been read yet.
+	 *  The fixed-size read methods (readUint32LE(), etc.) will then consume
+	 *  data directly from there, without calling the virtual read().
+	 *
+	 *  By default, both are 0, meaning there is no read buffer.
+	 */
+	const byte *_readBufferPos;
+	/** The end of the unread data in the stream's read buffer. */
+	const byte *_readBufferEnd;
 };
 
 
@@ -318,6 +347,55 @@ public:
 		return seek(offset, kOriginCurrent);
 	}
 
+	/** Read data from the given position in the stream, without changing
+	 *  the stream's own position indicator.
+	 *
+	 *  Streams that implement this natively (memory streams, files, and sub
+	 *  streams of those) allow concurrent readAt() calls from several threads.
+	 *  The default implementation seeks, reads and seeks back, and therefore
+	 *  doesn't.
+	 *
+	 *  When trying to read from outside the stream, a kSeekError exception
+	 *  is thrown.
+	 *
+	 *  @param  offset   the position in the stream to read from.
+	 *  @param  dataPtr  pointer to a buffer into which the data is read.
+	 *  @param  dataSize number of bytes to be read.
+	 *  @return the number of bytes which were actually read.
+	 */
+	virtual size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Read the specified amount of data from the given position into a
+	 *  new[]'ed buffer which then is wrapped into a MemoryReadStream.
+	 *
+	 *  Like readAt(), this does not change the stream's position indicator.
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	MemoryReadStream *readStreamAt(size_t offset, size_t dataSize);
+
+	/** Return a pointer to the complete data of the stream, if it is directly
+	 *  available in memory. Otherwise, return 0.
+	 */
+	virtual const byte *getData() const;
+
+	/** Create a new stream over the range [begin, end) of this stream.
+	 *
+	 *  If the data of this stream is directly available in memory, the new
+	 *  stream is a MemoryReadStream view into that memory, without copying
+	 *  any data. Otherwise, it is a SeekableSubReadStream.
+	 *
+	 *  Either way, the new stream is only valid as long as this stream exists.
+	 */
+	SeekableReadStream *getSubStream(size_t begin, size_t end);
+
+	/** Create a new stream over the range [begin, end) of this stream, that
+	 *  can be read independently of this stream and of other substreams.
+	 *
+	 *  Like getSubStream(), but a PositionalSubReadStream is created when the
+	 *  data is not directly available in memory.
+	 */
+	SeekableReadStream *getPositionalSubStream(size_t begin, size_t end);
+
 	/** Evaluate the seek offset relative to whence into a position from the beginning. */
 	static size_t evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size);
 };
@@ -351,10 +429,12 @@ protected:
 
 /** SeekableSubReadStream provides access to a SeekableReadStream restricted to
  *  the range [begin, end).
+ *
  *  The same caveats apply to SeekableSubReadStream as do to SeekableReadStream.
  *
  *  Manipulating the parent stream directly /will/ mess up a substream.
  *  @see SubReadStream
+ *  @see PositionalSubReadStream
  */
 class SeekableSubReadStream : public SubReadStream, public SeekableReadStream {
 public:
@@ -365,20 +445,52 @@ public:
 	size_t pos() const;
 	size_t size() const;
 
+	bool eos() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	const byte *getData() const;
+
 protected:
 	SeekableReadStream *_parentStream;
 
 	size_t _begin;
+
+	/** Create a substream, optionally without moving the parent stream to its beginning. */
+	SeekableSubReadStream(SeekableReadStream *parentStream, size_t begin, size_t end,
+	                      bool disposeParentStream, bool seekParentStream);
+};
+
+
+/** A SeekableSubReadStream that reads through the parent stream's readAt().
+ *
+ *  The position of the parent stream is never changed. Several substreams of
+ *  the same parent stream, even used from different threads, don't step on
+ *  each others toes, as long as the parent stream implements readAt() natively.
+ *
+ *  For a ReadFile, every read is a separate, unbuffered system call, though.
+ *  Parsers reading lots of small values are better served by a plain
+ *  SeekableSubReadStream.
+ */
+class PositionalSubReadStream : public SeekableSubReadStream {
+public:
+	PositionalSubReadStream(SeekableReadStream *parentStream, size_t begin, size_t end,
+	                        bool disposeParentStream = false);
+	~PositionalSubReadStream();
+
+	size_t read(void *dataPtr, size_t dataSize);
+
+	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 };
 
 
 /** This is a wrapper around SeekableSubReadStream, but it adds non-endian
  *  read methods whose endianness is set on the stream creation.
  *
- *  Manipulating the parent stream directly /will/ mess up a substream.
- *  @see SubReadStream
+ *  @see SeekableSubReadStream
  */
 class SeekableSubReadStreamEndian : public SeekableSubReadStream {
 private:
@@ -106,7 +106,7 @@ size_t WriteFile::size() const {
 }
 
 size_t WriteFile::pos() const {
-	return std::ftell(_handle);
+	return (size_t)Platform::tellFile(_handle);
 }
 
 size_t WriteFile::seek(ptrdiff_t offset, SeekableWriteStream::Origin whence) {
@@ -116,7 +116,7 @@ size_t WriteFile::seek(ptrdiff_t offset, SeekableWriteStream::Origin whence) {
 	if (newPos > _size)
 		throw Exception(kSeekError);
 
-	if (std::fseek(_handle, newPos, SEEK_SET))
+	if (!Platform::seekFile(_handle, newPos, SEEK_SET))
 		throw Exception(kSeekError);
 
 	return oldPos;
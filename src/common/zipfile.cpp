@@ -130,28 +130,33 @@ const ZipFile::IFile &ZipFile::getIFile(uint32 index) const {
 }
 
 void ZipFile::getFileProperties(SeekableReadStream &zip, const IFile &file,
-		uint16 &compMethod, uint32 &compSize, uint32 &realSize) const {
+		uint16 &compMethod, uint32 &compSize, uint32 &realSize, size_t &dataOffset) const {
 
-	zip.seek(file.offset);
+	// Read the local file header with readAt(), to leave the ZIP stream's position alone
 
-	uint32 tag = zip.readUint32LE();
+	byte header[30];
+	if (zip.readAt(file.offset, header, sizeof(header)) != sizeof(header))
+		throw Exception(kReadError);
+
+	MemoryReadStream headerStream(header);
+
+	uint32 tag = headerStream.readUint32LE();
 	if (tag != 0x04034B50)
 		throw Exception("Unknown ZIP record %08X", tag);
 
-	zip.skip(4);
+	headerStream.skip(4);
 
-	compMethod = zip.readUint16LE();
+	compMethod = headerStream.readUint16LE();
 
-	zip.skip(8);
+	headerStream.skip(8);
 
-	compSize = zip.readUint32LE();
-	realSize = zip.readUint32LE();
+	compSize = headerStream.readUint32LE();
+	realSize = headerStream.readUint32LE();
 
-	uint16 nameLength  = zip.readUint16LE();
-	uint16 extraLength = zip.readUint16LE();
+	uint16 nameLength  = headerStream.readUint16LE();
+	uint16 extraLength = headerStream.readUint16LE();
 
-	zip.skip(nameLength);
-	zip.skip(extraLength);
+	dataOffset = file.offset + sizeof(header) + nameLength + extraLength;
 }
 
 size_t ZipFile::getFileSize(uint32 index) const {
@@ -165,12 +170,16 @@ SeekableReadStream *ZipFile::getFile(uint32 index, bool tryNoCopy) const {
 	uint32 compSize;
 	uint32 realSize;
 
-	getFileProperties(*_zip, file, compMethod, compSize, realSize);
+	size_t dataOffset;
+
+	getFileProperties(*_zip, file, compMethod, compSize, realSize, dataOffset);
 
 	if (tryNoCopy && (compMethod == 0))
-		return new SeekableSubReadStream(_zip.get(), _zip->pos(), _zip->pos() + compSize);
+		return _zip->getPositionalSubStream(dataOffset, dataOffset + compSize);
+
+	ScopedPtr<SeekableReadStream> compStream(_zip->getPositionalSubStream(dataOffset, dataOffset + compSize));
 
-	return decompressFile(*_zip, compMethod, compSize, realSize);
+	return decompressFile(*compStream, compMethod, compSize, realSize);
 }
 
 SeekableReadStream *ZipFile::decompressFile(SeekableReadStream &zip, uint32 method,
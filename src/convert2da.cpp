@@ -33,6 +33,7 @@
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/readfile.h"
+#include "src/common/bufferedreadstream.h"
 #include "src/common/writefile.h"
 #include "src/common/stdoutstream.h"
 #include "src/common/encoding.h"
@@ -158,7 +159,7 @@ Aurora::TwoDAFile *get2DAGDA(Common::SeekableReadStream *stream) {
 }
 
 void convert2DA(const Common::UString &file, const Common::UString &outFile, Format format) {
-	Common::ScopedPtr<Aurora::TwoDAFile> twoDA(get2DAGDA(new Common::ReadFile(file)));
+	Common::ScopedPtr<Aurora::TwoDAFile> twoDA(get2DAGDA(new Common::BufferedReadStream(new Common::ReadFile(file), true)));
 
 	write2DA(*twoDA, outFile, format);
 }
@@ -169,10 +170,10 @@ void convert2DA(const std::vector<Common::UString> &files, const Common::UString
 		return;
 	}
 
-	Aurora::GDAFile gda(new Common::ReadFile(files[0]));
+	Aurora::GDAFile gda(new Common::BufferedReadStream(new Common::ReadFile(files[0]), true));
 
 	for (size_t i = 1; i < files.size(); i++)
-		gda.add(new Common::ReadFile(files[i]));
+		gda.add(new Common::BufferedReadStream(new Common::ReadFile(files[i]), true));
 
 	Aurora::TwoDAFile twoDA(gda);
 
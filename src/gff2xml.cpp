@@ -34,6 +34,7 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/bufferedreadstream.h"
 #include "src/common/writefile.h"
 #include "src/common/stdoutstream.h"
 #include "src/common/encoding.h"
@@ -185,7 +186,7 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 void dumpGFF(const Common::UString &inFile, const Common::UString &outFile, Common::Encoding encoding, bool nwnPremium,
              bool sacFile) {
 
-	Common::ScopedPtr<Common::SeekableReadStream> gff(new Common::ReadFile(inFile));
+	Common::ScopedPtr<Common::SeekableReadStream> gff(new Common::BufferedReadStream(new Common::ReadFile(inFile), true));
 
 	Common::ScopedPtr<XML::GFFDumper> dumper(XML::GFFDumper::identify(*gff, nwnPremium, sacFile));
 
@@ -25,6 +25,7 @@
 #include <cstdio>
 #include <cstring>
 
+#include "src/common/scopedptr.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
@@ -33,6 +34,7 @@
 #include "src/aurora/smallfile.h"
 
 #include "src/images/cbgt.h"
+#include "src/images/nitro.h"
 
 namespace Images {
 
@@ -84,6 +86,8 @@ void CBGT::readPalettes(ReadContext &ctx) {
 			ctx.palettes.push_back(new byte[768]);
 			byte *palette = ctx.palettes.back();
 
+			std::memset(palette, 0, 768);
+
 			const uint32 colorCount = (paletteSize / 2) * 3;
 			for (uint32 i = 0; i < colorCount; i += 3) {
 				const uint16 color = ctx.pal->readUint16LE();
@@ -252,6 +256,13 @@ void CBGT::drawImage(ReadContext &ctx) {
 	const uint32 tilesX     = cellWidth  / tileWidth;
 	const uint32 tilesY     = cellHeight / tileHeight;
 
+	// Expand all palettes into ready-made pixels once
+	Common::ScopedArray<byte> palettes(new byte[ctx.palettes.size() * kNitroPaletteSize]);
+	for (size_t i = 0; i < ctx.palettes.size(); i++)
+		expandNitroPalette(palettes.get() + i * kNitroPaletteSize, ctx.palettes[i]);
+
+	byte tiles[cellWidth * cellHeight];
+
 	byte *data = _mipMaps.back()->data.get();
 	for (size_t i = 0; i < ctx.cells.size(); i++) {
 		Common::SeekableReadStream *cell = ctx.cells[i];
@@ -261,41 +272,16 @@ void CBGT::drawImage(ReadContext &ctx) {
 		const uint32 xC = i % cellsX;
 		const uint32 yC = i / cellsX;
 
-		const byte *palette = ctx.palettes[ctx.paletteIndices[i]];
-		const bool is0Transp = (palette[0] == 0xF8) && (palette[1] == 0x00) && (palette[2] == 0xF8);
+		const byte *palette = palettes.get() + ctx.paletteIndices[i] * kNitroPaletteSize;
 
 		// Pixel position of this cell within the big image
 		const uint32 imagePos = yC * cellHeight * ctx.width + xC * cellWidth;
 
-		// Go over all tiles
-		for (uint32 yT = 0; yT < tilesY; yT++) {
-			for (uint32 xT = 0; xT < tilesX; xT++) {
-
-				// Position of the tile within the cell
-				const uint32 tilePos = xT * tileWidth + yT * tileHeight * ctx.width;
-
-				// Go over all pixels in the tile
-				for (uint32 y = 0; y < tileHeight; y++) {
-					for (uint32 x = 0; x < tileWidth; x++) {
-
-						// Position of the pixel within the tile
-						const uint32 pos   = imagePos + tilePos + x + y * ctx.width;
-						const uint8  pixel = cell->readByte();
-
-						if (pos > (ctx.width * ctx.height))
-							continue;
-
-						data[pos * 4 + 0] = palette[pixel * 3 + 0];
-						data[pos * 4 + 1] = palette[pixel * 3 + 1];
-						data[pos * 4 + 2] = palette[pixel * 3 + 2];
-						data[pos * 4 + 3] = ((pixel == 0) && is0Transp) ? 0x00 : 0xFF;
-
-					}
-				}
-
-			}
-		}
+		cell->seek(0);
+		if (cell->read(tiles, sizeof(tiles)) != sizeof(tiles))
+			throw Common::Exception(Common::kReadError);
 
+		drawNitroTiles(data + imagePos * 4, ctx.width * 4, tiles, tilesX, tilesY, 8, palette);
 	}
 }
 
@@ -0,0 +1,123 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Converting textures of various formats into TGA.
+ */
+
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/readstream.h"
+#include "src/common/filepath.h"
+
+#include "src/images/convert.h"
+#include "src/images/decoder.h"
+#include "src/images/dds.h"
+#include "src/images/sbm.h"
+#include "src/images/tga.h"
+#include "src/images/tpc.h"
+#include "src/images/txb.h"
+
+namespace Images {
+
+bool isTextureType(Aurora::FileType type) {
+	switch (type) {
+		case Aurora::kFileTypeDDS:
+		case Aurora::kFileTypeSBM:
+		case Aurora::kFileTypeTPC:
+		case Aurora::kFileTypeTXB:
+		case Aurora::kFileTypeTGA:
+			return true;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+Aurora::FileType detectTextureType(Common::SeekableReadStream &stream) {
+	if (DDS::detect(stream))
+		return Aurora::kFileTypeDDS;
+
+	return Aurora::kFileTypeNone;
+}
+
+Decoder *openImage(Common::SeekableReadStream &stream, Aurora::FileType type, bool deswizzle, int mipMap,
+                   size_t threads) {
+	switch (type) {
+		case Aurora::kFileTypeDDS:
+			return new DDS(stream, mipMap, threads);
+		case Aurora::kFileTypeSBM:
+			return new SBM(stream, deswizzle);
+		case Aurora::kFileTypeTPC:
+			return new TPC(stream, mipMap, threads);
+		case Aurora::kFileTypeTXB:
+			return new TXB(stream, mipMap, threads);
+		case Aurora::kFileTypeTGA:
+			return new TGA(stream);
+
+		default:
+			throw Common::Exception("Invalid image type %d", (int) type);
+	}
+}
+
+Decoder *openImage(Common::SeekableReadStream *stream, Aurora::FileType type, bool deswizzle, int mipMap,
+                   size_t threads) {
+	Common::ScopedPtr<Common::SeekableReadStream> imageStream(stream);
+
+	switch (type) {
+		case Aurora::kFileTypeDDS:
+			return new DDS(imageStream.release(), mipMap, threads);
+		case Aurora::kFileTypeTPC:
+			return new TPC(imageStream.release(), mipMap, threads);
+		case Aurora::kFileTypeTXB:
+			return new TXB(imageStream.release(), mipMap, threads);
+
+		default:
+			break;
+	}
+
+	return openImage(*imageStream, type, deswizzle, mipMap, threads);
+}
+
+void convertToTGA(Common::SeekableReadStream &stream, Aurora::FileType type, const Common::UString &tgaFile,
+                  bool flip, bool deswizzle, bool rle, int mipMap, size_t threads) {
+
+	/* The image only exists while we still have the stream, so it can use
+	 * the stream's memory directly, if the data is available in memory.
+	 * Only one mip map ends up in the TGA, so don't bother loading the others. */
+	Common::ScopedPtr<Decoder> image(openImage(stream.getSubStream(0, stream.size()), type, deswizzle,
+	                                           mipMap, threads));
+	if (flip)
+		image->flipVertically();
+
+	image->dumpTGA(tgaFile, rle);
+}
+
+Common::UString getTGAName(Aurora::FileType type, const Common::UString &textureFile) {
+	if (!isTextureType(type) || (type == Aurora::kFileTypeTGA))
+		return "";
+
+	return Common::FilePath::changeExtension(textureFile, ".tga");
+}
+
+} // End of namespace Images
@@ -0,0 +1,91 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Converting textures of various formats into TGA.
+ */
+
+#ifndef IMAGES_CONVERT_H
+#define IMAGES_CONVERT_H
+
+#include "src/aurora/types.h"
+
+namespace Common {
+	class UString;
+	class SeekableReadStream;
+}
+
+namespace Images {
+
+class Decoder;
+
+/** Is this a texture type that can be opened by openImage()? */
+bool isTextureType(Aurora::FileType type);
+
+/** Detect the type of a texture by its contents.
+ *
+ *  Only formats with a distinct signature can be detected. For everything
+ *  else, kFileTypeNone is returned.
+ */
+Aurora::FileType detectTextureType(Common::SeekableReadStream &stream);
+
+/** Open a texture of this type, reading it from the stream.
+ *
+ *  For texture types with mip maps, only the level mipMap of each layer is
+ *  loaded, or all of them for -1. Compressed textures are decompressed with
+ *  this many threads, 0 meaning one per CPU core.
+ */
+Decoder *openImage(Common::SeekableReadStream &stream, Aurora::FileType type, bool deswizzle = false,
+                   int mipMap = -1, size_t threads = 1);
+
+/** Take over this stream and open a texture of this type out of it.
+ *
+ *  If the stream's data is directly available in memory, image formats
+ *  that support it will use that memory instead of copying it.
+ */
+Decoder *openImage(Common::SeekableReadStream *stream, Aurora::FileType type, bool deswizzle = false,
+                   int mipMap = -1, size_t threads = 1);
+
+/** Convert a texture of this type into a TGA file.
+ *
+ *  @param stream The stream to read the texture from.
+ *  @param type The type of the texture.
+ *  @param tgaFile The TGA file to write.
+ *  @param flip Flip the image vertically?
+ *  @param deswizzle Does the texture need deswizzling? Only used for SBM.
+ *  @param rle RLE-compress the TGA?
+ *  @param mipMap The mip map level to write into the TGA.
+ *  @param threads The number of threads to decompress the texture with. 0 means one per CPU core.
+ */
+void convertToTGA(Common::SeekableReadStream &stream, Aurora::FileType type, const Common::UString &tgaFile,
+                  bool flip = false, bool deswizzle = false, bool rle = false, int mipMap = 0,
+                  size_t threads = 1);
+
+/** Return the name of the TGA file a texture file would be converted into.
+ *
+ *  The TGA gets the name of the texture file, with the extension changed
+ *  to .tga. If this is not a texture type, or the texture already is a
+ *  TGA, an empty string is returned.
+ */
+Common::UString getTGAName(Aurora::FileType type, const Common::UString &textureFile);
+
+} // End of namespace Images
+
+#endif // IMAGES_CONVERT_H
@@ -22,6 +22,8 @@
  *  DDS texture (DirectDraw Surface or BioWare's own format) loading).
  */
 
+#include <cassert>
+
 #include "src/common/scopedptr.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
@@ -44,8 +46,16 @@ static const uint32 kPixelFlagsIsRGB     = 0x00000040;
 
 namespace Images {
 
-DDS::DDS(Common::SeekableReadStream &dds) {
-	load(dds);
+DDS::DDS(Common::SeekableReadStream &dds, int mipMap, size_t threads) {
+	load(dds, mipMap, threads);
+}
+
+DDS::DDS(Common::SeekableReadStream *dds, int mipMap, size_t threads) {
+	assert(dds);
+
+	_stream.reset(dds);
+
+	load(*dds, mipMap, threads);
 }
 
 DDS::~DDS() {
@@ -65,7 +75,7 @@ bool DDS::detect(Common::SeekableReadStream &dds) {
 	return fourCC == kDDSID;
 }
 
-void DDS::load(Common::SeekableReadStream &dds) {
+void DDS::load(Common::SeekableReadStream &dds, int mipMap, size_t threads) {
 	try {
 
 		DataType dataType;
@@ -73,13 +83,15 @@ void DDS::load(Common::SeekableReadStream &dds) {
 		readHeader(dds, dataType);
 		readData  (dds, dataType);
 
+		dropUnusedMipMaps(mipMap);
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading DDS file");
 		throw;
 	}
 
 	// In xoreos-tools, we always want decompressed images
-	decompress();
+	decompress(threads);
 }
 
 void DDS::readHeader(Common::SeekableReadStream &dds, DataType &dataType) {
@@ -224,9 +236,8 @@ void DDS::setSize(MipMap &mipMap) {
 
 void DDS::readData(Common::SeekableReadStream &dds, DataType dataType) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
-		(*mipMap)->data.reset(new byte[(*mipMap)->size]);
-
 		if (dataType == kDataType4444) {
+			(*mipMap)->data.reset(new byte[(*mipMap)->size]);
 
 			byte *data = (*mipMap)->data.get();
 			for (uint32 i = 0; i < (uint32)((*mipMap)->width * (*mipMap)->height); i++, data += 4) {
@@ -239,8 +250,7 @@ void DDS::readData(Common::SeekableReadStream &dds, DataType dataType) {
 			}
 
 		} else if (dataType == kDataTypeDirect)
-			if (dds.read((*mipMap)->data.get(), (*mipMap)->size) != (*mipMap)->size)
-				throw Common::Exception(Common::kReadError);
+			readMipMapData(dds, **mipMap);
 
 	}
 }
@@ -43,7 +43,19 @@ namespace Images {
  */
 class DDS : public Decoder {
 public:
-	DDS(Common::SeekableReadStream &dds);
+	/** Read a DDS out of this stream.
+	 *
+	 *  Only the mip map level mipMap of each layer is loaded, or all of
+	 *  them for -1. See Decoder::dropUnusedMipMaps(). The image is
+	 *  decompressed with this many threads, see Decoder::decompress().
+	 */
+	DDS(Common::SeekableReadStream &dds, int mipMap = -1, size_t threads = 1);
+	/** Take over this stream and read a DDS out of it.
+	 *
+	 *  If the stream's data is directly available in memory, mip maps that
+	 *  need no conversion use that memory instead of copying it.
+	 */
+	DDS(Common::SeekableReadStream *dds, int mipMap = -1, size_t threads = 1);
 	~DDS();
 
 	/** Return true if the data within this stream is a DDS image. */
@@ -68,7 +80,7 @@ private:
 	};
 
 	// Loading helpers
-	void load(Common::SeekableReadStream &dds);
+	void load(Common::SeekableReadStream &dds, int mipMap, size_t threads);
 	void readHeader(Common::SeekableReadStream &dds, DataType &dataType);
 	void readStandardHeader(Common::SeekableReadStream &dds, DataType &dataType);
 	void readBioWareHeader(Common::SeekableReadStream &dds, DataType &dataType);
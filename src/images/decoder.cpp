@@ -23,11 +23,15 @@
  */
 
 #include <cassert>
+#include <cstring>
+
+#include <vector>
 
 #include "src/common/scopedptr.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
-#include "src/common/memreadstream.h"
+#include "src/common/readstream.h"
+#include "src/common/parallel.h"
 
 #include "src/images/decoder.h"
 #include "src/images/util.h"
@@ -36,10 +40,10 @@
 
 namespace Images {
 
-Decoder::MipMap::MipMap() : width(0), height(0), size(0) {
+Decoder::MipMap::MipMap() : width(0), height(0), size(0), borrowedData(0) {
 }
 
-Decoder::MipMap::MipMap(const MipMap &mipMap) : width(0), height(0), size(0) {
+Decoder::MipMap::MipMap(const MipMap &mipMap) : width(0), height(0), size(0), borrowedData(0) {
 	*this = mipMap;
 }
 
@@ -54,9 +58,11 @@ Decoder::MipMap &Decoder::MipMap::operator=(const MipMap &mipMap) {
 	height = mipMap.height;
 	size   = mipMap.size;
 
+	// The copy always owns its data, so it doesn't depend on the source stream
 	data.reset(new byte[size]);
+	borrowedData = 0;
 
-	std::memcpy(data.get(), mipMap.data.get(), size);
+	std::memcpy(data.get(), mipMap.getData(), size);
 
 	return *this;
 }
@@ -67,6 +73,22 @@ void Decoder::MipMap::swap(MipMap &right) {
 	SWAP(size  , right.size  );
 
 	data.swap(right.data);
+	SWAP(borrowedData, right.borrowedData);
+}
+
+const byte *Decoder::MipMap::getData() const {
+	return data ? data.get() : borrowedData;
+}
+
+byte *Decoder::MipMap::getWritableData() {
+	if (!data && borrowedData) {
+		data.reset(new byte[size]);
+		std::memcpy(data.get(), borrowedData, size);
+
+		borrowedData = 0;
+	}
+
+	return data.get();
 }
 
 
@@ -136,7 +158,61 @@ const Decoder::MipMap &Decoder::getMipMap(size_t mipMap, size_t layer) const {
 	return *_mipMaps[index];
 }
 
-void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
+void Decoder::readMipMapData(Common::SeekableReadStream &stream, MipMap &mipMap) {
+	const byte *streamData = (&stream == _stream.get()) ? stream.getData() : 0;
+
+	if (streamData) {
+		if ((stream.size() - stream.pos()) < mipMap.size)
+			throw Common::Exception(Common::kReadError);
+
+		mipMap.data.reset();
+		mipMap.borrowedData = streamData + stream.pos();
+
+		stream.skip(mipMap.size);
+		return;
+	}
+
+	mipMap.data.reset(new byte[mipMap.size]);
+	mipMap.borrowedData = 0;
+
+	if (stream.read(mipMap.data.get(), mipMap.size) != mipMap.size)
+		throw Common::Exception(Common::kReadError);
+}
+
+/** The number of block rows within a mip map that are decompressed in one go.
+ *
+ *  Larger mip maps are split into bands of that many rows of 4x4 pixel blocks,
+ *  so that even a single big mip map can be spread over several threads.
+ */
+static const uint32 kDecompressionBandRows = 16;
+
+void Decoder::dropUnusedMipMaps(int mipMap) {
+	if (mipMap < 0)
+		return;
+
+	const size_t mipMapCount = getMipMapCount();
+	const size_t level       = mipMap;
+
+	if (level >= mipMapCount)
+		throw Common::Exception("Image has no mip map %u (only %u)", (uint) level, (uint) mipMapCount);
+
+	if (mipMapCount == 1)
+		return;
+
+	MipMaps mipMaps;
+	mipMaps.reserve(_layerCount);
+
+	for (size_t i = 0; i < _layerCount; i++) {
+		const size_t index = i * mipMapCount + level;
+
+		mipMaps.push_back(_mipMaps[index]);
+		_mipMaps[index] = 0;
+	}
+
+	_mipMaps.swap(mipMaps);
+}
+
+void Decoder::allocateDecompressed(MipMap &out, const MipMap &in, PixelFormat format) {
 	if ((format != kPixelFormatDXT1) &&
 	    (format != kPixelFormatDXT3) &&
 	    (format != kPixelFormatDXT5))
@@ -152,59 +228,120 @@ void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
 	out.size   = MAX(out.width * out.height * 4, 64);
 
 	out.data.reset(new byte[out.size]);
+}
+
+void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format,
+                         uint32 firstRow, uint32 rowCount) {
+
+	/* Block row n always ends up in the pixel rows [4n, 4n + 4) of the output,
+	 * so a band of rows is just a smaller image at an offset. */
+
+	const size_t blockSize = (format == kPixelFormatDXT1) ? 8 : 16;
+	const size_t rowSize   = ((in.width + 3) / 4) * blockSize;
+	const size_t offset    = firstRow * rowSize;
+
+	if (offset > in.size)
+		throw Common::Exception(Common::kReadError);
+
+	const byte  *src  = in.getData() + offset;
+	const size_t size = in.size - offset;
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(new Common::MemoryReadStream(in.data.get(), in.size));
+	const uint32 width  = out.width;
+	const uint32 height = MIN<uint32>(rowCount * 4, out.height - firstRow * 4);
+	const uint32 pitch  = out.width * 4;
+
+	byte *dest = out.data.get() + firstRow * 4 * pitch;
 
 	if      (format == kPixelFormatDXT1)
-		decompressDXT1(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT1(dest, src, size, width, height, pitch);
 	else if (format == kPixelFormatDXT3)
-		decompressDXT3(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT3(dest, src, size, width, height, pitch);
 	else if (format == kPixelFormatDXT5)
-		decompressDXT5(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT5(dest, src, size, width, height, pitch);
 }
 
-void Decoder::decompress() {
+void Decoder::decompress(MipMap &out, const MipMap &in, PixelFormat format) {
+	allocateDecompressed(out, in, format);
+
+	decompress(out, in, format, 0, (in.height + 3) / 4);
+}
+
+void Decoder::decompress(size_t threads) {
 	if (!isCompressed())
 		return;
 
-	for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m) {
-		MipMap decompressed;
+	/** A band of block rows within one of the mip maps. */
+	struct Band {
+		size_t mipMap;
+		uint32 firstRow;
+		uint32 rowCount;
+	};
+
+	MipMaps decompressed;
+	decompressed.reserve(_mipMaps.size());
+
+	std::vector<Band> bands;
 
-		decompress(decompressed, **m, _format);
+	for (size_t i = 0; i < _mipMaps.size(); i++) {
+		decompressed.push_back(new MipMap);
+		allocateDecompressed(*decompressed.back(), *_mipMaps[i], _format);
 
-		decompressed.swap(**m);
+		const uint32 rows = (_mipMaps[i]->height + 3) / 4;
+		for (uint32 row = 0; row < rows; row += kDecompressionBandRows) {
+			const Band band = { i, row, MIN(rows - row, kDecompressionBandRows) };
+			bands.push_back(band);
+		}
 	}
 
+	Common::runParallel(threads, bands.size(), [&](size_t UNUSED(worker), size_t job) {
+		const Band &band = bands[job];
+
+		decompress(*decompressed[band.mipMap], *_mipMaps[band.mipMap], _format, band.firstRow, band.rowCount);
+	});
+
+	for (size_t i = 0; i < _mipMaps.size(); i++)
+		decompressed[i]->swap(*_mipMaps[i]);
+
 	_format = kPixelFormatR8G8B8A8;
 }
 
-void Decoder::dumpTGA(const Common::UString &fileName) const {
+void Decoder::dumpTGA(const Common::UString &fileName, bool rle) const {
 	if (_mipMaps.size() < 1)
 		throw Common::Exception("Image contains no mip maps");
 
 	if (!isCompressed()) {
-		Images::dumpTGA(fileName, *this);
+		Images::dumpTGA(fileName, *this, rle);
 		return;
 	}
 
-	Decoder decoder(*this);
+	// Only the first mip map of each layer is dumped, so only decompress those
+	Decoder decoder;
+
+	decoder._format     = _format;
+	decoder._layerCount = _layerCount;
+	decoder._isCubeMap  = _isCubeMap;
+
+	decoder._mipMaps.reserve(_layerCount);
+	for (size_t i = 0; i < _layerCount; i++)
+		decoder._mipMaps.push_back(new MipMap(getMipMap(0, i)));
+
 	decoder.decompress();
 
-	Images::dumpTGA(fileName, decoder);
+	Images::dumpTGA(fileName, decoder, rle);
 }
 
 void Decoder::flipHorizontally() {
 	decompress();
 
 	for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m)
-		::Images::flipHorizontally((*m)->data.get(), (*m)->width, (*m)->height, getBPP(_format));
+		::Images::flipHorizontally((*m)->getWritableData(), (*m)->width, (*m)->height, getBPP(_format));
 }
 
 void Decoder::flipVertically() {
 	decompress();
 
 	for (MipMaps::iterator m = _mipMaps.begin(); m != _mipMaps.end(); ++m)
-		::Images::flipVertically((*m)->data.get(), (*m)->width, (*m)->height, getBPP(_format));
+		::Images::flipVertically((*m)->getWritableData(), (*m)->width, (*m)->height, getBPP(_format));
 }
 
 } // End of namespace Images
@@ -51,7 +51,13 @@ public:
 		int    height; ///< The mip map's height.
 		uint32 size;   ///< The mip map's size in bytes.
 
-		Common::ScopedArray<byte> data; ///< The mip map's data.
+		Common::ScopedArray<byte> data; ///< The mip map's data, if the mip map owns it.
+
+		/** The mip map's data, if borrowed from the memory of the stream the image was read from.
+		 *
+		 *  Only used when the data is not owned by the mip map, see Decoder::readMipMapData().
+		 */
+		const byte *borrowedData;
 
 		MipMap();
 		MipMap(const MipMap &mipMap);
@@ -60,6 +66,11 @@ public:
 		MipMap &operator=(const MipMap &mipMap);
 
 		void swap(MipMap &right);
+
+		/** Return the mip map's data, whether it's owned or borrowed. */
+		const byte *getData() const;
+		/** Return the mip map's data for modification, copying borrowed data first. */
+		byte *getWritableData();
 	};
 
 	Decoder();
@@ -85,8 +96,8 @@ public:
 	/** Return TXI data, if embedded in the image. */
 	virtual Common::SeekableReadStream *getTXI() const;
 
-	/** Dump the image into a TGA. */
-	void dumpTGA(const Common::UString &fileName) const;
+	/** Dump the image into a TGA, optionally RLE-compressed. */
+	void dumpTGA(const Common::UString &fileName, bool rle = false) const;
 
 	/** Flip the whole image horizontally. */
 	void flipHorizontally();
@@ -105,13 +116,49 @@ protected:
 
 	MipMaps _mipMaps;
 
+	/** The stream the image was read from, if the image took it over.
+	 *
+	 *  As long as it exists, mip maps can borrow their data from its memory.
+	 */
+	Common::ScopedPtr<Common::SeekableReadStream> _stream;
+
 	/** Is the image data compressed? */
 	bool isCompressed() const;
 
-	/** Manually decompress the texture image data. */
-	void decompress();
+	/** Manually decompress the texture image data.
+	 *
+	 *  The mip maps and layers of an image, as well as bands of rows within
+	 *  larger mip maps, are decompressed independently of each other. They
+	 *  can therefore be spread over this many threads. 0 means one thread
+	 *  per CPU core.
+	 */
+	void decompress(size_t threads = 1);
+
+	/** Throw away all mip maps but the level mipMap of each layer.
+	 *
+	 *  The selected level then becomes mip map 0. This saves time and memory
+	 *  when only one level is needed anyway, like when dumping a TGA. -1
+	 *  keeps all mip maps.
+	 *
+	 *  Needs to be called while loading the image, before decompressing it.
+	 */
+	void dropUnusedMipMaps(int mipMap);
+
+	/** Read the data of this mip map from the current position of the stream.
+	 *
+	 *  If the stream is the one the image took over, and its data is directly
+	 *  available in memory, the mip map borrows that data instead of copying it.
+	 */
+	void readMipMapData(Common::SeekableReadStream &stream, MipMap &mipMap);
 
 	static void decompress(MipMap &out, const MipMap &in, PixelFormat format);
+
+private:
+	/** Check that a mip map can be decompressed, and allocate the decompressed pixels. */
+	static void allocateDecompressed(MipMap &out, const MipMap &in, PixelFormat format);
+	/** Decompress the block rows [firstRow, firstRow + rowCount) of a mip map. */
+	static void decompress(MipMap &out, const MipMap &in, PixelFormat format,
+	                       uint32 firstRow, uint32 rowCount);
 };
 
 } // End of namespace Images
@@ -23,98 +23,211 @@
  */
 
 #include <cstdio>
+#include <cstring>
 
 #include "src/common/scopedptr.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/writefile.h"
 
 #include "src/images/decoder.h"
+#include "src/images/dumptga.h"
 
 namespace Images {
 
-static void writePixel(Common::WriteStream &file, const byte *&data, PixelFormat format) {
-	if (format == kPixelFormatR8G8B8) {
-		file.writeByte(data[2]);
-		file.writeByte(data[1]);
-		file.writeByte(data[0]);
-		file.writeByte(0xFF);
-		data += 3;
-	} else if (format == kPixelFormatB8G8R8) {
-		file.writeByte(data[0]);
-		file.writeByte(data[1]);
-		file.writeByte(data[2]);
-		file.writeByte(0xFF);
-		data += 3;
-	} else if (format == kPixelFormatR8G8B8A8) {
-		file.writeByte(data[2]);
-		file.writeByte(data[1]);
-		file.writeByte(data[0]);
-		file.writeByte(data[3]);
-		data += 4;
-	} else if (format == kPixelFormatB8G8R8A8) {
-		file.writeByte(data[0]);
-		file.writeByte(data[1]);
-		file.writeByte(data[2]);
-		file.writeByte(data[3]);
-		data += 4;
-	} else if (format == kPixelFormatR5G6B5) {
-		uint16 color = READ_LE_UINT16(data);
-		file.writeByte( color & 0x001F);
-		file.writeByte((color & 0x07E0) >>  5);
-		file.writeByte((color & 0xF800) >> 11);
-		file.writeByte(0xFF);
-		data += 2;
-	} else if (format == kPixelFormatA1R5G5B5) {
-		uint16 color = READ_LE_UINT16(data);
-		file.writeByte( color & 0x001F);
-		file.writeByte((color & 0x03E0) >>  5);
-		file.writeByte((color & 0x7C00) >> 10);
-		file.writeByte((color & 0x8000) ? 0xFF : 0x00);
-		data += 2;
-	} else if (format == kPixelFormatDepth16) {
-		uint16 color = READ_LE_UINT16(data);
-		file.writeByte(color / 128);
-		file.writeByte(color / 128);
-		file.writeByte(color / 128);
-		file.writeByte((color >= 0x7FFF) ? 0x00 : 0xFF);
-
-		data += 2;
-	} else
-		throw Common::Exception("Unsupported pixel format: %d", (int) format);
+/** Return the number of bytes per pixel in a format dumpTGA() can convert. */
+static uint32 getPixelSize(PixelFormat format) {
+	switch (format) {
+		case kPixelFormatR8G8B8:
+		case kPixelFormatB8G8R8:
+			return 3;
 
+		case kPixelFormatR8G8B8A8:
+		case kPixelFormatB8G8R8A8:
+			return 4;
+
+		case kPixelFormatR5G6B5:
+		case kPixelFormatA1R5G5B5:
+		case kPixelFormatDepth16:
+			return 2;
+
+		default:
+			break;
+	}
+
+	throw Common::Exception("Unsupported pixel format: %d", (int) format);
 }
 
-static Common::WriteStream *openTGA(const Common::UString &fileName, int width, int height) {
-	Common::WriteFile *file = new Common::WriteFile(fileName);
+/** Convert a row of pixels into 32-bit BGRA.
+ *
+ *  The format is only checked once per row, leaving simple loops over the
+ *  pixels the compiler can unroll and vectorize.
+ */
+static void convertRow(byte *dest, const byte *src, uint32 width, PixelFormat format) {
+	switch (format) {
+		case kPixelFormatR8G8B8:
+			for (uint32 x = 0; x < width; x++, dest += 4, src += 3) {
+				dest[0] = src[2];
+				dest[1] = src[1];
+				dest[2] = src[0];
+				dest[3] = 0xFF;
+			}
+			break;
+
+		case kPixelFormatB8G8R8:
+			for (uint32 x = 0; x < width; x++, dest += 4, src += 3) {
+				dest[0] = src[0];
+				dest[1] = src[1];
+				dest[2] = src[2];
+				dest[3] = 0xFF;
+			}
+			break;
+
+		case kPixelFormatR8G8B8A8:
+			for (uint32 x = 0; x < width; x++, dest += 4, src += 4) {
+				dest[0] = src[2];
+				dest[1] = src[1];
+				dest[2] = src[0];
+				dest[3] = src[3];
+			}
+			break;
+
+		case kPixelFormatB8G8R8A8:
+			std::memcpy(dest, src, width * 4);
+			break;
 
-	file->writeByte(0);     // ID Length
-	file->writeByte(0);     // Palette size
-	file->writeByte(2);     // Unmapped RGB
-	file->writeUint32LE(0); // Color map
-	file->writeByte(0);     // Color map
-	file->writeUint16LE(0); // X
-	file->writeUint16LE(0); // Y
+		case kPixelFormatR5G6B5:
+			for (uint32 x = 0; x < width; x++, dest += 4, src += 2) {
+				const uint16 color = READ_LE_UINT16(src);
 
-	file->writeUint16LE(width);
-	file->writeUint16LE(height);
+				dest[0] =  color & 0x001F;
+				dest[1] = (color & 0x07E0) >>  5;
+				dest[2] = (color & 0xF800) >> 11;
+				dest[3] = 0xFF;
+			}
+			break;
 
-	file->writeByte(32); // Pixel depths
+		case kPixelFormatA1R5G5B5:
+			for (uint32 x = 0; x < width; x++, dest += 4, src += 2) {
+				const uint16 color = READ_LE_UINT16(src);
 
-	file->writeByte(0);
+				dest[0] =  color & 0x001F;
+				dest[1] = (color & 0x03E0) >>  5;
+				dest[2] = (color & 0x7C00) >> 10;
+				dest[3] = (color & 0x8000) ? 0xFF : 0x00;
+			}
+			break;
 
-	return file;
+		case kPixelFormatDepth16:
+			for (uint32 x = 0; x < width; x++, dest += 4, src += 2) {
+				const uint16 color = READ_LE_UINT16(src);
+
+				dest[0] = dest[1] = dest[2] = color / 128;
+				dest[3] = (color >= 0x7FFF) ? 0x00 : 0xFF;
+			}
+			break;
+
+		default:
+			throw Common::Exception("Unsupported pixel format: %d", (int) format);
+	}
 }
 
-static void writeMipMap(Common::WriteStream &stream, const Decoder::MipMap &mipMap, PixelFormat format) {
-	const byte *data = mipMap.data.get();
+/** Return the size of a buffer big enough for a RLE-compressed row of pixels.
+ *
+ *  In the worst case, the row consists of raw packets of 128 pixels each,
+ *  with one extra byte per packet.
+ */
+static size_t getRLERowSize(uint32 width) {
+	return width * 4 + (width + 127) / 128;
+}
 
-	uint32 count = mipMap.width * mipMap.height;
-	while (count-- > 0)
-		writePixel(stream, data, format);
+static inline bool isSamePixel(const byte *a, const byte *b) {
+	return std::memcmp(a, b, 4) == 0;
 }
 
-void dumpTGA(const Common::UString &fileName, const Decoder &image) {
+/** RLE-compress a row of 32-bit pixels. Returns the size of the compressed row.
+ *
+ *  Packets never cross rows. A run of two or more equal pixels is written
+ *  as a run-length packet, everything else is collected into raw packets.
+ */
+static size_t compressRow(byte *dest, const byte *row, uint32 width) {
+	byte *start = dest;
+
+	for (uint32 x = 0; x < width; ) {
+		const byte *pixel = row + x * 4;
+		const uint32 maxLength = MIN<uint32>(width - x, 128);
+
+		uint32 length = 1;
+		while ((length < maxLength) && isSamePixel(pixel, pixel + length * 4))
+			length++;
+
+		if (length > 1) {
+			*dest++ = 0x80 | (length - 1);
+
+			std::memcpy(dest, pixel, 4);
+			dest += 4;
+
+			x += length;
+			continue;
+		}
+
+		// Collect pixels until the start of the next run
+		while ((length < maxLength) &&
+		       (((length + 1) == (width - x)) || !isSamePixel(pixel + length * 4, pixel + (length + 1) * 4)))
+			length++;
+
+		*dest++ = length - 1;
+
+		std::memcpy(dest, pixel, length * 4);
+		dest += length * 4;
+
+		x += length;
+	}
+
+	return dest - start;
+}
+
+static void writeHeader(Common::WriteStream &stream, int width, int height, bool rle) {
+	stream.writeByte(0);            // ID Length
+	stream.writeByte(0);            // Palette size
+	stream.writeByte(rle ? 10 : 2); // (RLE-compressed) unmapped RGB
+	stream.writeUint32LE(0);        // Color map
+	stream.writeByte(0);            // Color map
+	stream.writeUint16LE(0);        // X
+	stream.writeUint16LE(0);        // Y
+
+	stream.writeUint16LE(width);
+	stream.writeUint16LE(height);
+
+	stream.writeByte(32); // Pixel depths
+
+	stream.writeByte(0);
+}
+
+static void writeMipMap(Common::WriteStream &stream, const Decoder::MipMap &mipMap, PixelFormat format, bool rle) {
+	const uint32 width     = mipMap.width;
+	const uint32 pixelSize = getPixelSize(format);
+
+	Common::ScopedArray<byte> row(new byte[width * 4]);
+	Common::ScopedArray<byte> compressed(rle ? new byte[getRLERowSize(width)] : 0);
+
+	const byte *data = mipMap.getData();
+	for (int y = 0; y < mipMap.height; y++, data += width * pixelSize) {
+		convertRow(row.get(), data, width, format);
+
+		if (rle) {
+			const size_t size = compressRow(compressed.get(), row.get(), width);
+
+			if (stream.write(compressed.get(), size) != size)
+				throw Common::Exception(Common::kWriteError);
+
+		} else if (stream.write(row.get(), width * 4) != (width * 4))
+			throw Common::Exception(Common::kWriteError);
+	}
+}
+
+void dumpTGA(Common::WriteStream &stream, const Decoder &image, bool rle) {
 	if ((image.getLayerCount() < 1) || (image.getMipMapCount() < 1))
 		throw Common::Exception("No image");
 
@@ -130,12 +243,21 @@ void dumpTGA(const Common::UString &fileName, const Decoder &image) {
 		height += mipMap.height;
 	}
 
-	Common::ScopedPtr<Common::WriteStream> file(openTGA(fileName, width, height));
+	// Throws on unsupported formats, before anything has been written
+	getPixelSize(image.getFormat());
+
+	writeHeader(stream, width, height, rle);
 
 	for (size_t i = 0; i < image.getLayerCount(); i++)
-		writeMipMap(*file, image.getMipMap(0, i), image.getFormat());
+		writeMipMap(stream, image.getMipMap(0, i), image.getFormat(), rle);
+}
+
+void dumpTGA(const Common::UString &fileName, const Decoder &image, bool rle) {
+	Common::WriteFile file(fileName);
+
+	dumpTGA(file, image, rle);
 
-	file->flush();
+	file.flush();
 }
 
 } // End of namespace Images
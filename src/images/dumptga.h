@@ -31,14 +31,22 @@
 
 namespace Common {
 	class UString;
+	class WriteStream;
 }
 
 namespace Images {
 
 class Decoder;
 
-/** Dump image into a TGA file. */
-void dumpTGA(const Common::UString &fileName, const Decoder &image);
+/** Dump image into a TGA file.
+ *
+ *  The TGA is always written as 32-bit BGRA. If rle is true, the pixel data
+ *  is RLE-compressed.
+ */
+void dumpTGA(const Common::UString &fileName, const Decoder &image, bool rle = false);
+
+/** Dump image as a TGA into a stream. */
+void dumpTGA(Common::WriteStream &stream, const Decoder &image, bool rle = false);
 
 } // End of namespace Images
 
@@ -30,6 +30,7 @@
 #include "src/common/readstream.h"
 
 #include "src/images/nbfs.h"
+#include "src/images/nitro.h"
 
 namespace Images {
 
@@ -126,17 +127,14 @@ void NBFS::readImage(Common::SeekableReadStream &nbfs, const byte *palette,
 
 	_mipMaps.back()->data.reset(new byte[_mipMaps.back()->size]);
 
-	bool is0Transp = (palette[0] == 0xF8) && (palette[1] == 0x00) && (palette[2] == 0xF8);
+	Common::ScopedArray<byte> pixels(new byte[width * height]);
+	if (nbfs.read(pixels.get(), width * height) != (width * height))
+		throw Common::Exception(Common::kReadError);
 
-	byte *data = _mipMaps.back()->data.get();
-	for (uint32 i = 0; i < (width * height); i++, data += 4) {
-		uint8 pixel = nbfs.readByte();
+	byte expandedPalette[kNitroPaletteSize];
+	expandNitroPalette(expandedPalette, palette);
 
-		data[0] = palette[pixel * 3 + 0];
-		data[1] = palette[pixel * 3 + 1];
-		data[2] = palette[pixel * 3 + 2];
-		data[3] = ((pixel == 0) && is0Transp) ? 0x00 : 0xFF;
-	}
+	drawNitroPixels(_mipMaps.back()->data.get(), pixels.get(), width * height, expandedPalette);
 }
 
 
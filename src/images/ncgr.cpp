@@ -48,6 +48,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/readstream.h"
@@ -55,6 +57,7 @@
 
 #include "src/images/ncgr.h"
 #include "src/images/nclr.h"
+#include "src/images/nitro.h"
 
 static const uint32 kNCGRID = MKTAG('N', 'C', 'G', 'R');
 static const uint32 kCHARID = MKTAG('C', 'H', 'A', 'R');
@@ -189,12 +192,12 @@ void NCGR::readChar(NCGRFile &ctx) {
 	if ((ctx.width >= 0x8000) || (ctx.height >= 0x8000))
 		throw Common::Exception("Unsupported image dimensions");
 
-	// depthValue == 3 means 4 bit graphics. We don't need to support them.
+	// depthValue == 3 means 4 bit graphics, depthValue == 4 means 8 bit graphics
 	const uint32 depthValue = ctx.ncgr->readUint32();
-	if (depthValue != 4)
+	if ((depthValue != 3) && (depthValue != 4))
 		throw Common::Exception("Unsupported image depth %u", depthValue);
 
-	ctx.depth = 8;
+	ctx.depth = (depthValue == 3) ? 4 : 8;
 
 	ctx.ncgr->skip(4); // Unknown
 
@@ -262,15 +265,12 @@ void NCGR::draw(ReadContext &ctx) {
 	_mipMaps.back()->data.reset(new byte[_mipMaps.back()->size]);
 	byte *data = _mipMaps.back()->data.get();
 
-	const bool is0Transp = (ctx.pal[0] == 0xF8) && (ctx.pal[1] == 0x00) && (ctx.pal[2] == 0xF8);
+	byte palette[kNitroPaletteSize];
+	expandNitroPalette(palette, ctx.pal.get());
 
 	// Fill with palette entry 0. Some NCGR cells might be empty, or smaller
-	for (uint32 i = 0; i < (imageWidth * imageHeight); i++) {
-		data[i * 4 + 0] = ctx.pal[0];
-		data[i * 4 + 1] = ctx.pal[1];
-		data[i * 4 + 2] = ctx.pal[2];
-		data[i * 4 + 3] = is0Transp ? 0x00 : 0xFF;
-	}
+	for (uint32 i = 0; i < (imageWidth * imageHeight); i++)
+		std::memcpy(data + i * 4, palette, 4);
 
 	/* The actual image data is stored in a "tiled" fashion, so we need to unswizzle
 	 * this manually. Moreover, we ourselves stitch together several NCGR files into
@@ -283,8 +283,6 @@ void NCGR::draw(ReadContext &ctx) {
 		if (!n->image)
 			continue;
 
-		n->image->seek(0);
-
 		// Position of this NCGR within the big image
 		const uint32 imagePos = n->offsetX + n->offsetY * imageWidth;
 
@@ -292,35 +290,15 @@ void NCGR::draw(ReadContext &ctx) {
 		const uint32 tilesX = n->width  / tileWidth;
 		const uint32 tilesY = n->height / tileHeight;
 
-		// Go over all tiles
-		for (uint32 yT = 0; yT < tilesY; yT++) {
-			for (uint32 xT = 0; xT < tilesX; xT++) {
-
-				// Position of the tile within the NCGR
-				const uint32 tilePos = xT * tileWidth + yT * tileHeight * imageWidth;
-
-				// Go over all pixels in the tile
-				for (uint32 y = 0; y < tileHeight; y++) {
-					for (uint32 x = 0; x < tileWidth; x++) {
+		// Read all tiles in one go, and draw them tile by tile
+		const size_t tilesSize = tilesX * tilesY * getNitroTileSize(n->depth);
+		Common::ScopedArray<byte> tiles(new byte[tilesSize]);
 
-						// Position of the pixel within the tile
-						const uint32 pos   = imagePos + tilePos + x + y * imageWidth;
-						const uint8  pixel = n->image->readByte();
-
-						if (pos > (imageWidth * imageHeight))
-							continue;
-
-						data[pos * 4 + 0] = ctx.pal[pixel * 3 + 0];
-						data[pos * 4 + 1] = ctx.pal[pixel * 3 + 1];
-						data[pos * 4 + 2] = ctx.pal[pixel * 3 + 2];
-						data[pos * 4 + 3] = ((pixel == 0) && is0Transp) ? 0x00 : 0xFF;
-
-					}
-				}
-
-			}
-		}
+		n->image->seek(0);
+		if (n->image->read(tiles.get(), tilesSize) != tilesSize)
+			throw Common::Exception(Common::kReadError);
 
+		drawNitroTiles(data + imagePos * 4, imageWidth * 4, tiles.get(), tilesX, tilesY, n->depth, palette);
 	}
 }
 
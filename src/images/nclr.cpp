@@ -138,7 +138,7 @@ const byte *NCLR::readPalette(Common::SeekableSubReadStreamEndian &nclr) {
 
 	nclr.seek(startOffset);
 
-	Common::ScopedArray<byte> palette(new byte[colorCount * 3]);
+	Common::ScopedArray<byte> palette(new byte[768]);
 
 	for (uint32 i = 0; i < colorCount; i += 3) {
 		const uint16 color = nclr.readUint16();
@@ -0,0 +1,116 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Decoding helpers for paletted Nintendo DS (Nitro) graphics.
+ */
+
+/* Instead of looking up every single pixel in the palette and stitching it
+ * together color by color, the palette is expanded into ready-made B8G8R8A8
+ * pixels once. The tiles are then drawn a full tile row at a time, straight
+ * out of memory.
+ *
+ * For 4-bit tiles, we go one step further: every byte holds two pixels, so
+ * we build a table of all 256 possible pixel pairs and copy 8 bytes of
+ * output for each byte of input.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+
+#include "src/images/nitro.h"
+
+namespace Images {
+
+static const uint32 kTileWidth  = 8;
+static const uint32 kTileHeight = 8;
+
+void expandNitroPalette(byte *pixels, const byte *palette) {
+	for (size_t i = 0; i < 256; i++) {
+		pixels[i * 4 + 0] = palette[i * 3 + 0];
+		pixels[i * 4 + 1] = palette[i * 3 + 1];
+		pixels[i * 4 + 2] = palette[i * 3 + 2];
+		pixels[i * 4 + 3] = 0xFF;
+	}
+
+	const bool is0Transp = (palette[0] == 0xF8) && (palette[1] == 0x00) && (palette[2] == 0xF8);
+	if (is0Transp)
+		pixels[3] = 0x00;
+}
+
+static void drawTiles8(byte *dst, uint32 pitch, const byte *tiles, uint32 tilesX, uint32 tilesY,
+                       const byte *palette) {
+
+	for (uint32 yT = 0; yT < tilesY; yT++, dst += kTileHeight * pitch) {
+		for (uint32 xT = 0; xT < tilesX; xT++) {
+			byte *tile = dst + xT * kTileWidth * 4;
+
+			for (uint32 y = 0; y < kTileHeight; y++, tile += pitch, tiles += kTileWidth)
+				for (uint32 x = 0; x < kTileWidth; x++)
+					std::memcpy(tile + x * 4, palette + tiles[x] * 4, 4);
+		}
+	}
+}
+
+static void drawTiles4(byte *dst, uint32 pitch, const byte *tiles, uint32 tilesX, uint32 tilesY,
+                       const byte *palette) {
+
+	// All 256 possible pairs of two pixels, low nibble first
+	Common::ScopedArray<byte> pairs(new byte[256 * 8]);
+	for (size_t i = 0; i < 256; i++) {
+		std::memcpy(pairs.get() + i * 8 + 0, palette + (i & 0x0F) * 4, 4);
+		std::memcpy(pairs.get() + i * 8 + 4, palette + (i >>   4) * 4, 4);
+	}
+
+	const uint32 rowSize = kTileWidth / 2;
+
+	for (uint32 yT = 0; yT < tilesY; yT++, dst += kTileHeight * pitch) {
+		for (uint32 xT = 0; xT < tilesX; xT++) {
+			byte *tile = dst + xT * kTileWidth * 4;
+
+			for (uint32 y = 0; y < kTileHeight; y++, tile += pitch, tiles += rowSize)
+				for (uint32 x = 0; x < rowSize; x++)
+					std::memcpy(tile + x * 8, pairs.get() + tiles[x] * 8, 8);
+		}
+	}
+}
+
+void drawNitroTiles(byte *dst, uint32 pitch, const byte *tiles, uint32 tilesX, uint32 tilesY,
+                    uint8 depth, const byte *palette) {
+
+	assert(pitch >= (tilesX * kTileWidth * 4));
+
+	if      (depth == 8)
+		drawTiles8(dst, pitch, tiles, tilesX, tilesY, palette);
+	else if (depth == 4)
+		drawTiles4(dst, pitch, tiles, tilesX, tilesY, palette);
+	else
+		throw Common::Exception("Unsupported tile depth %u", depth);
+}
+
+void drawNitroPixels(byte *dst, const byte *src, size_t count, const byte *palette) {
+	for (size_t i = 0; i < count; i++, dst += 4)
+		std::memcpy(dst, palette + src[i] * 4, 4);
+}
+
+} // End of namespace Images
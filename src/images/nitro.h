@@ -0,0 +1,71 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Decoding helpers for paletted Nintendo DS (Nitro) graphics.
+ */
+
+#ifndef IMAGES_NITRO_H
+#define IMAGES_NITRO_H
+
+#include <cstddef>
+
+#include "src/common/types.h"
+
+namespace Images {
+
+/** Size in bytes of a palette expanded by expandNitroPalette(). */
+static const size_t kNitroPaletteSize = 256 * 4;
+
+/** Return the size in bytes of an 8x8 pixel tile with this color depth in bits. */
+static inline uint32 getNitroTileSize(uint8 depth) {
+	return depth * 8;
+}
+
+/** Expand a palette of 256 B8G8R8 colors into 256 B8G8R8A8 pixels.
+ *
+ *  If color 0 is the magic magenta 0xF8, 0x00, 0xF8, it is the transparent
+ *  color and gets an alpha of 0. All other colors are fully opaque.
+ */
+void expandNitroPalette(byte *pixels, const byte *palette);
+
+/** Draw a block of 8x8 pixel tiles into a B8G8R8A8 image.
+ *
+ *  The tiles are stored one after the other, in rows of tilesX tiles. Each
+ *  tile holds its 64 palette indices in rows, with either 8 bits or 4 bits
+ *  per pixel. In the latter case, the low nibble is the left pixel.
+ *
+ *  @param dst     The top-left pixel of the block within the image.
+ *  @param pitch   The size in bytes of a full row of pixels in the image.
+ *  @param tiles   The tile data, tilesX * tilesY * getNitroTileSize(depth) bytes.
+ *  @param tilesX  The width of the block in tiles.
+ *  @param tilesY  The height of the block in tiles.
+ *  @param depth   The color depth of the tiles in bits, either 4 or 8.
+ *  @param palette A palette expanded by expandNitroPalette().
+ */
+void drawNitroTiles(byte *dst, uint32 pitch, const byte *tiles, uint32 tilesX, uint32 tilesY,
+                    uint8 depth, const byte *palette);
+
+/** Draw count untiled 8-bit palette indices into B8G8R8A8 pixels. */
+void drawNitroPixels(byte *dst, const byte *src, size_t count, const byte *palette);
+
+} // End of namespace Images
+
+#endif // IMAGES_NITRO_H
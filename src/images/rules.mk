@@ -28,6 +28,7 @@ src_images_libimages_la_SOURCES += \
     src/images/s3tc.h \
     src/images/decoder.h \
     src/images/dumptga.h \
+    src/images/convert.h \
     src/images/winiconimage.h \
     src/images/tga.h \
     src/images/dds.h \
@@ -35,6 +36,7 @@ src_images_libimages_la_SOURCES += \
     src/images/txb.h \
     src/images/sbm.h \
     src/images/xoreositex.h \
+    src/images/nitro.h \
     src/images/nbfs.h \
     src/images/nclr.h \
     src/images/ncgr.h \
@@ -48,6 +50,7 @@ src_images_libimages_la_SOURCES += \
     src/images/s3tc.cpp \
     src/images/decoder.cpp \
     src/images/dumptga.cpp \
+    src/images/convert.cpp \
     src/images/winiconimage.cpp \
     src/images/tga.cpp \
     src/images/dds.cpp \
@@ -55,6 +58,7 @@ src_images_libimages_la_SOURCES += \
     src/images/txb.cpp \
     src/images/sbm.cpp \
     src/images/xoreositex.cpp \
+    src/images/nitro.cpp \
     src/images/nbfs.cpp \
     src/images/nclr.cpp \
     src/images/ncgr.cpp \
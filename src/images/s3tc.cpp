@@ -22,13 +22,20 @@
  *  Manual S3TC DXTn decompression methods.
  */
 
+#include <cstring>
+
 #include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
 #include "src/common/readstream.h"
 
 #include "src/images/s3tc.h"
 
 namespace Images {
 
+static const size_t kDXT1BlockSize  =  8; ///< Size of a DXT1 block of 4x4 pixels, in bytes.
+static const size_t kDXT35BlockSize = 16; ///< Size of a DXT3/DXT5 block of 4x4 pixels, in bytes.
+
 static uint32 convert565To8888(uint16 color) {
 	return ((color & 0x1F) << 11) | ((color & 0x7E0) << 13) | ((color & 0xF800) << 16) | 0xFF;
 }
@@ -50,170 +57,266 @@ static uint32 interpolate32(double weight, uint32 color_0, uint32 color_1) {
 	return r[2] << 24 | g[2] << 16 | b[2] << 8 | a[2];
 }
 
-struct DXT1Texel {
-	uint16 color_0;
-	uint16 color_1;
-	uint32 pixels;
+/** The weights with which the two base colors of a block are interpolated. */
+enum Weight {
+	kWeightThird     = 0,
+	kWeightTwoThirds    ,
+	kWeightHalf         ,
+	kWeightMAX
 };
 
-#define READ_DXT1_TEXEL(x) \
-	x.color_0 = src.readUint16LE(); \
-	x.color_1 = src.readUint16LE(); \
-	x.pixels = src.readUint32BE()
+static const double kWeights[kWeightMAX] = { 0.333333f, 0.666666f, 0.5f };
 
-void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
-	for (int32 ty = height; ty > 0; ty -= 4) {
-		for (uint32 tx = 0; tx < width; tx += 4) {
-			DXT1Texel tex;
-			READ_DXT1_TEXEL(tex);
-			uint32 blended[4];
+/** Lookup tables with the results of interpolate32().
+ *
+ *  The base colors of a block are expanded from R5G6B5 by a simple shift,
+ *  so each color channel can only contain 32 or 64 different values, and
+ *  the alpha channel is either fully opaque or fully transparent. For the
+ *  few weights we need, all possible interpolations of a channel easily
+ *  fit into small tables. Building those with interpolate32() itself
+ *  keeps the results identical, down to its rounding behaviour, while
+ *  not doing any floating point math per block.
+ */
+struct InterpolationTables {
+	byte channel5[kWeightMAX][32][32]; ///< Interpolations of 5-bit channels (red and blue).
+	byte channel6[kWeightMAX][64][64]; ///< Interpolations of 6-bit channels (green).
+	byte alpha[kWeightMAX][2];         ///< Interpolations of transparent and opaque alpha.
+
+	InterpolationTables() {
+		for (size_t w = 0; w < kWeightMAX; w++) {
+			for (uint32 i = 0; i < 32; i++)
+				for (uint32 j = 0; j < 32; j++)
+					channel5[w][i][j] = interpolate32(kWeights[w], (i << 3) << 24, (j << 3) << 24) >> 24;
+
+			for (uint32 i = 0; i < 64; i++)
+				for (uint32 j = 0; j < 64; j++)
+					channel6[w][i][j] = interpolate32(kWeights[w], (i << 2) << 24, (j << 2) << 24) >> 24;
+
+			alpha[w][0] = interpolate32(kWeights[w], 0x00, 0x00) & 0xFF;
+			alpha[w][1] = interpolate32(kWeights[w], 0xFF, 0xFF) & 0xFF;
+		}
+	}
 
-			blended[0] = convert565To8888(tex.color_0);
-			blended[1] = convert565To8888(tex.color_1);
+	/** Interpolate two R5G6B5 colors, with the same results as interpolate32(). */
+	uint32 interpolate(Weight w, uint16 color_0, uint16 color_1, bool opaque) const {
+		const byte r = channel5[w][ color_0 >> 11        ][ color_1 >> 11        ];
+		const byte g = channel6[w][(color_0 >>  5) & 0x3F][(color_1 >>  5) & 0x3F];
+		const byte b = channel5[w][ color_0        & 0x1F][ color_1        & 0x1F];
 
-			if (tex.color_0 > tex.color_1) {
-				blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-				blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
-			} else {
-				blended[2] = interpolate32(0.5f, blended[0], blended[1]);
-				blended[3] = 0;
-			}
+		return (r << 24) | (g << 16) | (b << 8) | alpha[w][opaque ? 1 : 0];
+	}
+};
 
-			uint32 cpx = tex.pixels;
-			uint32 blockWidth = MIN<uint32>(width, 4);
-			uint32 blockHeight = MIN<uint32>(height, 4);
+static const InterpolationTables &getInterpolationTables() {
+	static const InterpolationTables tables;
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32 destX = tx + x;
-					const uint32 destY = height - 1 - (ty - blockHeight + y);
+	return tables;
+}
 
-					const uint32 pixel =  blended[cpx & 3];
+/** Read the four colors of a block.
+ *
+ *  DXT1 blocks are opaque, and switch to three colors plus transparent
+ *  black if the first base color isn't the bigger one. DXT3 and DXT5
+ *  blocks carry their own alpha, and always use four colors.
+ */
+static inline void readColors(const InterpolationTables &tables, const byte *block, bool dxt1, uint32 (&colors)[4]) {
+	const uint16 color_0 = READ_LE_UINT16(block + 0);
+	const uint16 color_1 = READ_LE_UINT16(block + 2);
 
-					cpx >>= 2;
+	const uint32 alphaMask = dxt1 ? 0xFFFFFFFF : 0xFFFFFF00;
 
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
-			}
-		}
+	colors[0] = convert565To8888(color_0) & alphaMask;
+	colors[1] = convert565To8888(color_1) & alphaMask;
+
+	if (!dxt1 || (color_0 > color_1)) {
+		colors[2] = tables.interpolate(kWeightThird    , color_0, color_1, dxt1);
+		colors[3] = tables.interpolate(kWeightTwoThirds, color_0, color_1, dxt1);
+	} else {
+		colors[2] = tables.interpolate(kWeightHalf     , color_0, color_1, dxt1);
+		colors[3] = 0;
 	}
 }
 
-struct DXT23Texel : public DXT1Texel {
-	uint16 alpha[4];
-};
+/** Write a decoded block of pixels into the image.
+ *
+ *  The pixels are ordered like their indices within the block. Images
+ *  smaller than a block only use the first blockWidth * blockHeight
+ *  pixels; rows and columns outside the image are clipped.
+ */
+static inline void writeBlock(byte *dest, const byte *pixels, uint32 tx, int32 ty,
+                              uint32 width, uint32 height, uint32 pitch,
+                              uint32 blockWidth, uint32 blockHeight) {
 
-#define READ_DXT3_TEXEL(x) \
-	x.alpha[0] = src.readUint16LE(); \
-	x.alpha[1] = src.readUint16LE(); \
-	x.alpha[2] = src.readUint16LE(); \
-	x.alpha[3] = src.readUint16LE(); \
-	READ_DXT1_TEXEL(x)
+	const uint32 rowSize = MIN<uint32>(blockWidth, width - tx) * 4;
+
+	for (uint32 y = 0; y < blockHeight; ++y, pixels += blockWidth * 4) {
+		const uint32 destY = height - 1 - (ty - blockHeight + y);
+
+		if (destY < height)
+			std::memcpy(dest + destY * pitch + tx * 4, pixels, rowSize);
+	}
+}
+
+/** Return the number of bytes needed for all blocks of an image. */
+static size_t getDataSize(uint32 width, uint32 height, size_t blockSize) {
+	return ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+}
+
+/** Return the raw data of all the blocks of an image in the stream.
+ *
+ *  If the stream's data is directly accessible, that is used without any
+ *  copying. Otherwise, the data is read into the buffer.
+ */
+static const byte *getData(Common::SeekableReadStream &src, size_t size, Common::ScopedArray<byte> &buffer) {
+	const byte *data = src.getData();
+	const size_t pos = src.pos();
+
+	if (data && ((src.size() - pos) >= size)) {
+		src.skip(size);
+
+		return data + pos;
+	}
+
+	buffer.reset(new byte[size]);
+	if (src.read(buffer.get(), size) != size)
+		throw Common::Exception(Common::kReadError);
+
+	return buffer.get();
+}
+
+void decompressDXT1(byte *dest, const byte *src, size_t size, uint32 width, uint32 height, uint32 pitch) {
+	if (size < getDataSize(width, height, kDXT1BlockSize))
+		throw Common::Exception(Common::kReadError);
+
+	const InterpolationTables &tables = getInterpolationTables();
+
+	const uint32 blockWidth  = MIN<uint32>(width , 4);
+	const uint32 blockHeight = MIN<uint32>(height, 4);
+	const uint32 pixelCount  = blockWidth * blockHeight;
 
-void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
 	for (int32 ty = height; ty > 0; ty -= 4) {
-		for (uint32 tx = 0; tx < width; tx += 4) {
-			DXT23Texel tex;
-			uint32 blended[4];
-			READ_DXT3_TEXEL(tex);
+		for (uint32 tx = 0; tx < width; tx += 4, src += kDXT1BlockSize) {
+			uint32 colors[4];
+			readColors(tables, src, true, colors);
+
+			byte pixels[16 * 4];
+
+			uint32 cpx = READ_BE_UINT32(src + 4);
+			for (uint32 i = 0; i < pixelCount; i++, cpx >>= 2)
+				WRITE_BE_UINT32(pixels + i * 4, colors[cpx & 3]);
+
+			writeBlock(dest, pixels, tx, ty, width, height, pitch, blockWidth, blockHeight);
+		}
+	}
+}
+
+void decompressDXT3(byte *dest, const byte *src, size_t size, uint32 width, uint32 height, uint32 pitch) {
+	if (size < getDataSize(width, height, kDXT35BlockSize))
+		throw Common::Exception(Common::kReadError);
 
-			blended[0] = convert565To8888(tex.color_0) & 0xFFFFFF00;
-			blended[1] = convert565To8888(tex.color_1) & 0xFFFFFF00;
-			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
+	const InterpolationTables &tables = getInterpolationTables();
 
-			uint32 cpx = tex.pixels;
-			uint32 blockWidth = MIN<uint32>(width, 4);
-			uint32 blockHeight = MIN<uint32>(height, 4);
+	const uint32 blockWidth  = MIN<uint32>(width , 4);
+	const uint32 blockHeight = MIN<uint32>(height, 4);
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32 destX = tx + x;
-					const uint32 destY = height - 1 - (ty - blockHeight + y);
+	for (int32 ty = height; ty > 0; ty -= 4) {
+		for (uint32 tx = 0; tx < width; tx += 4, src += kDXT35BlockSize) {
+			uint32 colors[4];
+			readColors(tables, src + 8, false, colors);
 
-					const uint32 alpha = (tex.alpha[y] >> (x * 4)) & 0xF;
-					const uint32 pixel = blended[cpx & 3] | alpha << 4;
+			byte pixels[16 * 4];
+			byte *pixel = pixels;
 
-					cpx >>= 2;
+			uint32 cpx = READ_BE_UINT32(src + 12);
+			for (uint32 y = 0; y < blockHeight; ++y) {
+				uint32 alpha = READ_LE_UINT16(src + y * 2);
 
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
+				for (uint32 x = 0; x < blockWidth; ++x, cpx >>= 2, alpha >>= 4, pixel += 4)
+					WRITE_BE_UINT32(pixel, colors[cpx & 3] | (alpha & 0xF) << 4);
 			}
+
+			writeBlock(dest, pixels, tx, ty, width, height, pitch, blockWidth, blockHeight);
 		}
 	}
 }
 
-struct DXT45Texel : public DXT1Texel {
-	byte alpha_0;
-	byte alpha_1;
-	uint64 alphabl;
-};
+void decompressDXT5(byte *dest, const byte *src, size_t size, uint32 width, uint32 height, uint32 pitch) {
+	if (size < getDataSize(width, height, kDXT35BlockSize))
+		throw Common::Exception(Common::kReadError);
 
-static uint64 readUint48LE(Common::SeekableReadStream &src) {
-	uint64 output = src.readUint32LE();
-	return output | ((uint64)src.readUint16LE() << 32);
-}
+	const InterpolationTables &tables = getInterpolationTables();
 
-#define READ_DXT5_TEXEL(x) \
-	x.alpha_0 = src.readByte(); \
-	x.alpha_1 = src.readByte(); \
-	x.alphabl = readUint48LE(src); \
-	READ_DXT1_TEXEL(x)
+	const uint32 blockWidth  = MIN<uint32>(width , 4);
+	const uint32 blockHeight = MIN<uint32>(height, 4);
 
-void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
 	for (int32 ty = height; ty > 0; ty -= 4) {
-		for (uint32 tx = 0; tx < width; tx += 4) {
-			uint32 blended[4];
+		for (uint32 tx = 0; tx < width; tx += 4, src += kDXT35BlockSize) {
+			const uint32 alpha_0 = src[0];
+			const uint32 alpha_1 = src[1];
+
+			const uint64 alphabl = READ_LE_UINT32(src + 2) | ((uint64) READ_LE_UINT16(src + 6) << 32);
+
+			/* The divisions by 7 and 5 used to be done in floating point, with the
+			 * result truncated. That's the same as the integer division here. */
 			byte alphab[8];
-			DXT45Texel tex;
-			READ_DXT5_TEXEL(tex);
-
-			alphab[0] = tex.alpha_0;
-			alphab[1] = tex.alpha_1;
-
-			if (tex.alpha_0 > tex.alpha_1) {
-				alphab[2] = (byte)((6.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[3] = (byte)((5.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[4] = (byte)((4.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[5] = (byte)((3.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[6] = (byte)((2.0f * (double)alphab[0] + 5.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[7] = (byte)((1.0f * (double)alphab[0] + 6.0f * (double)alphab[1] + 3.0f) / 7.0f);
+
+			alphab[0] = alpha_0;
+			alphab[1] = alpha_1;
+
+			if (alpha_0 > alpha_1) {
+				alphab[2] = (6 * alpha_0 + 1 * alpha_1 + 3) / 7;
+				alphab[3] = (5 * alpha_0 + 2 * alpha_1 + 3) / 7;
+				alphab[4] = (4 * alpha_0 + 3 * alpha_1 + 3) / 7;
+				alphab[5] = (3 * alpha_0 + 4 * alpha_1 + 3) / 7;
+				alphab[6] = (2 * alpha_0 + 5 * alpha_1 + 3) / 7;
+				alphab[7] = (1 * alpha_0 + 6 * alpha_1 + 3) / 7;
 			} else {
-				alphab[2] = (byte)((4.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[3] = (byte)((3.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[4] = (byte)((2.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[5] = (byte)((1.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 2.0f) / 5.0f);
+				alphab[2] = (4 * alpha_0 + 1 * alpha_1 + 2) / 5;
+				alphab[3] = (3 * alpha_0 + 2 * alpha_1 + 2) / 5;
+				alphab[4] = (2 * alpha_0 + 3 * alpha_1 + 2) / 5;
+				alphab[5] = (1 * alpha_0 + 4 * alpha_1 + 2) / 5;
 				alphab[6] = 0;
 				alphab[7] = 255;
 			}
 
-			blended[0] = convert565To8888(tex.color_0) & 0xFFFFFF00;
-			blended[1] = convert565To8888(tex.color_1) & 0xFFFFFF00;
-			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
-
-			uint32 cpx = tex.pixels;
-			uint32 blockWidth = MIN<uint32>(width, 4);
-			uint32 blockHeight = MIN<uint32>(height, 4);
+			uint32 colors[4];
+			readColors(tables, src + 8, false, colors);
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32 destX = tx + x;
-					const uint32 destY = height - 1 - (ty - blockHeight + y);
+			byte pixels[16 * 4];
+			byte *pixel = pixels;
 
-					const uint32 alpha = alphab[(tex.alphabl >> (3 * (4 * (3 - y) + x))) & 7];
-					const uint32 pixel = blended[cpx & 3] | alpha;
+			uint32 cpx = READ_BE_UINT32(src + 12);
+			for (uint32 y = 0; y < blockHeight; ++y) {
+				const uint32 alpha = alphabl >> (3 * (4 * (3 - y)));
 
-					cpx >>= 2;
-
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
+				for (uint32 x = 0; x < blockWidth; ++x, cpx >>= 2, pixel += 4)
+					WRITE_BE_UINT32(pixel, colors[cpx & 3] | alphab[(alpha >> (3 * x)) & 7]);
 			}
+
+			writeBlock(dest, pixels, tx, ty, width, height, pitch, blockWidth, blockHeight);
 		}
 	}
 }
 
+void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
+	const size_t size = getDataSize(width, height, kDXT1BlockSize);
+
+	Common::ScopedArray<byte> buffer;
+	decompressDXT1(dest, getData(src, size, buffer), size, width, height, pitch);
+}
+
+void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
+	const size_t size = getDataSize(width, height, kDXT35BlockSize);
+
+	Common::ScopedArray<byte> buffer;
+	decompressDXT3(dest, getData(src, size, buffer), size, width, height, pitch);
+}
+
+void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
+	const size_t size = getDataSize(width, height, kDXT35BlockSize);
+
+	Common::ScopedArray<byte> buffer;
+	decompressDXT5(dest, getData(src, size, buffer), size, width, height, pitch);
+}
+
 } // End of namespace Images
@@ -33,6 +33,17 @@ namespace Common {
 
 namespace Images {
 
+/** Decompress DXTn data into R8G8B8A8 pixels.
+ *
+ *  The compressed blocks are read out of the src buffer of the given size;
+ *  an exception is thrown if that's too small for an image of these
+ *  dimensions.
+ */
+void decompressDXT1(byte *dest, const byte *src, size_t size, uint32 width, uint32 height, uint32 pitch);
+void decompressDXT3(byte *dest, const byte *src, size_t size, uint32 width, uint32 height, uint32 pitch);
+void decompressDXT5(byte *dest, const byte *src, size_t size, uint32 width, uint32 height, uint32 pitch);
+
+/** Decompress DXTn data read from a stream into R8G8B8A8 pixels. */
 void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
 void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
 void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
@@ -41,14 +41,22 @@ static const byte kEncodingSwizzledBGRA = 0x0C;
 
 namespace Images {
 
-TPC::TPC(Common::SeekableReadStream &tpc) : _txiDataSize(0) {
-	load(tpc);
+TPC::TPC(Common::SeekableReadStream &tpc, int mipMap, size_t threads) : _txiDataSize(0) {
+	load(tpc, mipMap, threads);
+}
+
+TPC::TPC(Common::SeekableReadStream *tpc, int mipMap, size_t threads) : _txiDataSize(0) {
+	assert(tpc);
+
+	_stream.reset(tpc);
+
+	load(*tpc, mipMap, threads);
 }
 
 TPC::~TPC() {
 }
 
-void TPC::load(Common::SeekableReadStream &tpc) {
+void TPC::load(Common::SeekableReadStream &tpc, int mipMap, size_t threads) {
 	try {
 
 		byte encoding;
@@ -56,7 +64,9 @@ void TPC::load(Common::SeekableReadStream &tpc) {
 		readHeader (tpc, encoding);
 		readData   (tpc, encoding);
 
-		fixupCubeMap();
+		dropUnusedMipMaps(mipMap);
+
+		fixupCubeMap(threads);
 
 	} catch (Common::Exception &e) {
 		e.add("Failed reading TPC file");
@@ -64,7 +74,7 @@ void TPC::load(Common::SeekableReadStream &tpc) {
 	}
 
 	// In xoreos-tools, we always want decompressed images
-	decompress();
+	decompress(threads);
 }
 
 Common::SeekableReadStream *TPC::getTXI() const {
@@ -289,19 +299,6 @@ bool TPC::checkAnimated(uint32 &width, uint32 &height, uint32 &dataSize) {
 	return true;
 }
 
-void TPC::deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height) {
-	for (uint32 y = 0; y < height; y++) {
-		for (uint32 x = 0; x < width; x++) {
-			const uint32 offset = deSwizzleOffset(x, y, width, height) * 4;
-
-			*dst++ = src[offset + 0];
-			*dst++ = src[offset + 1];
-			*dst++ = src[offset + 2];
-			*dst++ = src[offset + 3];
-		}
-	}
-}
-
 void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
 
@@ -309,31 +306,30 @@ void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 		const bool widthPOT = ((*mipMap)->width & ((*mipMap)->width - 1)) == 0;
 		const bool swizzled = (encoding == kEncodingSwizzledBGRA) && widthPOT;
 
-		(*mipMap)->data.reset(new byte[(*mipMap)->size]);
-
 		if (swizzled) {
 			std::vector<byte> tmp((*mipMap)->size);
 
 			if (tpc.read(&tmp[0], (*mipMap)->size) != (*mipMap)->size)
 				throw Common::Exception(Common::kReadError);
 
-			deSwizzle((*mipMap)->data.get(), &tmp[0], (*mipMap)->width, (*mipMap)->height);
+			(*mipMap)->data.reset(new byte[(*mipMap)->size]);
+			deSwizzle((*mipMap)->data.get(), &tmp[0], (*mipMap)->width, (*mipMap)->height, 4);
+
+		} else if (encoding == kEncodingGray) {
+			// Unpacking 8bpp grayscale data into RGB
 
-		} else {
-			if (tpc.read((*mipMap)->data.get(), (*mipMap)->size) != (*mipMap)->size)
+			Common::ScopedArray<byte> dataGray(new byte[(*mipMap)->size]);
+			if (tpc.read(dataGray.get(), (*mipMap)->size) != (*mipMap)->size)
 				throw Common::Exception(Common::kReadError);
 
-			// Unpacking 8bpp grayscale data into RGB
-			if (encoding == kEncodingGray) {
-				Common::ScopedArray<byte> dataGray((*mipMap)->data.release());
+			(*mipMap)->size = (*mipMap)->width * (*mipMap)->height * 3;
+			(*mipMap)->data.reset(new byte[(*mipMap)->size]);
 
-				(*mipMap)->size = (*mipMap)->width * (*mipMap)->height * 3;
-				(*mipMap)->data.reset(new byte[(*mipMap)->size]);
+			for (int i = 0; i < ((*mipMap)->width * (*mipMap)->height); i++)
+				std::memset((*mipMap)->data.get() + i * 3, dataGray[i], 3);
 
-				for (int i = 0; i < ((*mipMap)->width * (*mipMap)->height); i++)
-					std::memset((*mipMap)->data.get() + i * 3, dataGray[i], 3);
-			}
-		}
+		} else
+			readMipMapData(tpc, **mipMap);
 
 	}
 }
@@ -397,7 +393,7 @@ PixelFormat TPC::getPixelFormat(bool uncompressed, byte encoding) {
 	throw Common::Exception("Unknown TPC encoding: %d", encoding);
 }
 
-void TPC::fixupCubeMap() {
+void TPC::fixupCubeMap(size_t threads) {
 	/* Do various fixups to the cube maps. This includes rotating and swapping a
 	 * few sides around. This is done by the original games as well.
 	 */
@@ -427,7 +423,7 @@ void TPC::fixupCubeMap() {
 	}
 
 	// Since we need to rotate the individual cube sides, we need to decompress them all
-	decompress();
+	decompress(threads);
 
 	// Rotate the cube sides so that they're all oriented correctly
 	for (size_t i = 0; i < getLayerCount(); i++) {
@@ -439,7 +435,7 @@ void TPC::fixupCubeMap() {
 
 			static const int rotation[6] = { 3, 1, 0, 2, 2, 0 };
 
-			rotate90(mipMap.data.get(), mipMap.width, mipMap.height, getBPP(_format), rotation[i]);
+			rotate90(mipMap.getWritableData(), mipMap.width, mipMap.height, getBPP(_format), rotation[i]);
 		}
 	}
 
@@ -452,7 +448,7 @@ void TPC::fixupCubeMap() {
 		MipMap &mipMap0 = *_mipMaps[index0];
 		MipMap &mipMap1 = *_mipMaps[index1];
 
-		mipMap0.data.swap(mipMap1.data);
+		mipMap0.swap(mipMap1);
 	}
 }
 
@@ -43,7 +43,19 @@ namespace Images {
  */
 class TPC : public Decoder {
 public:
-	TPC(Common::SeekableReadStream &tpc);
+	/** Read a TPC out of this stream.
+	 *
+	 *  Only the mip map level mipMap of each layer is loaded, or all of
+	 *  them for -1. See Decoder::dropUnusedMipMaps(). The image is
+	 *  decompressed with this many threads, see Decoder::decompress().
+	 */
+	TPC(Common::SeekableReadStream &tpc, int mipMap = -1, size_t threads = 1);
+	/** Take over this stream and read a TPC out of it.
+	 *
+	 *  If the stream's data is directly available in memory, mip maps that
+	 *  need no conversion use that memory instead of copying it.
+	 */
+	TPC(Common::SeekableReadStream *tpc, int mipMap = -1, size_t threads = 1);
 	~TPC();
 
 	/** Return the enclosed TXI data. */
@@ -56,7 +68,7 @@ private:
 	bool _isAnimated;
 
 	// Loading helpers
-	void load(Common::SeekableReadStream &tpc);
+	void load(Common::SeekableReadStream &tpc, int mipMap, size_t threads);
 	void readHeader(Common::SeekableReadStream &tpc, byte &encoding);
 	void readData(Common::SeekableReadStream &tpc, byte encoding);
 	void readTXIData(Common::SeekableReadStream &tpc);
@@ -66,9 +78,7 @@ private:
 
 	bool checkAnimated(uint32 &width, uint32 &height, uint32 &dataSize);
 	bool checkCubeMap(uint32 &width, uint32 &height);
-	void fixupCubeMap();
-
-	static void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height);
+	void fixupCubeMap(size_t threads);
 };
 
 } // End of namespace Images
@@ -22,6 +22,8 @@
  *  TXB (another one of BioWare's own texture formats) loading.
  */
 
+#include <cassert>
+
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
@@ -36,17 +38,28 @@ static const byte kEncodingDXT5 = 0x0C;
 
 namespace Images {
 
-TXB::TXB(Common::SeekableReadStream &txb) : _dataSize(0), _txiDataSize(0) {
-	load(txb);
+TXB::TXB(Common::SeekableReadStream &txb, int mipMap, size_t threads) : _dataSize(0), _txiDataSize(0) {
+	load(txb, mipMap);
+
+	// In xoreos-tools, we always want decompressed images
+	decompress(threads);
+}
+
+TXB::TXB(Common::SeekableReadStream *txb, int mipMap, size_t threads) : _dataSize(0), _txiDataSize(0) {
+	assert(txb);
+
+	_stream.reset(txb);
+
+	load(*txb, mipMap);
 
 	// In xoreos-tools, we always want decompressed images
-	decompress();
+	decompress(threads);
 }
 
 TXB::~TXB() {
 }
 
-void TXB::load(Common::SeekableReadStream &txb) {
+void TXB::load(Common::SeekableReadStream &txb, int mipMap) {
 	try {
 
 		byte encoding;
@@ -58,6 +71,8 @@ void TXB::load(Common::SeekableReadStream &txb) {
 
 		readTXIData(txb);
 
+		dropUnusedMipMaps(mipMap);
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading TXB file");
 		throw;
@@ -159,17 +174,6 @@ void TXB::readHeader(Common::SeekableReadStream &txb, byte &encoding) {
 		throw Common::Exception("Couldn't read any mip maps");
 }
 
-void TXB::deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint8 bpp) {
-	for (uint32 y = 0; y < height; y++) {
-		for (uint32 x = 0; x < width; x++) {
-			const uint32 offset = deSwizzleOffset(x, y, width, height) * bpp;
-
-			for (uint8 p = 0; p < bpp; p++)
-				*dst++ = src[offset + p];
-		}
-	}
-}
-
 void TXB::readData(Common::SeekableReadStream &txb, byte encoding) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
 		const bool needDeSwizzle = (encoding == kEncodingBGRA) || (encoding == kEncodingGray);
@@ -178,6 +182,12 @@ void TXB::readData(Common::SeekableReadStream &txb, byte encoding) {
 		const bool widthPOT = ((*mipMap)->width & ((*mipMap)->width - 1)) == 0;
 		const bool swizzled = needDeSwizzle && widthPOT;
 
+		// Data that doesn't need any conversion can be used directly
+		if ((encoding != kEncodingGray) && !swizzled) {
+			readMipMapData(txb, **mipMap);
+			continue;
+		}
+
 		(*mipMap)->data.reset(new byte[(*mipMap)->size]);
 		if (txb.read((*mipMap)->data.get(), (*mipMap)->size) != (*mipMap)->size)
 			throw Common::Exception(Common::kReadError);
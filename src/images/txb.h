@@ -45,7 +45,19 @@ namespace Images {
  */
 class TXB : public Decoder {
 public:
-	TXB(Common::SeekableReadStream &txb);
+	/** Read a TXB out of this stream.
+	 *
+	 *  Only the mip map level mipMap of each layer is loaded, or all of
+	 *  them for -1. See Decoder::dropUnusedMipMaps(). The image is
+	 *  decompressed with this many threads, see Decoder::decompress().
+	 */
+	TXB(Common::SeekableReadStream &txb, int mipMap = -1, size_t threads = 1);
+	/** Take over this stream and read a TXB out of it.
+	 *
+	 *  If the stream's data is directly available in memory, mip maps that
+	 *  need no conversion use that memory instead of copying it.
+	 */
+	TXB(Common::SeekableReadStream *txb, int mipMap = -1, size_t threads = 1);
 	~TXB();
 
 	/** Return the enclosed TXI data. */
@@ -58,12 +70,10 @@ private:
 	size_t _txiDataSize;
 
 	// Loading helpers
-	void load(Common::SeekableReadStream &txb);
+	void load(Common::SeekableReadStream &txb, int mipMap);
 	void readHeader(Common::SeekableReadStream &txb, byte &encoding);
 	void readData(Common::SeekableReadStream &txb, byte encoding);
 	void readTXIData(Common::SeekableReadStream &txb);
-
-	static void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint8 bpp);
 };
 
 } // End of namespace Images
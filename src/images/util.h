@@ -28,6 +28,8 @@
 #include <cassert>
 #include <cstring>
 
+#include <vector>
+
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/util.h"
@@ -233,6 +235,35 @@ static inline uint32 deSwizzleOffset(uint32 x, uint32 y, uint32 width, uint32 he
 	return offset;
 }
 
+/** De-"swizzle" a whole texture with pixels of bpp bytes each.
+ *
+ *  The swizzled offset of a pixel is made up of interleaved bits of its x
+ *  and y coordinates, so it is the sum of one part that only depends on x
+ *  and one part that only depends on y. Instead of calling deSwizzleOffset()
+ *  for every single pixel, both parts are only calculated once per column
+ *  and row, respectively.
+ */
+static inline void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint32 bpp) {
+	std::vector<uint32> offsetX(width), offsetY(height);
+
+	for (uint32 x = 0; x < width; x++)
+		offsetX[x] = deSwizzleOffset(x, 0, width, height) * bpp;
+	for (uint32 y = 0; y < height; y++)
+		offsetY[y] = deSwizzleOffset(0, y, width, height) * bpp;
+
+	for (uint32 y = 0; y < height; y++) {
+		const byte *row = src + offsetY[y];
+
+		if (bpp == 4) {
+			for (uint32 x = 0; x < width; x++, dst += 4)
+				std::memcpy(dst, row + offsetX[x], 4);
+		} else {
+			for (uint32 x = 0; x < width; x++, dst += bpp)
+				std::memcpy(dst, row + offsetX[x], bpp);
+		}
+	}
+}
+
 } // End of namespace Images
 
 #endif // IMAGES_UTIL_H
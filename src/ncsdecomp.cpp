@@ -30,6 +30,7 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/bufferedreadstream.h"
 #include "src/common/writefile.h"
 #include "src/common/stdoutstream.h"
 #include "src/common/cli.h"
@@ -116,7 +117,7 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 }
 
 void decNCS(const Common::UString &inFile, const Common::UString &outFile, Aurora::GameID &game) {
-	Common::ScopedPtr<Common::SeekableReadStream> ncs(new Common::ReadFile(inFile));
+	Common::ScopedPtr<Common::SeekableReadStream> ncs(new Common::BufferedReadStream(new Common::ReadFile(inFile), true));
 	Common::ScopedPtr<Common::WriteStream> out(openFileOrStdOut(outFile));
 
 	status("Decompiling script...");
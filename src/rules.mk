@@ -135,6 +135,7 @@ src_unerf_SOURCES = \
     $(EMPTY)
 src_unerf_LDADD = \
     src/archives/libarchives.la \
+    src/images/libimages.la \
     src/aurora/libaurora.la \
     src/common/libcommon.la \
     src/version/libversion.la \
@@ -174,6 +175,7 @@ src_unkeybif_SOURCES = \
     $(EMPTY)
 src_unkeybif_LDADD = \
     src/archives/libarchives.la \
+    src/images/libimages.la \
     src/aurora/libaurora.la \
     src/common/libcommon.la \
     src/version/libversion.la \
@@ -30,16 +30,23 @@
 
 #include "src/version/version.h"
 
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/common/md5.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/util.h"
 #include "src/aurora/erffile.h"
+#include "src/aurora/indexcache.h"
+
+#include "src/images/convert.h"
 
 #include "src/archives/util.h"
 
@@ -57,13 +64,19 @@ enum Command {
 
 const char *kCommandChar[kCommandMAX] = { "i", "l", "v", "e", "x" };
 
+static const uint32 kIndexERF = MKTAG('E', 'R', 'F', ' ');
+
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive, std::set<Common::UString> &files,
-                      Aurora::GameID &game, std::vector<byte> &password);
+                      Aurora::GameID &game, std::vector<byte> &password, uint32_t &threads,
+                      Common::UString &indexCacheDir, bool &convertTextures);
 
 bool parsePassword(const Common::UString &arg, std::vector<byte> &password);
 bool readNWMMD5   (const Common::UString &arg, std::vector<byte> &password);
 
+Aurora::ERFFile *openERF(const Common::UString &archive, const std::vector<byte> &password,
+                         const Aurora::IndexCache *indexCache);
+
 void displayInfo(Aurora::ERFFile &erf);
 
 int main(int argc, char **argv) {
@@ -80,23 +93,43 @@ int main(int argc, char **argv) {
 		Common::UString archive;
 		std::set<Common::UString> files;
 		std::vector<byte> password;
+		uint32_t threads = 1;
+		Common::UString indexCacheDir;
+		bool convertTextures = false;
 
-		if (!parseCommandLine(args, returnValue, command, archive, files, game, password))
+		if (!parseCommandLine(args, returnValue, command, archive, files, game, password, threads,
+		                      indexCacheDir, convertTextures))
 			return returnValue;
 
-		Aurora::ERFFile erf(new Common::ReadFile(archive), password);
+		Common::ScopedPtr<Aurora::IndexCache> indexCache;
+		if (!indexCacheDir.empty())
+			indexCache.reset(new Aurora::IndexCache(indexCacheDir));
+
+		Common::ScopedPtr<Aurora::ERFFile> erf(openERF(archive, password, indexCache.get()));
 		files = Archives::fixPathSeparator(files);
 
+		Archives::ArchiveOpener opener = [&archive, &password, &indexCache]() {
+			return openERF(archive, password, indexCache.get());
+		};
+
+		Archives::ResourceConverter converter;
+		if (convertTextures) {
+			converter = Archives::ResourceConverter(Images::getTGAName,
+				[](Common::SeekableReadStream &stream, Aurora::FileType type, const Common::UString &tgaFile) {
+					Images::convertToTGA(stream, type, tgaFile);
+				});
+		}
+
 		if      (command == kCommandInfo)
-			displayInfo(erf);
+			displayInfo(*erf);
 		else if (command == kCommandList)
-			Archives::listFiles(erf, game, false);
+			Archives::listFiles(*erf, game, false);
 		else if (command == kCommandListVerbose)
-			Archives::listFiles(erf, game, true);
+			Archives::listFiles(*erf, game, true);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(erf, game, false, files);
+			Archives::extractFiles(*erf, game, false, files, threads, opener, converter);
 		else if (command == kCommandExtractDir)
-			Archives::extractFiles(erf, game, true, files);
+			Archives::extractFiles(*erf, game, true, files, threads, opener, converter);
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -162,7 +195,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive, std::set<Common::UString> &files,
-                      Aurora::GameID &game, std::vector<byte> &password) {
+                      Aurora::GameID &game, std::vector<byte> &password, uint32_t &threads,
+                      Common::UString &indexCacheDir, bool &convertTextures) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -202,10 +236,43 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	                 "Neverwinter Nights premium module file(for decrypting their HAK file)",
 	                 kContinueParsing,
 	                 new Callback<std::vector<byte> &>("file", readNWMMD5, password));
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Extract with this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(threads, "n"));
+	parser.addOption("index-cache", "Cache the parsed ERF index in this directory",
+	                 kContinueParsing, new ValGetter<Common::UString &>(indexCacheDir, "dir"));
+	parser.addSpace();
+	parser.addOption("tga", "Convert textures into TGA while extracting",
+	                 kContinueParsing, makeAssigners(new ValAssigner<bool>(true, convertTextures)));
 
 	return parser.process(argv);
 }
 
+Aurora::ERFFile *openERF(const Common::UString &archive, const std::vector<byte> &password,
+                         const Aurora::IndexCache *indexCache) {
+
+	// Encrypted ERFs are never cached
+	if (!indexCache || !password.empty())
+		return new Aurora::ERFFile(new Common::MappedReadStream(archive), password);
+
+	Common::ScopedPtr<Common::SeekableReadStream> index(indexCache->getIndex(archive, kIndexERF));
+	if (index) {
+		try {
+			return new Aurora::ERFFile(new Common::MappedReadStream(archive), *index);
+		} catch (...) {
+			Common::exceptionDispatcherWarnAndIgnore("Ignoring the cached index of \"" + archive + "\"");
+		}
+	}
+
+	Common::ScopedPtr<Aurora::ERFFile> erf(new Aurora::ERFFile(new Common::MappedReadStream(archive), password));
+
+	Common::MemoryWriteStreamDynamic newIndex(true);
+	if (erf->writeIndex(newIndex))
+		indexCache->putIndex(archive, kIndexERF, newIndex);
+
+	return erf.release();
+}
+
 void displayInfo(Aurora::ERFFile &erf) {
 	std::printf("Version: %s\n", Common::debugTag(erf.getVersion()).c_str());
 	std::printf("Build Year: %d\n", erf.getBuildYear());
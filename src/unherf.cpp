@@ -28,14 +28,18 @@
 
 #include "src/version/version.h"
 
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
+#include "src/common/mappedreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/util.h"
 #include "src/aurora/herffile.h"
+#include "src/aurora/indexcache.h"
 
 #include "src/archives/util.h"
 
@@ -50,8 +54,13 @@ enum Command {
 
 const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
+static const uint32 kIndexHERF = MKTAG('H', 'E', 'R', 'F');
+
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, Common::UString &archive, std::set<Common::UString> &files);
+                      Command &command, Common::UString &archive, std::set<Common::UString> &files,
+                      uint32_t &threads, Common::UString &indexCacheDir);
+
+Aurora::HERFFile *openHERF(const Common::UString &archive, const Aurora::IndexCache *indexCache);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -64,17 +73,27 @@ int main(int argc, char **argv) {
 		Command command = kCommandNone;
 		Common::UString archive;
 		std::set<Common::UString> files;
+		uint32_t threads = 1;
+		Common::UString indexCacheDir;
 
-		if (!parseCommandLine(args, returnValue, command, archive, files))
+		if (!parseCommandLine(args, returnValue, command, archive, files, threads, indexCacheDir))
 			return returnValue;
 
-		Aurora::HERFFile herf(new Common::ReadFile(archive));
+		Common::ScopedPtr<Aurora::IndexCache> indexCache;
+		if (!indexCacheDir.empty())
+			indexCache.reset(new Aurora::IndexCache(indexCacheDir));
+
+		Common::ScopedPtr<Aurora::HERFFile> herf(openHERF(archive, indexCache.get()));
 		files = Archives::fixPathSeparator(files);
 
+		Archives::ArchiveOpener opener = [&archive, &indexCache]() {
+			return openHERF(archive, indexCache.get());
+		};
+
 		if      (command == kCommandList)
-			Archives::listFiles(herf, Aurora::kGameIDUnknown, false);
+			Archives::listFiles(*herf, Aurora::kGameIDUnknown, false);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(herf, Aurora::kGameIDUnknown, false, files);
+			Archives::extractFiles(*herf, Aurora::kGameIDUnknown, false, files, threads, opener);
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -100,9 +119,11 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, Common::UString &archive, std::set<Common::UString> &files) {
+                      Command &command, Common::UString &archive, std::set<Common::UString> &files,
+                      uint32_t &threads, Common::UString &indexCacheDir) {
 
 	using Common::CLI::NoOption;
+	using Common::CLI::kContinueParsing;
 	using Common::CLI::Parser;
 	using Common::CLI::ValGetter;
 	using Common::CLI::makeEndArgs;
@@ -117,5 +138,33 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	              returnValue,
 	              makeEndArgs(&cmdOpt, &archiveOpt, &filesOpt));
 
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Extract with this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(threads, "n"));
+	parser.addOption("index-cache", "Cache the parsed HERF index in this directory",
+	                 kContinueParsing, new ValGetter<Common::UString &>(indexCacheDir, "dir"));
+
 	return parser.process(argv);
 }
+
+Aurora::HERFFile *openHERF(const Common::UString &archive, const Aurora::IndexCache *indexCache) {
+	if (!indexCache)
+		return new Aurora::HERFFile(new Common::MappedReadStream(archive));
+
+	Common::ScopedPtr<Common::SeekableReadStream> index(indexCache->getIndex(archive, kIndexHERF));
+	if (index) {
+		try {
+			return new Aurora::HERFFile(new Common::MappedReadStream(archive), *index);
+		} catch (...) {
+			Common::exceptionDispatcherWarnAndIgnore("Ignoring the cached index of \"" + archive + "\"");
+		}
+	}
+
+	Common::ScopedPtr<Aurora::HERFFile> herf(new Aurora::HERFFile(new Common::MappedReadStream(archive)));
+
+	Common::MemoryWriteStreamDynamic newIndex(true);
+	herf->writeIndex(newIndex);
+	indexCache->putIndex(archive, kIndexHERF, newIndex);
+
+	return herf.release();
+}
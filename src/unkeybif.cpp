@@ -31,12 +31,16 @@
 #include "src/version/version.h"
 
 #include "src/common/ptrvector.h"
+#include "src/common/scopedptr.h"
 #include "src/common/util.h"
 #include "src/common/ustring.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/bufferedreadstream.h"
+#include "src/common/mappedreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/common/filepath.h"
 #include "src/common/cli.h"
 
@@ -45,6 +49,9 @@
 #include "src/aurora/keydatafile.h"
 #include "src/aurora/biffile.h"
 #include "src/aurora/bzffile.h"
+#include "src/aurora/indexcache.h"
+
+#include "src/images/convert.h"
 
 #include "src/archives/util.h"
 
@@ -59,21 +66,31 @@ enum Command {
 
 const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
+static const uint32 kIndexKEY = MKTAG('K', 'E', 'Y', ' ');
+
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game);
+                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game,
+                      uint32_t &threads, Common::UString &indexCacheDir, bool &convertTextures);
 
 uint32 getFileID(const Common::UString &fileName);
 void identifyFiles(const std::list<Common::UString> &files, std::vector<Common::UString> &keyFiles,
                    std::vector<Common::UString> &bifFiles);
 
-void openKEYs(const std::vector<Common::UString> &keyFiles, Common::PtrVector<Aurora::KEYFile> &keys);
+Aurora::KEYFile *openKEY(const Common::UString &keyFile, const Aurora::IndexCache *indexCache);
+void openKEYs(const std::vector<Common::UString> &keyFiles, Common::PtrVector<Aurora::KEYFile> &keys,
+              const Aurora::IndexCache *indexCache);
+Aurora::KEYDataFile *openKEYDataFile(const Common::UString &dataFile);
 void openKEYDataFiles(const std::vector<Common::UString> &dataFiles, Common::PtrVector<Aurora::KEYDataFile> &keyData);
 
+void mergeKEYDataFile(const Common::PtrVector<Aurora::KEYFile> &keys, Aurora::KEYDataFile &keyData,
+                      const Common::UString &dataFile);
 void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVector<Aurora::KEYDataFile> &keyData,
                        const std::vector<Common::UString> &dataFiles);
 
 void listFiles(const Common::PtrVector<Aurora::KEYFile> &keys, const std::vector<Common::UString> &keyFiles, Aurora::GameID game);
-void extractFiles(const Common::PtrVector<Aurora::KEYDataFile> &keyData, const std::vector<Common::UString> &dataFiles, Aurora::GameID game);
+void extractFiles(const Common::PtrVector<Aurora::KEYFile> &keys, const Common::PtrVector<Aurora::KEYDataFile> &keyData,
+                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game, uint32_t threads,
+                  bool convertTextures);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -87,17 +104,24 @@ int main(int argc, char **argv) {
 		int returnValue = 1;
 		Command command = kCommandNone;
 		std::list<Common::UString> files;
+		uint32_t threads = 1;
+		Common::UString indexCacheDir;
+		bool convertTextures = false;
 
-		if (!parseCommandLine(args, returnValue, command, files, game))
+		if (!parseCommandLine(args, returnValue, command, files, game, threads, indexCacheDir, convertTextures))
 			return returnValue;
 
+		Common::ScopedPtr<Aurora::IndexCache> indexCache;
+		if (!indexCacheDir.empty())
+			indexCache.reset(new Aurora::IndexCache(indexCacheDir));
+
 		std::vector<Common::UString> keyFiles, dataFiles;
 		identifyFiles(files, keyFiles, dataFiles);
 
 		Common::PtrVector<Aurora::KEYFile> keys;
 		Common::PtrVector<Aurora::KEYDataFile> keyData;
 
-		openKEYs(keyFiles, keys);
+		openKEYs(keyFiles, keys, indexCache.get());
 		openKEYDataFiles(dataFiles, keyData);
 
 		mergeKEYDataFiles(keys, keyData, dataFiles);
@@ -105,7 +129,7 @@ int main(int argc, char **argv) {
 		if      (command == kCommandList)
 			listFiles(keys, keyFiles, game);
 		else if (command == kCommandExtract)
-			extractFiles(keyData, dataFiles, game);
+			extractFiles(keys, keyData, dataFiles, game, threads, convertTextures);
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -131,7 +155,8 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game) {
+                      Command &command, std::list<Common::UString> &files, Aurora::GameID &game,
+                      uint32_t &threads, Common::UString &indexCacheDir, bool &convertTextures) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::Parser;
@@ -161,6 +186,15 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("jade", "Alias file types according to Jade Empire rules",
 	                 Common::CLI::kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::GameID>(Aurora::kGameIDJade, game)));
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Extract with this many threads (0: one per CPU core)",
+	                 Common::CLI::kContinueParsing, new ValGetter<uint32_t &>(threads, "n"));
+	parser.addOption("index-cache", "Cache the parsed KEY indices in this directory",
+	                 Common::CLI::kContinueParsing, new ValGetter<Common::UString &>(indexCacheDir, "dir"));
+	parser.addSpace();
+	parser.addOption("tga", "Convert textures into TGA while extracting",
+	                 Common::CLI::kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, convertTextures)));
 
 	return parser.process(argv);
 }
@@ -189,45 +223,69 @@ void identifyFiles(const std::list<Common::UString> &files, std::vector<Common::
 	}
 }
 
-void openKEYs(const std::vector<Common::UString> &keyFiles, Common::PtrVector<Aurora::KEYFile> &keys) {
-	keys.reserve(keyFiles.size());
+Aurora::KEYFile *openKEY(const Common::UString &keyFile, const Aurora::IndexCache *indexCache) {
+	if (indexCache) {
+		Common::ScopedPtr<Common::SeekableReadStream> index(indexCache->getIndex(keyFile, kIndexKEY));
+		if (index) {
+			try {
+				return Aurora::KEYFile::readIndex(*index);
+			} catch (...) {
+				Common::exceptionDispatcherWarnAndIgnore("Ignoring the cached index of \"" + keyFile + "\"");
+			}
+		}
+	}
 
-	for (std::vector<Common::UString>::const_iterator f = keyFiles.begin(); f != keyFiles.end(); ++f) {
-		Common::ReadFile key(*f);
+	Common::BufferedReadStream keyStream(new Common::ReadFile(keyFile), true);
+	Common::ScopedPtr<Aurora::KEYFile> key(new Aurora::KEYFile(keyStream));
 
-		keys.push_back(new Aurora::KEYFile(key));
+	if (indexCache) {
+		Common::MemoryWriteStreamDynamic newIndex(true);
+		key->writeIndex(newIndex);
+
+		indexCache->putIndex(keyFile, kIndexKEY, newIndex);
 	}
+
+	return key.release();
+}
+
+void openKEYs(const std::vector<Common::UString> &keyFiles, Common::PtrVector<Aurora::KEYFile> &keys,
+              const Aurora::IndexCache *indexCache) {
+
+	keys.reserve(keyFiles.size());
+
+	for (std::vector<Common::UString>::const_iterator f = keyFiles.begin(); f != keyFiles.end(); ++f)
+		keys.push_back(openKEY(*f, indexCache));
+}
+
+Aurora::KEYDataFile *openKEYDataFile(const Common::UString &dataFile) {
+	if (Common::FilePath::getExtension(dataFile).equalsIgnoreCase(".bzf"))
+		return new Aurora::BZFFile(new Common::MappedReadStream(dataFile));
+
+	return new Aurora::BIFFile(new Common::MappedReadStream(dataFile));
 }
 
 void openKEYDataFiles(const std::vector<Common::UString> &dataFiles, Common::PtrVector<Aurora::KEYDataFile> &keyData) {
 	keyData.reserve(dataFiles.size());
 
-	for (std::vector<Common::UString>::const_iterator f = dataFiles.begin(); f != dataFiles.end(); ++f) {
-		if (Common::FilePath::getExtension(*f).equalsIgnoreCase(".bzf"))
-			keyData.push_back(new Aurora::BZFFile(new Common::ReadFile(*f)));
-		else
-			keyData.push_back(new Aurora::BIFFile(new Common::ReadFile(*f)));
-	}
+	for (std::vector<Common::UString>::const_iterator f = dataFiles.begin(); f != dataFiles.end(); ++f)
+		keyData.push_back(openKEYDataFile(*f));
 }
 
-void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVector<Aurora::KEYDataFile> &keyData,
-                       const std::vector<Common::UString> &dataFiles) {
+void mergeKEYDataFile(const Common::PtrVector<Aurora::KEYFile> &keys, Aurora::KEYDataFile &keyData,
+                      const Common::UString &dataFile) {
+
+	const Common::UString dataStem = Common::FilePath::getStem(dataFile);
 
 	// Go over all KEYs
-	for (Common::PtrVector<Aurora::KEYFile>::iterator k = keys.begin(); k != keys.end(); ++k) {
+	for (Common::PtrVector<Aurora::KEYFile>::const_iterator k = keys.begin(); k != keys.end(); ++k) {
 
 		// Go over all BIFs/BZFs handled by the KEY
 		const Aurora::KEYFile::BIFList &keyBifs = (*k)->getBIFs();
 		for (size_t kb = 0; kb < keyBifs.size(); kb++) {
 
-			// Go over all BIFs
-			for (size_t b = 0; b < dataFiles.size(); b++) {
-
-				// If they match, merge
-				if (Common::FilePath::getStem(keyBifs[kb]).equalsIgnoreCase(Common::FilePath::getStem(dataFiles[b])))
-					keyData[b]->mergeKEY(**k, kb);
-
-			}
+			// If they match, merge
+			if (Common::FilePath::getStem(keyBifs[kb]).equalsIgnoreCase(dataStem))
+				keyData.mergeKEY(**k, kb);
 
 		}
 
@@ -235,6 +293,14 @@ void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVect
 
 }
 
+void mergeKEYDataFiles(Common::PtrVector<Aurora::KEYFile> &keys, Common::PtrVector<Aurora::KEYDataFile> &keyData,
+                       const std::vector<Common::UString> &dataFiles) {
+
+	// Go over all BIFs
+	for (size_t b = 0; b < dataFiles.size(); b++)
+		mergeKEYDataFile(keys, *keyData[b], dataFiles[b]);
+}
+
 void listFiles(const Common::PtrVector<Aurora::KEYFile> &keys,
                const std::vector<Common::UString> &keyFiles, Aurora::GameID game) {
 
@@ -246,15 +312,32 @@ void listFiles(const Common::PtrVector<Aurora::KEYFile> &keys,
 	}
 }
 
-void extractFiles(const Common::PtrVector<Aurora::KEYDataFile> &keyData,
-                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game) {
+void extractFiles(const Common::PtrVector<Aurora::KEYFile> &keys, const Common::PtrVector<Aurora::KEYDataFile> &keyData,
+                  const std::vector<Common::UString> &dataFiles, Aurora::GameID game, uint32_t threads,
+                  bool convertTextures) {
+
+	Archives::ResourceConverter converter;
+	if (convertTextures) {
+		converter = Archives::ResourceConverter(Images::getTGAName,
+			[](Common::SeekableReadStream &stream, Aurora::FileType type, const Common::UString &tgaFile) {
+				Images::convertToTGA(stream, type, tgaFile);
+			});
+	}
 
 	for (size_t i = 0; i < keyData.size(); i++) {
 		std::printf("%s: %s indexed files (of %u)\n\n", dataFiles[i].c_str(),
 		            Common::composeString(keyData[i]->getResources().size()).c_str(),
                 keyData[i]->getInternalResourceCount());
 
-		Archives::extractFiles(*keyData[i], game, false, std::set<Common::UString>());
+		const Common::UString &dataFile = dataFiles[i];
+		Archives::ArchiveOpener opener = [&keys, &dataFile]() {
+			Common::ScopedPtr<Aurora::KEYDataFile> data(openKEYDataFile(dataFile));
+			mergeKEYDataFile(keys, *data, dataFile);
+
+			return data.release();
+		};
+
+		Archives::extractFiles(*keyData[i], game, false, std::set<Common::UString>(), threads, opener, converter);
 
 		if (i < (keyData.size() - 1))
 			std::printf("\n");
@@ -32,7 +32,7 @@
 #include "src/common/ustring.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
+#include "src/common/mappedreadstream.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/util.h"
@@ -72,7 +72,7 @@ int main(int argc, char **argv) {
 		if (!parseCommandLine(args, returnValue, command, archive, files))
 			return returnValue;
 
-		Aurora::NDSFile nds(new Common::ReadFile(archive));
+		Aurora::NDSFile nds(new Common::MappedReadStream(archive));
 		files = Archives::fixPathSeparator(files);
 
 		if      (command == kCommandInfo)
@@ -32,7 +32,7 @@
 #include "src/common/error.h"
 #include "src/common/platform.h"
 #include "src/common/cli.h"
-#include "src/common/readfile.h"
+#include "src/common/mappedreadstream.h"
 #include "src/common/scopedptr.h"
 
 #include "src/aurora/obbfile.h"
@@ -73,7 +73,7 @@ int main(int argc, char **argv) {
 		if (!parseCommandLine(args, returnValue, command, archive, files))
 			return returnValue;
 
-		Common::ScopedPtr<Common::SeekableReadStream> stream(new Common::ReadFile(archive));
+		Common::ScopedPtr<Common::SeekableReadStream> stream(new Common::MappedReadStream(archive));
 
 		Common::ScopedPtr<Aurora::Archive> arc;
 		if (isPKZIP(*stream))
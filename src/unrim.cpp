@@ -29,7 +29,7 @@
 #include "src/common/ustring.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
+#include "src/common/mappedreadstream.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/util.h"
@@ -50,7 +50,7 @@ const char *kCommandChar[kCommandMAX] = { "l", "e" };
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive,
-                      Aurora::GameID &game, std::set<Common::UString> &files);
+                      Aurora::GameID &game, std::set<Common::UString> &files, uint32_t &threads);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -65,17 +65,22 @@ int main(int argc, char **argv) {
 		Command command = kCommandNone;
 		Common::UString archive;
 		std::set<Common::UString> files;
+		uint32_t threads = 1;
 
-		if (!parseCommandLine(args, returnValue, command, archive, game, files))
+		if (!parseCommandLine(args, returnValue, command, archive, game, files, threads))
 			return returnValue;
 
-		Aurora::RIMFile rim(new Common::ReadFile(archive));
+		Aurora::RIMFile rim(new Common::MappedReadStream(archive));
 		files = Archives::fixPathSeparator(files);
 
+		Archives::ArchiveOpener opener = [&archive]() {
+			return new Aurora::RIMFile(new Common::MappedReadStream(archive));
+		};
+
 		if      (command == kCommandList)
 			Archives::listFiles(rim, game, false);
 		else if (command == kCommandExtract)
-			Archives::extractFiles(rim, game, false, files);
+			Archives::extractFiles(rim, game, false, files, threads, opener);
 
 	} catch (...) {
 		Common::exceptionDispatcherError();
@@ -102,7 +107,7 @@ int ValGetter<Command &>::get(const std::vector<Common::UString> &args, int i, i
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
                       Command &command, Common::UString &archive,
-                      Aurora::GameID &game, std::set<Common::UString> &files) {
+                      Aurora::GameID &game, std::set<Common::UString> &files, uint32_t &threads) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -129,6 +134,9 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addOption("jade", "Alias file types according to Jade Empire rules",
 	                 kContinueParsing,
 	                 makeAssigners(new ValAssigner<Aurora::GameID>(Aurora::kGameIDJade, game)));
+	parser.addSpace();
+	parser.addOption("jobs", 'j', "Extract with this many threads (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(threads, "n"));
 
 	return parser.process(argv);
 }
@@ -29,7 +29,7 @@
 #include "src/common/ustring.h"
 #include "src/common/error.h"
 #include "src/common/platform.h"
-#include "src/common/readfile.h"
+#include "src/common/mappedreadstream.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/thewitchersavefile.h"
@@ -65,7 +65,7 @@ int main(int argc, char **argv) {
 		if (!parseCommandLine(args, returnValue, command, archive, files))
 			return returnValue;
 
-		Aurora::TheWitcherSaveFile tws(new Common::ReadFile(archive));
+		Aurora::TheWitcherSaveFile tws(new Common::MappedReadStream(archive));
 		files = Archives::fixPathSeparator(files);
 
 		if      (command == kCommandList)
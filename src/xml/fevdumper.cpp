@@ -52,6 +52,8 @@ void FEVDumper::dump(Common::WriteStream &output, Common::SeekableReadStream &in
 	dumpReverbs(xml, reverbs);
 
 	xml.closeTag();
+
+	xml.flush();
 }
 
 void FEVDumper::dumpWavebanks(XML::XMLWriter &xml, const std::vector<Sound::FMODEventFile::WaveBank> &waveBanks) {
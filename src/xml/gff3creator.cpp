@@ -29,208 +29,193 @@
 
 namespace XML {
 
-void GFF3Creator::create(const XML::XMLNode &root, uint32 id, Common::WriteStream &file, uint32 version) {
+/** Read the float components of a vector or an orientation. */
+static void readComponents(XMLReader &xml, float *components, size_t count, const char *type) {
+	const size_t depth = xml.getDepth();
+
+	size_t n = 0;
+	while (xml.readChild(depth)) {
+		if (n >= count)
+			throw Common::Exception("GFF3Creator::readStructContents() Invalid size of %s components", type);
+
+		const Common::UString text = xml.readText();
+		if (text.empty())
+			throw Common::Exception("GFF3Creator::readStructContents() Empty %s component", type);
+
+		Common::parseString(text, components[n++]);
+	}
+
+	if (n != count)
+		throw Common::Exception("GFF3Creator::readStructContents() Invalid size of %s components", type);
+}
+
+void GFF3Creator::create(XMLReader &xml, uint32 id, Common::WriteStream &file, uint32 version) {
 	Aurora::GFF3Writer gff3(id, version);
 
-	if (root.getChildren().size() > 1)
-		throw Common::Exception("GFF3Creator::create() More than one root struct");
+	bool hasRootStruct = false;
 
-	if (root.getChildren().size() == 0)
-		throw Common::Exception("GFF3Creator::create() No root struct");
+	const size_t depth = xml.getDepth();
+	while (xml.readChild(depth)) {
+		if (hasRootStruct)
+			throw Common::Exception("GFF3Creator::create() More than one root struct");
+
+		hasRootStruct = true;
 
-	const XML::XMLNode &rootStruct = *root.getChildren().front();
+		uint32 structID;
+		Common::parseString(xml.getProperty("id"), structID);
+		if (structID != 0xFFFFFFFF)
+			throw Common::Exception("GFF3Creator::create() Invalid root struct id");
 
-	Common::parseString(rootStruct.getProperty("id"), id);
-	if (id != 0xFFFFFFFF)
-		throw Common::Exception("GFF3Creator::create() Invalid root struct id");
+		readStructContents(xml, gff3.getTopLevel());
+	}
 
-	readStructContents(rootStruct.getChildren(), gff3.getTopLevel());
+	if (!hasRootStruct)
+		throw Common::Exception("GFF3Creator::create() No root struct");
 
 	gff3.write(file);
 }
 
-void GFF3Creator::readStructContents(const XMLNode::Children &strctNodes, Aurora::GFF3WriterStructPtr strctPtr) {
-	for (const auto &strctNode : strctNodes) {
-		if (strctNode->getName() == "byte") {
+void GFF3Creator::readStructContents(XMLReader &xml, Aurora::GFF3WriterStructPtr strctPtr) {
+	const size_t depth = xml.getDepth();
+	while (xml.readChild(depth)) {
+		const Common::UString &name  = xml.getName();
+		const Common::UString  label = xml.getProperty("label");
+
+		if (name == "byte") {
 			uint8 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addByte(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "char") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addByte(label, value);
+		} else if (name == "char") {
 			int8 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addChar(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "sint16") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addChar(label, value);
+		} else if (name == "sint16") {
 			int16 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addSint16(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "float") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addSint16(label, value);
+		} else if (name == "float") {
 			float value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addFloat(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "float") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addFloat(label, value);
+		} else if (name == "double") {
 			double value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addDouble(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "sint32") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addDouble(label, value);
+		} else if (name == "sint32") {
 			int32 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addSint32(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "sint64") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addSint32(label, value);
+		} else if (name == "sint64") {
 			int64 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addSint64(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "uint16") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addSint64(label, value);
+		} else if (name == "uint16") {
 			uint16 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addUint16(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "uint32") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addUint16(label, value);
+		} else if (name == "uint32") {
 			uint32 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addUint32(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "uint64") {
+			Common::parseString(xml.readText(), value);
+			strctPtr->addUint32(label, value);
+		} else if (name == "uint64") {
 			uint64 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addUint64(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "exostring") {
-			const XMLNode *text = strctNode->findChild("text");
-			if (text) {
-				bool base64 = false;
-				Common::parseString(strctNode->getProperty("base64"), base64, true);
-
-				const Common::UString contents = text->getContent();
-				if (base64) {
-					Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
-					strctPtr->addExoString(strctNode->getProperty("label"), debase64);
-
-				} else
-					strctPtr->addExoString(strctNode->getProperty("label"), contents);
-
-			} else
-				strctPtr->addExoString(strctNode->getProperty("label"), "");
+			Common::parseString(xml.readText(), value);
+			strctPtr->addUint64(label, value);
+		} else if (name == "exostring") {
+			bool base64 = false;
+			Common::parseString(xml.getProperty("base64"), base64, true);
 
-		} else if (strctNode->getName() == "strref") {
-			uint32 value;
-			Common::parseString(strctNode->findChild("text")->getContent(), value);
-			strctPtr->addStrRef(strctNode->getProperty("label"), value);
-		} else if (strctNode->getName() == "resref") {
-			const XMLNode *text = strctNode->findChild("text");
-			if (text) {
-				bool base64 = false;
-				Common::parseString(strctNode->getProperty("base64"), base64, true);
-
-				const Common::UString contents = text->getContent();
-				if (base64) {
-					Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
-					strctPtr->addResRef(strctNode->getProperty("label"), debase64);
-
-				} else
-					strctPtr->addResRef(strctNode->getProperty("label"), contents);
+			const Common::UString contents = xml.readText();
+			if (base64 && !contents.empty()) {
+				Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
+				strctPtr->addExoString(label, debase64);
 
 			} else
-				strctPtr->addResRef(strctNode->getProperty("label"), "");
-
-		} else if (strctNode->getName() == "data") {
-			const XMLNode *textNode = strctNode->findChild("text");
-			Common::UString text = textNode ? textNode->getContent() : "";
-
-			Common::SeekableReadStream *debase64 = Common::decodeBase64(text);
-			strctPtr->addVoid(strctNode->getProperty("label"), debase64);
-		} else if (strctNode->getName() == "vector") {
-			float x, y, z;
-
-			if (strctNode->getChildren().size() != 3)
-				throw Common::Exception("GFF3Creator::readStructContents() Invalid size of vector components");
-
-			XMLNode::Children::const_iterator iter = strctNode->getChildren().begin();
-			const XMLNode *xValue = (*iter++)->findChild("text");
-			const XMLNode *yValue = (*iter++)->findChild("text");
-			const XMLNode *zValue = (*iter++)->findChild("text");
-
-			if (!xValue || !yValue || !zValue)
-				throw Common::Exception("GFF3Creator::readStructContents() Vector components empty");
-
-			Common::parseString(xValue->getContent(), x);
-			Common::parseString(yValue->getContent(), y);
-			Common::parseString(zValue->getContent(), z);
+				strctPtr->addExoString(label, contents);
 
-			strctPtr->addVector(strctNode->getProperty("label"), x, y, z);
-		} else if (strctNode->getName() == "orientation") {
-			float x, y, z, w;
-
-			if (strctNode->getChildren().size() != 4)
-				throw Common::Exception("GFF3Creator::readStructContents() Invalid size of orientation components");
-
-			XMLNode::Children::const_iterator iter = strctNode->getChildren().begin();
-			const XMLNode *xValue = (*iter++)->findChild("text");
-			const XMLNode *yValue = (*iter++)->findChild("text");
-			const XMLNode *zValue = (*iter++)->findChild("text");
-			const XMLNode *wValue = (*iter++)->findChild("text");
-
-			if (!xValue || !yValue || !zValue)
-				throw Common::Exception("GFF3Creator::readStructContents() Orientation components empty");
+		} else if (name == "strref") {
+			uint32 value;
+			Common::parseString(xml.readText(), value);
+			strctPtr->addStrRef(label, value);
+		} else if (name == "resref") {
+			bool base64 = false;
+			Common::parseString(xml.getProperty("base64"), base64, true);
 
-			Common::parseString(xValue->getContent(), x);
-			Common::parseString(yValue->getContent(), y);
-			Common::parseString(zValue->getContent(), z);
-			Common::parseString(wValue->getContent(), w);
+			const Common::UString contents = xml.readText();
+			if (base64 && !contents.empty()) {
+				Common::SeekableReadStream *debase64 = Common::decodeBase64(contents);
+				strctPtr->addResRef(label, debase64);
 
-			strctPtr->addOrientation(strctNode->getProperty("label"), x, y, z, w);
-		} else if (strctNode->getName() == "locstring") {
+			} else
+				strctPtr->addResRef(label, contents);
+
+		} else if (name == "data") {
+			Common::SeekableReadStream *debase64 = Common::decodeBase64(xml.readText());
+			strctPtr->addVoid(label, debase64);
+		} else if (name == "vector") {
+			float v[3];
+			readComponents(xml, v, 3, "vector");
+
+			strctPtr->addVector(label, v[0], v[1], v[2]);
+		} else if (name == "orientation") {
+			float v[4];
+			readComponents(xml, v, 4, "orientation");
+
+			strctPtr->addOrientation(label, v[0], v[1], v[2], v[3]);
+		} else if (name == "locstring") {
 			uint32 strref;
 			Aurora::LocString locString;
 
-			Common::parseString(strctNode->getProperty("strref"), strref);
+			Common::parseString(xml.getProperty("strref"), strref);
 			locString.setID(strref);
 
-			if (!strctNode->getChildren().empty()) {
-				for (const auto &child : strctNode->getChildren()) {
-					if (child->getName() != "string")
-						throw Common::Exception("GFF3Creator::readStructContents() Invalid LocString string");
-
-					const XMLNode *text = child->findChild("text");
+			const size_t locDepth = xml.getDepth();
+			while (xml.readChild(locDepth)) {
+				if (xml.getName() != "string")
+					throw Common::Exception("GFF3Creator::readStructContents() Invalid LocString string");
 
-					uint32 id;
-					Common::parseString(child->getProperty("language"), id);
-					locString.setStringRawLanguageID(id, text ? text->getContent() : "");
-				}
+				uint32 id;
+				Common::parseString(xml.getProperty("language"), id);
+				locString.setStringRawLanguageID(id, xml.readText());
 			}
 
-			strctPtr->addLocString(strctNode->getProperty("label"), locString);
-		} else if (strctNode->getName() == "struct") {
-			Common::UString idText = strctNode->getProperty("id");
+			strctPtr->addLocString(label, locString);
+		} else if (name == "struct") {
+			Common::UString idText = xml.getProperty("id");
 
 			Aurora::GFF3WriterStructPtr strct = nullptr;
 			if (!idText.empty()) {
 				uint32 id;
 				Common::parseString(idText, id);
-				strct = strctPtr->addStruct(strctNode->getProperty("label"), id);
+				strct = strctPtr->addStruct(label, id);
 			} else
-				strct = strctPtr->addStruct(strctNode->getProperty("label"));
+				strct = strctPtr->addStruct(label);
 
-			readStructContents(strctNode->getChildren(), strct);
-		} else if (strctNode->getName() == "list") {
-			Aurora::GFF3WriterListPtr list = strctPtr->addList(strctNode->getProperty("label"));
-			readListContents(strctNode->getChildren(), list);
+			readStructContents(xml, strct);
+		} else if (name == "list") {
+			Aurora::GFF3WriterListPtr list = strctPtr->addList(label);
+			readListContents(xml, list);
 		}
 	}
 }
 
-void GFF3Creator::readListContents(const XMLNode::Children &listNodes, Aurora::GFF3WriterListPtr listPtr) {
-	for (const auto &node : listNodes) {
-		if (node->getName() != "struct")
+void GFF3Creator::readListContents(XMLReader &xml, Aurora::GFF3WriterListPtr listPtr) {
+	const size_t depth = xml.getDepth();
+	while (xml.readChild(depth)) {
+		if (xml.getName() != "struct")
 			throw Common::Exception("GFF3Creator::readListContents() Invalid element in list");
 
-		Common::UString idText = node->getProperty("id");
+		Common::UString idText = xml.getProperty("id");
 
 		Aurora::GFF3WriterStructPtr strct = nullptr;
 		if (!idText.empty()) {
 			uint32 id;
 			Common::parseString(idText, id);
-			strct = listPtr->addStruct(node->getProperty("label"), id);
+			strct = listPtr->addStruct(xml.getProperty("label"), id);
 		} else
-			strct = listPtr->addStruct(node->getProperty("label"));
+			strct = listPtr->addStruct(xml.getProperty("label"));
 
-		readStructContents(node->getChildren(), strct);
+		readStructContents(xml, strct);
 	}
 }
 
@@ -29,17 +29,22 @@
 
 #include "src/aurora/gff3writer.h"
 
-#include "src/xml/xmlparser.h"
+#include "src/xml/xmlreader.h"
 
 namespace XML {
 
 class GFF3Creator {
 public:
-	static void create(const XML::XMLNode &root, uint32 id, Common::WriteStream &file, uint32 version);
+	/** Create a GFF3 out of the XML. The reader needs to be positioned on the start tag of the root element.
+	 *
+	 *  The whole GFF3 is built up in memory, and only written into the file
+	 *  once the XML has been read completely.
+	 */
+	static void create(XMLReader &xml, uint32 id, Common::WriteStream &file, uint32 version);
 
 private:
-	static void readStructContents(const XMLNode::Children &strctNodes, Aurora::GFF3WriterStructPtr strctPtr);
-	static void readListContents(const XMLNode::Children &listNodes, Aurora::GFF3WriterListPtr listPtr);
+	static void readStructContents(XMLReader &xml, Aurora::GFF3WriterStructPtr strctPtr);
+	static void readListContents(XMLReader &xml, Aurora::GFF3WriterListPtr listPtr);
 };
 
 } // End of namespace XML
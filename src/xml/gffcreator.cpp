@@ -24,7 +24,7 @@
 
 #include "src/common/error.h"
 
-#include "src/xml/xmlparser.h"
+#include "src/xml/xmlreader.h"
 #include "src/xml/gffcreator.h"
 #include "src/xml/gff3creator.h"
 
@@ -43,16 +43,15 @@ static uint32 getGFF3Version(GFFCreator::GFF3Version v) {
 void GFFCreator::create(Common::WriteStream &output, Common::ReadStream &input, const Common::UString &inputFileName,
 		GFF3Version gff3Version) {
 
-	XMLParser xml(input, true, inputFileName);
+	XMLReader xml(input, true, inputFileName);
+	xml.readRoot();
 
-	const XMLNode &xmlRoot = xml.getRoot();
-
-	const Common::UString type = xmlRoot.getProperty("type") + "    ";
+	const Common::UString type = xml.getProperty("type") + "    ";
 	const uint32 typeId = MKTAG(*type.getPosition(0), *type.getPosition(1), *type.getPosition(2), *type.getPosition(3));
 
-	if (xmlRoot.getName() == "gff3") {
-		XML::GFF3Creator::create(xmlRoot, typeId, output, getGFF3Version(gff3Version));
-	} else if (xmlRoot.getName() == "gff4") {
+	if (xml.getName() == "gff3") {
+		XML::GFF3Creator::create(xml, typeId, output, getGFF3Version(gff3Version));
+	} else if (xml.getName() == "gff4") {
 		throw Common::Exception("TODO: Add GFF4 writer support");
 	} else {
 		throw Common::Exception("GFFCreator::create() invalid root tag");
@@ -25,6 +25,7 @@ src_xml_libxml_la_SOURCES =
 src_xml_libxml_la_SOURCES += \
     src/xml/xmlwriter.h \
     src/xml/xmlparser.h \
+    src/xml/xmlreader.h \
     src/xml/gffdumper.h \
     src/xml/gff3dumper.h \
     src/xml/gff4dumper.h \
@@ -41,6 +42,7 @@ src_xml_libxml_la_SOURCES += \
 src_xml_libxml_la_SOURCES += \
     src/xml/xmlwriter.cpp \
     src/xml/xmlparser.cpp \
+    src/xml/xmlreader.cpp \
     src/xml/gffdumper.cpp \
     src/xml/gff3dumper.cpp \
     src/xml/gff4dumper.cpp \
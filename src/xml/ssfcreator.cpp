@@ -31,41 +31,36 @@
 #include "src/aurora/ssffile.h"
 
 #include "src/xml/ssfcreator.h"
-#include "src/xml/xmlparser.h"
+#include "src/xml/xmlreader.h"
 
 namespace XML {
 
 void SSFCreator::create(Common::WriteStream &output, Common::ReadStream &input,
                         Aurora::GameID game, const Common::UString &inputFileName) {
 
-	XMLParser xml(input, true, inputFileName);
-	const XMLNode &xmlRoot = xml.getRoot();
+	XMLReader xml(input, true, inputFileName);
+	xml.readRoot();
 
-	if (xmlRoot.getName() != "ssf")
+	if (xml.getName() != "ssf")
 		throw Common::Exception("XML does not describe a SSF");
 
 	Aurora::SSFFile ssf;
 
-	const XMLNode::Children &strings = xmlRoot.getChildren();
-
-	for (XMLNode::Children::const_iterator s = strings.begin(); s != strings.end(); ++s) {
-		if ((*s)->getName() != "sound")
+	while (xml.readChild(0)) {
+		if (xml.getName() != "sound")
 			throw Common::Exception("XML tag \"sound\" expected");
 
-		const Common::UString xmlID = (*s)->getProperty("id");
+		const Common::UString xmlID = xml.getProperty("id");
 		if (xmlID.empty())
 			throw Common::Exception("XML property \"id\" expected");
 
 		size_t soundID = 0;
 		Common::parseString(xmlID, soundID, false);
 
-		Common::UString soundFile;
-		const XMLNode *text = (*s)->findChild("text");
-		if (text)
-			soundFile = text->getContent();
-
 		uint32 strRef = 0xFFFFFFFF;
-		Common::parseString((*s)->getProperty("strref"), strRef, true);
+		Common::parseString(xml.getProperty("strref"), strRef, true);
+
+		const Common::UString soundFile = xml.readText();
 
 		ssf.setSound(soundID, soundFile, strRef);
 	}
@@ -42,6 +42,11 @@ public:
 		kVersion40
 	};
 
+	/** Create a TLK out of the XML read from input.
+	 *
+	 *  The whole talk table is built up in memory, and only written into
+	 *  the output once the XML has been read completely.
+	 */
 	static void create(Common::WriteStream &output, Common::ReadStream &input,
 	                   Version &version, Common::Encoding encoding,
 	                   const Common::UString &inputFileName, uint32 languageID = 0xFFFFFFFF);
@@ -0,0 +1,257 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Streaming XML reader, using libxml2.
+ */
+
+#include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+
+#include "src/xml/xmlreader.h"
+
+namespace XML {
+
+static void errorFuncReader(void *arg, const char *msg, xmlParserSeverities severity,
+                            xmlTextReaderLocatorPtr UNUSED(locator)) {
+
+	// Warnings are ignored, like XML_PARSE_NOWARNING does for the DOM parser
+	if ((severity == XML_PARSER_SEVERITY_VALIDITY_WARNING) || (severity == XML_PARSER_SEVERITY_WARNING))
+		return;
+
+	Common::UString *str = static_cast<Common::UString *>(arg);
+	if (str && msg)
+		*str += msg;
+}
+
+static int readStream(void *context, char *buffer, int len) {
+	Common::ReadStream *stream = static_cast<Common::ReadStream *>(context);
+	if (!stream)
+		return -1;
+
+	return stream->read(buffer, len);
+}
+
+static int closeStream(void *UNUSED(context)) {
+	return 0;
+}
+
+
+XMLReader::XMLReader(Common::ReadStream &stream, bool makeLower, const Common::UString &fileName) :
+	_reader(0), _makeLower(makeLower), _type(kNodeNone), _depth(0), _needEndTag(false) {
+
+	// Initialize libxml2 and make sure the library version matches
+	LIBXML_TEST_VERSION
+
+	const int options = XML_PARSE_NOWARNING | XML_PARSE_NOBLANKS | XML_PARSE_NONET |
+	                    XML_PARSE_NSCLEAN   | XML_PARSE_NOCDATA;
+
+	_reader = xmlReaderForIO(readStream, closeStream, static_cast<void *>(&stream),
+	                         fileName.c_str(), 0, options);
+	if (!_reader)
+		throw Common::Exception("Failed to create XML reader");
+
+	xmlTextReaderSetErrorHandler(_reader, errorFuncReader, static_cast<void *>(&_parseError));
+}
+
+XMLReader::~XMLReader() {
+	xmlFreeTextReader(_reader);
+
+	xmlCleanupParser();
+}
+
+void XMLReader::readRoot() {
+	while (next())
+		if (_type == kNodeStartTag)
+			return;
+
+	throw Common::Exception("XML document has no root node");
+}
+
+bool XMLReader::next() {
+	while (readNode())
+		if (_type != kNodeText)
+			return true;
+
+	return false;
+}
+
+bool XMLReader::readChild(size_t depth) {
+	while (next()) {
+		if ((_type == kNodeStartTag) && (_depth == (depth + 1)))
+			return true;
+
+		if ((_type == kNodeEndTag) && (_depth == depth))
+			return false;
+	}
+
+	throw Common::Exception("XML document ended unexpectedly");
+}
+
+Common::UString XMLReader::readText() {
+	if (_type != kNodeStartTag)
+		throw Common::Exception("XMLReader::readText(): Not on a start tag");
+
+	const size_t depth = _depth;
+
+	Common::UString text;
+	while (readNode()) {
+		if ((_type == kNodeText) && (_depth == (depth + 1)))
+			text += _text;
+
+		if ((_type == kNodeEndTag) && (_depth == depth))
+			return text;
+	}
+
+	throw Common::Exception("XML document ended unexpectedly");
+}
+
+bool XMLReader::isStartTag() const {
+	return _type == kNodeStartTag;
+}
+
+bool XMLReader::isEndTag() const {
+	return _type == kNodeEndTag;
+}
+
+size_t XMLReader::getDepth() const {
+	return _depth;
+}
+
+const Common::UString &XMLReader::getName() const {
+	return _name;
+}
+
+Common::UString XMLReader::getProperty(const Common::UString &name, const Common::UString &def) const {
+	if (_type != kNodeStartTag)
+		return def;
+
+	for (std::vector<Property>::const_iterator p = _properties.begin(); p != _properties.end(); ++p)
+		if (p->name == name)
+			return p->value;
+
+	return def;
+}
+
+bool XMLReader::readNode() {
+	if (_needEndTag) {
+		// The current element was empty, so give it an end tag now
+		_needEndTag = false;
+
+		_type = kNodeEndTag;
+		_properties.clear();
+
+		return true;
+	}
+
+	while (true) {
+		const int result = xmlTextReaderRead(_reader);
+		if (result < 0)
+			throwParseError();
+
+		if (result == 0) {
+			_type = kNodeNone;
+			return false;
+		}
+
+		switch (xmlTextReaderNodeType(_reader)) {
+			case XML_READER_TYPE_ELEMENT:
+				readStartTag();
+				return true;
+
+			case XML_READER_TYPE_END_ELEMENT:
+				readEndTag();
+				return true;
+
+			case XML_READER_TYPE_TEXT:
+			case XML_READER_TYPE_CDATA:
+			case XML_READER_TYPE_WHITESPACE:
+			case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+				readTextNode();
+				return true;
+
+			default:
+				break;
+		}
+	}
+}
+
+static Common::UString getString(const xmlChar *str) {
+	return str ? reinterpret_cast<const char *>(str) : "";
+}
+
+void XMLReader::readStartTag() {
+	_type  = kNodeStartTag;
+	_depth = xmlTextReaderDepth(_reader);
+
+	_name = getString(xmlTextReaderConstLocalName(_reader));
+	if (_makeLower)
+		_name.makeLower();
+
+	_needEndTag = xmlTextReaderIsEmptyElement(_reader) == 1;
+
+	_properties.clear();
+	while (xmlTextReaderMoveToNextAttribute(_reader) == 1) {
+		if (xmlTextReaderIsNamespaceDecl(_reader) == 1)
+			continue;
+
+		_properties.push_back(Property(getString(xmlTextReaderConstLocalName(_reader)),
+		                               getString(xmlTextReaderConstValue(_reader))));
+
+		if (_makeLower)
+			_properties.back().name.makeLower();
+	}
+
+	xmlTextReaderMoveToElement(_reader);
+}
+
+void XMLReader::readEndTag() {
+	_type  = kNodeEndTag;
+	_depth = xmlTextReaderDepth(_reader);
+
+	_name = getString(xmlTextReaderConstLocalName(_reader));
+	if (_makeLower)
+		_name.makeLower();
+
+	_properties.clear();
+}
+
+void XMLReader::readTextNode() {
+	_type  = kNodeText;
+	_depth = xmlTextReaderDepth(_reader);
+
+	_text = getString(xmlTextReaderConstValue(_reader));
+}
+
+void XMLReader::throwParseError() {
+	Common::Exception e;
+
+	if (!_parseError.empty())
+		e.add("%s", _parseError.c_str());
+
+	e.add("XML document failed to parse");
+	throw e;
+}
+
+} // End of namespace XML
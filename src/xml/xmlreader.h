@@ -0,0 +1,160 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Streaming XML reader, using libxml2.
+ */
+
+#ifndef XML_XMLREADER_H
+#define XML_XMLREADER_H
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/ustring.h"
+
+struct _xmlTextReader;
+
+namespace Common {
+	class ReadStream;
+}
+
+namespace XML {
+
+/** Class to read an XML file out of a ReadStream, one node at a time.
+ *
+ *  Unlike XMLParser, which reads the whole XML into a tree of XMLNodes
+ *  first, XMLReader only ever keeps the current node in memory. Huge XML
+ *  files can so be read in bounded memory, but only front to back.
+ *
+ *  This only bounds the memory of the reading side. Whatever is built out
+ *  of the XML, like the GFF3 or TLK of GFF3Creator and TLKCreator, still
+ *  needs to be kept around by its user.
+ *
+ *  The reader stops at the start and end tags of all elements. Empty
+ *  elements, like <foo/>, also get an end tag. The text within an element
+ *  can be read with readText(), while positioned on its start tag.
+ *
+ *  A typical loop over all child elements of an element looks like this:
+ *
+ *  const size_t depth = xml.getDepth();
+ *  while (xml.readChild(depth)) {
+ *    if (xml.getName() == "foo")
+ *      foo = xml.readText();
+ *  }
+ *
+ *  Anything within a child element that isn't read is skipped over.
+ */
+class XMLReader : boost::noncopyable {
+public:
+	/** Start reading an XML file out of a stream.
+	 *
+	 *  @param stream The stream to read the XML from.
+	 *  @param makeLower Should all tags be converted to lowercase, to ease case-insensitive comparison?
+	 *  @param fileName The file name to tell libxml2. Only used for error reporting.
+	 */
+	XMLReader(Common::ReadStream &stream, bool makeLower = false,
+	          const Common::UString &fileName = "stream.xml");
+	~XMLReader();
+
+	/** Advance to the start tag of the root element. */
+	void readRoot();
+
+	/** Advance to the next start or end tag. Returns false at the end of the XML. */
+	bool next();
+
+	/** Advance to the start tag of the next child of the element at this depth.
+	 *
+	 *  Returns true when positioned on the start tag of the next child, and
+	 *  false when positioned on the end tag of the parent element instead.
+	 */
+	bool readChild(size_t depth);
+
+	/** Read all text directly within the current element.
+	 *
+	 *  Needs to be positioned on the start tag of an element. Afterwards,
+	 *  the reader is positioned on the end tag of the element.
+	 */
+	Common::UString readText();
+
+	/** Is the reader positioned on a start tag? */
+	bool isStartTag() const;
+	/** Is the reader positioned on an end tag? */
+	bool isEndTag() const;
+
+	/** Return the depth of the current element. The root element is at depth 0. */
+	size_t getDepth() const;
+
+	/** Return the name of the current element. */
+	const Common::UString &getName() const;
+
+	/** Return a certain property of the current element. Only available on start tags. */
+	Common::UString getProperty(const Common::UString &name, const Common::UString &def = "") const;
+
+
+private:
+	enum NodeType {
+		kNodeNone,
+		kNodeStartTag,
+		kNodeEndTag,
+		kNodeText
+	};
+
+	struct Property {
+		Common::UString name;
+		Common::UString value;
+
+		Property(const Common::UString &n, const Common::UString &v) : name(n), value(v) { }
+	};
+
+	_xmlTextReader *_reader;
+
+	bool _makeLower;
+
+	/** Errors libxml2 reported while reading. */
+	Common::UString _parseError;
+
+	NodeType _type;
+	size_t _depth;
+
+	/** The name of the current element. */
+	Common::UString _name;
+	/** The contents of the current text node. */
+	Common::UString _text;
+
+	std::vector<Property> _properties;
+
+	/** Was the current start tag that of an empty element, still needing its end tag? */
+	bool _needEndTag;
+
+	/** Advance to the next node we're interested in. Returns false at the end of the XML. */
+	bool readNode();
+
+	void readStartTag();
+	void readEndTag();
+	void readTextNode();
+
+	void throwParseError();
+};
+
+} // End of namespace XML
+
+#endif // XML_XMLREADER_H
@@ -22,16 +22,25 @@
  *  Utility class for writing XML files.
  */
 
+#include <cstring>
+
+#include "src/common/util.h"
 #include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
-#include "src/common/writestream.h"
 #include "src/common/base64.h"
+#include "src/common/writestream.h"
+#include "src/common/error.h"
 
 #include "src/xml/xmlwriter.h"
 
 namespace XML {
 
-XMLWriter::XMLWriter(Common::WriteStream &stream) : _stream(&stream), _needIndent(false) {
+/** The length of a line of base64-encoded data. */
+static const size_t kBase64LineLength = 64;
+
+XMLWriter::XMLWriter(Common::WriteStream &stream) : _stream(&stream),
+	_buffer(new char[kBufferSize]), _bufferPos(0), _needIndent(false), _propertyCount(0), _isBase64(false) {
+
 	writeHeader();
 }
 
@@ -46,14 +55,103 @@ void XMLWriter::flush() {
 	while (!_openTags.empty())
 		closeTag();
 
+	flushBuffer();
 	_stream->flush();
 }
 
+void XMLWriter::flushBuffer() {
+	if (_bufferPos == 0)
+		return;
+
+	const size_t size = _bufferPos;
+	_bufferPos = 0;
+
+	if (_stream->write(_buffer.get(), size) != size)
+		throw Common::Exception(Common::kWriteError);
+}
+
+void XMLWriter::write(const char *data, size_t size) {
+	if ((_bufferPos + size) > kBufferSize) {
+		flushBuffer();
+
+		// Too big to be worth buffering, write it directly
+		if (size >= kBufferSize) {
+			if (_stream->write(data, size) != size)
+				throw Common::Exception(Common::kWriteError);
+
+			return;
+		}
+	}
+
+	std::memcpy(_buffer.get() + _bufferPos, data, size);
+	_bufferPos += size;
+}
+
+void XMLWriter::write(const char *str) {
+	write(str, std::strlen(str));
+}
+
+void XMLWriter::write(const Common::UString &str) {
+	write(str.c_str());
+}
+
+void XMLWriter::writeEscaped(const Common::UString &str) {
+	// All characters we need to escape are ASCII, so we can look at the UTF-8 bytes directly
+	const char *run = str.c_str();
+	const char *s   = run;
+
+	for (; *s; s++) {
+		const char *entity = 0;
+
+		switch (*s) {
+			case '\"':
+				entity = "&quot;";
+				break;
+			case '\'':
+				entity = "&apos;";
+				break;
+			case '&':
+				entity = "&amp;";
+				break;
+			case '<':
+				entity = "&lt;";
+				break;
+			case '>':
+				entity = "&gt;";
+				break;
+			case '\r':
+				entity = "&#13;";
+				break;
+			default:
+				continue;
+		}
+
+		write(run, s - run);
+		write(entity);
+
+		run = s + 1;
+	}
+
+	write(run, s - run);
+}
+
 void XMLWriter::writeHeader() {
-	_stream->writeString("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n");
+	write("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n");
 	flush();
 }
 
+void XMLWriter::clearPending() {
+	_propertyCount = 0;
+
+	_contents.clear();
+	_base64.clear();
+	_isBase64 = false;
+}
+
+bool XMLWriter::isPending() const {
+	return !_openTags.empty() && !_openTags.back().written;
+}
+
 void XMLWriter::openTag(const Common::UString &name) {
 	if (!_openTags.empty()) {
 		_openTags.back().empty = false;
@@ -66,8 +164,11 @@ void XMLWriter::openTag(const Common::UString &name) {
 
 	Tag &tag = _openTags.back();
 
-	tag.name  = name;
-	tag.empty = true;
+	tag.name    = name;
+	tag.written = false;
+	tag.empty   = true;
+
+	clearPending();
 }
 
 void XMLWriter::closeTag() {
@@ -80,53 +181,62 @@ void XMLWriter::closeTag() {
 
 	if (!tag.empty) {
 		indent(_openTags.size() - 1);
-		_stream->writeString("</" + tag.name + ">");
+
+		write("</", 2);
+		write(tag.name);
+		write(">", 1);
 	}
 
 	_openTags.pop_back();
 }
 
 void XMLWriter::writeTag() {
-	if (_openTags.empty() || _openTags.back().written)
+	if (!isPending())
 		return;
 
 	Tag &tag = _openTags.back();
 
 	tag.written = true;
 
-	_stream->writeString("<" + tag.name);
+	write("<", 1);
+	write(tag.name);
 
-	for (std::list<Property>::const_iterator p = tag.properties.begin(); p != tag.properties.end(); ++p)
-		_stream->writeString(" " + p->name + "=\"" + escape(p->value) + "\"");
+	for (size_t i = 0; i < _propertyCount; i++) {
+		write(" ", 1);
+		write(_properties[i].name);
+		write("=\"", 2);
+		writeEscaped(_properties[i].value);
+		write("\"", 1);
+	}
 
 	if (tag.empty)
-		_stream->writeString("/");
-
-	_stream->writeString(">");
+		write("/>", 2);
+	else
+		write(">", 1);
 
 	if (!tag.empty) {
-		if (!tag.base64.empty()) {
+		if (_isBase64) {
 
-			if (tag.base64.size() == 1) {
+			if (_base64.size() <= kBase64LineLength) {
 
-				_stream->writeString(tag.base64.front());
-				tag.base64.pop_front();
+				write(_base64.c_str(), _base64.size());
 
 			} else {
 
-				while (!tag.base64.empty()) {
+				for (size_t i = 0; i < _base64.size(); i += kBase64LineLength) {
 					breakLine();
 					indent(_openTags.size());
-					_stream->writeString(tag.base64.front());
-					tag.base64.pop_front();
+					write(_base64.c_str() + i, MIN(kBase64LineLength, _base64.size() - i));
 				}
 				breakLine();
 
 			}
 
 		} else
-			_stream->writeString(escape(tag.contents));
+			writeEscaped(_contents);
 	}
+
+	clearPending();
 }
 
 void XMLWriter::indent(size_t level) {
@@ -134,90 +244,59 @@ void XMLWriter::indent(size_t level) {
 		return;
 
 	while (level-- > 0)
-		_stream->writeString("  ");
+		write("  ", 2);
 
 	_needIndent = false;
 }
 
-Common::UString XMLWriter::escape(const Common::UString &str) {
-	Common::UString escaped;
-
-	for (Common::UString::iterator s = str.begin(); s != str.end(); ++s) {
-		uint32 c = *s;
-
-		if      (c == '\"')
-			escaped += "&quot;";
-		else if (c == '\'')
-			escaped += "&apos;";
-		else if (c == '&')
-			escaped += "&amp;";
-		else if (c == '<')
-			escaped += "&lt;";
-		else if (c == '>')
-			escaped += "&gt;";
-		else if (c == '\r')
-			escaped += "&#13;";
-		else
-			escaped += c;
-
-	}
-
-	return escaped;
-}
-
 void XMLWriter::addProperty(const Common::UString &name, const Common::UString &value) {
-	if (_openTags.empty())
+	if (!isPending())
 		return;
 
-	Tag &tag = _openTags.back();
-
-	tag.properties.push_back(Property());
+	if (_propertyCount == _properties.size())
+		_properties.push_back(Property());
 
-	Property &property = tag.properties.back();
+	Property &property = _properties[_propertyCount++];
 
 	property.name  = name;
 	property.value = value;
 }
 
 void XMLWriter::setContents(const Common::UString &contents) {
-	if (_openTags.empty())
+	if (!isPending())
 		return;
 
-	Tag &tag = _openTags.back();
+	_base64.clear();
+	_isBase64 = false;
 
-	tag.base64.clear();
+	_contents = contents;
 
-	tag.contents = contents;
-	tag.empty    = false;
+	_openTags.back().empty = false;
 }
 
 void XMLWriter::setContents(const byte *data, size_t size) {
-	if (_openTags.empty())
+	if (!isPending())
 		return;
 
-	Tag &tag = _openTags.back();
-
-	tag.base64.clear();
-	tag.contents.clear();
-
 	Common::MemoryReadStream stream(data, size);
-	Common::encodeBase64(stream, tag.base64, 64);
-
-	tag.empty = false;
+	setBase64(stream);
 }
 
 void XMLWriter::setContents(Common::SeekableReadStream &stream) {
-	if (_openTags.empty())
+	if (!isPending())
 		return;
 
-	Tag &tag = _openTags.back();
+	setBase64(stream);
+}
 
-	tag.base64.clear();
-	tag.contents.clear();
+void XMLWriter::setBase64(Common::ReadStream &stream) {
+	_contents.clear();
+	_base64.clear();
+	_isBase64 = true;
 
-	Common::encodeBase64(stream, tag.base64, 64);
+	Common::encodeBase64(stream, _base64);
 
-	tag.empty = false;
+	_openTags.back().empty = false;
 }
 
 void XMLWriter::breakLine() {
@@ -226,7 +305,7 @@ void XMLWriter::breakLine() {
 		writeTag();
 	}
 
-	_stream->writeString("\n");
+	write("\n", 1);
 	_needIndent = true;
 }
 
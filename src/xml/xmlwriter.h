@@ -25,19 +25,32 @@
 #ifndef XML_XMLWRITER_H
 #define XML_XMLWRITER_H
 
-#include <list>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 
 namespace Common {
+	class ReadStream;
 	class SeekableReadStream;
 	class WriteStream;
 }
 
 namespace XML {
 
+/** Class to write an XML file into a WriteStream.
+ *
+ *  All output is collected in an internal buffer, which is only handed to
+ *  the stream in large blocks. Properties, contents and base64 data of the
+ *  current tag are kept in storage that is reused from tag to tag, so that
+ *  writing a tag usually doesn't allocate any memory at all.
+ *
+ *  Call flush() (or destroy the XMLWriter) to make sure everything has
+ *  been written into the stream.
+ */
 class XMLWriter : boost::noncopyable {
 public:
 	XMLWriter(Common::WriteStream &stream);
@@ -64,6 +77,9 @@ public:
 	void breakLine();
 
 private:
+	/** The size of the output buffer. */
+	static const size_t kBufferSize = 64 * 1024;
+
 	struct Property {
 		Common::UString name;
 		Common::UString value;
@@ -72,27 +88,55 @@ private:
 	struct Tag {
 		Common::UString name;
 
-		std::list<Property> properties;
-
-		Common::UString contents;
-		std::list<Common::UString> base64;
-
 		bool written;
 		bool empty;
 	};
 
 	Common::WriteStream *_stream;
 
-	std::list<Tag> _openTags;
+	Common::ScopedArray<char> _buffer;
+	size_t _bufferPos;
+
+	std::vector<Tag> _openTags;
 	bool _needIndent;
 
+	/** Properties of the last opened tag, if it hasn't been written yet.
+	 *
+	 *  Only the first _propertyCount entries are valid. The rest are left
+	 *  around so that their strings can be reused.
+	 */
+	std::vector<Property> _properties;
+	size_t _propertyCount;
+
+	/** Contents of the last opened tag, if it hasn't been written yet. */
+	Common::UString _contents;
+	/** Base64-encoded binary contents, without line breaks. */
+	Common::UString _base64;
+	/** Are the contents in _base64 instead of _contents? */
+	bool _isBase64;
+
 
 	void writeHeader();
 
 	void indent(size_t level);
 	void writeTag();
 
-	Common::UString escape(const Common::UString &str);
+	/** Clear the pending properties and contents, for a new tag. */
+	void clearPending();
+	/** Can the last opened tag still take properties and contents? */
+	bool isPending() const;
+
+	void setBase64(Common::ReadStream &stream);
+
+	/** Append raw data to the output buffer. */
+	void write(const char *data, size_t size);
+	void write(const char *str);
+	void write(const Common::UString &str);
+	/** Append a string to the output buffer, escaping XML special characters. */
+	void writeEscaped(const Common::UString &str);
+
+	/** Hand the contents of the output buffer to the stream. */
+	void flushBuffer();
 };
 
 } // End of namespace XML
@@ -25,6 +25,12 @@
 #include <cstring>
 #include <cstdio>
 
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <exception>
+
 #include "src/version/version.h"
 
 #include "src/common/scopedptr.h"
@@ -35,26 +41,33 @@
 #include "src/common/platform.h"
 #include "src/common/readstream.h"
 #include "src/common/readfile.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/filepath.h"
+#include "src/common/encoding.h"
+#include "src/common/parallel.h"
 #include "src/common/cli.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/util.h"
 
-#include "src/images/decoder.h"
-#include "src/images/dds.h"
-#include "src/images/sbm.h"
-#include "src/images/tga.h"
-#include "src/images/tpc.h"
-#include "src/images/txb.h"
+#include "src/images/convert.h"
 
 #include "src/util.h"
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Common::UString &inFile, Common::UString &outFile,
-                      Aurora::FileType &type, bool &flip, bool &deswizzle);
+                      std::vector<Common::UString> &inFiles, Common::UString &outFile,
+                      Common::UString &batchDir, Common::UString &listFile,
+                      Aurora::FileType &type, bool &flip, bool &deswizzle, bool &rle, uint32_t &threads,
+                      uint32_t &mipMap);
 
 void convert(const Common::UString &inFile, const Common::UString &outFile,
-             Aurora::FileType type, bool flip, bool deswizzle);
+             Aurora::FileType type, bool flip, bool deswizzle, bool rle, int mipMap, uint32_t threads);
+
+void convertBatch(const std::vector<Common::UString> &inFiles, const Common::UString &batchDir,
+                  Aurora::FileType type, bool flip, bool deswizzle, bool rle, int mipMap, uint32_t threads);
+
+void readFileList(const Common::UString &listFile, std::vector<Common::UString> &files);
 
 int main(int argc, char **argv) {
 	initPlatform();
@@ -64,14 +77,25 @@ int main(int argc, char **argv) {
 		Common::Platform::getParameters(argc, argv, args);
 
 		int returnValue = 1;
-		Common::UString inFile, outFile;
+		std::vector<Common::UString> inFiles;
+		Common::UString outFile, batchDir, listFile;
 		Aurora::FileType type = Aurora::kFileTypeNone;
-		bool flip = false, deswizzle = false;
+		bool flip = false, deswizzle = false, rle = false;
+		uint32_t threads = 1, mipMap = 0;
 
-		if (!parseCommandLine(args, returnValue, inFile, outFile, type, flip, deswizzle))
+		if (!parseCommandLine(args, returnValue, inFiles, outFile, batchDir, listFile,
+		                      type, flip, deswizzle, rle, threads, mipMap))
 			return returnValue;
 
-		convert(inFile, outFile, type, flip, deswizzle);
+		if (batchDir.empty()) {
+			convert(inFiles[0], outFile, type, flip, deswizzle, rle, mipMap, threads);
+			return 0;
+		}
+
+		if (!listFile.empty())
+			readFileList(listFile, inFiles);
+
+		convertBatch(inFiles, batchDir, type, flip, deswizzle, rle, mipMap, threads);
 	} catch (...) {
 		Common::exceptionDispatcherError();
 	}
@@ -80,8 +104,10 @@ int main(int argc, char **argv) {
 }
 
 bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue,
-                      Common::UString &inFile, Common::UString &outFile,
-                      Aurora::FileType &type, bool &flip, bool &deswizzle) {
+                      std::vector<Common::UString> &inFiles, Common::UString &outFile,
+                      Common::UString &batchDir, Common::UString &listFile,
+                      Aurora::FileType &type, bool &flip, bool &deswizzle, bool &rle, uint32_t &threads,
+                      uint32_t &mipMap) {
 
 	using Common::CLI::NoOption;
 	using Common::CLI::kContinueParsing;
@@ -92,12 +118,15 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	using Common::CLI::makeEndArgs;
 	using Common::CLI::makeAssigners;
 
-	NoOption inFileOpt(false, new ValGetter<Common::UString &>(inFile, "input files"));
-	NoOption outFileOpt(true, new ValGetter<Common::UString &>(outFile, "output files"));
+	std::vector<Common::UString> files;
+
+	NoOption filesOpt(true, new ValGetter<std::vector<Common::UString> &>(files, "files[...]"));
 	Parser parser(argv[0], "BioWare textures to TGA converter",
-	              "",
+	              "Without --batch, exactly two files are expected: the input texture\n"
+	              "and the output TGA. With --batch, all files are input textures,\n"
+	              "which are converted into TGAs of the same name in the batch directory.\n",
 	              returnValue,
-	              makeEndArgs(&inFileOpt, &outFileOpt));
+	              makeEndArgs(&filesOpt));
 
 	parser.addSpace();
 	parser.addOption("auto", "Autodetect input type (default)", kContinueParsing,
@@ -115,82 +144,226 @@ bool parseCommandLine(const std::vector<Common::UString> &argv, int &returnValue
 	parser.addSpace();
 	parser.addOption("flip", 'f', "Flip the image vertically", kContinueParsing,
 	                 makeAssigners(new ValAssigner<bool>(true, flip)));
+	parser.addOption("rle", 'r', "RLE-compress the output TGA", kContinueParsing,
+	                 makeAssigners(new ValAssigner<bool>(true, rle)));
+	parser.addOption("mipmap", 'm', "Convert this mip map level instead of the largest one",
+	                 kContinueParsing, new ValGetter<uint32_t &>(mipMap, "n"));
 	parser.addSpace();
 	parser.addOption("deswizzle", 'd', "Input file is an Xbox SBM that needs deswizzling",
 	                 kContinueParsing, makeAssigners(new ValAssigner<bool>(true, deswizzle)));
-	return parser.process(argv);
-}
+	parser.addSpace();
+	parser.addOption("batch", 'b', "Convert many files into TGAs in this directory",
+	                 kContinueParsing, new ValGetter<Common::UString &>(batchDir, "dir"));
+	parser.addOption("list", 'l', "Batch mode: read more input files from this file, one per line "
+	                 "(\"-\": stdin)", kContinueParsing, new ValGetter<Common::UString &>(listFile, "file"));
+	parser.addOption("jobs", 'j', "Decompress with this many threads, or in batch mode, "
+	                 "convert this many files at once (0: one per CPU core)",
+	                 kContinueParsing, new ValGetter<uint32_t &>(threads, "n"));
 
-static bool isValidType(Aurora::FileType type) {
-	switch (type) {
-		case Aurora::kFileTypeDDS:
-		case Aurora::kFileTypeSBM:
-		case Aurora::kFileTypeTPC:
-		case Aurora::kFileTypeTXB:
-		case Aurora::kFileTypeTGA:
-			return true;
-
-		default:
-			break;
-	}
+	if (!parser.process(argv))
+		return false;
 
-	return false;
-}
+	const bool validSingle = batchDir.empty() && listFile.empty() && (files.size() == 2);
+	const bool validBatch  = !batchDir.empty() && (!files.empty() || !listFile.empty());
 
-static Aurora::FileType detectType(Common::SeekableReadStream &file) {
-	if (Images::DDS::detect(file))
-		return Aurora::kFileTypeDDS;
+	if (!validSingle && !validBatch) {
+		parser.usage();
+		returnValue = 1;
 
-	return Aurora::kFileTypeNone;
+		return false;
+	}
+
+	if (batchDir.empty()) {
+		inFiles.push_back(files[0]);
+		outFile = files[1];
+	} else
+		inFiles.swap(files);
+
+	return true;
 }
 
 static Aurora::FileType detectType(const Common::UString &file) {
 	Aurora::FileType type = TypeMan.getFileType(file);
-	if (isValidType(type))
+	if (Images::isTextureType(type))
 		return type;
 
 	return Aurora::kFileTypeNone;
 }
 
-static Images::Decoder *openImage(Common::SeekableReadStream &stream, Aurora::FileType type, bool deswizzle) {
-	switch (type) {
-		case Aurora::kFileTypeDDS:
-			return new Images::DDS(stream);
-		case Aurora::kFileTypeSBM:
-			return new Images::SBM(stream, deswizzle);
-		case Aurora::kFileTypeTPC:
-			return new Images::TPC(stream);
-		case Aurora::kFileTypeTXB:
-			return new Images::TXB(stream);
-		case Aurora::kFileTypeTGA:
-			return new Images::TGA(stream);
-
-		default:
-			throw Common::Exception("Invalid image type %d", (int) type);
-	}
+/** Detect the type of an input file.
+ *
+ *  The contents of the file take precedence over the type derived from the
+ *  file name, which has to be looked up in advance (the type manager is not
+ *  thread-safe).
+ */
+static Aurora::FileType detectType(Common::SeekableReadStream &file, const Common::UString &fileName,
+                                   Aurora::FileType nameType) {
+
+	// Detect by file contents
+	Aurora::FileType type = Images::detectTextureType(file);
+	if (type != Aurora::kFileTypeNone)
+		return type;
+
+	// Detect by file name
+	if (nameType != Aurora::kFileTypeNone)
+		return nameType;
+
+	throw Common::Exception("Failed to detect type of file \"%s\"", fileName.c_str());
 }
 
 void convert(const Common::UString &inFile, const Common::UString &outFile,
-             Aurora::FileType type, bool flip, bool deswizzle) {
+             Aurora::FileType type, bool flip, bool deswizzle, bool rle, int mipMap, uint32_t threads) {
 
 	Common::ReadFile in(inFile);
 
-	if (type == Aurora::kFileTypeNone) {
-		// Detect by file contents
-		type = detectType(in);
+	if (type == Aurora::kFileTypeNone)
+		type = detectType(in, inFile, detectType(inFile));
+
+	Images::convertToTGA(in, type, outFile, flip, deswizzle, rle, mipMap, threads);
+}
+
+void readFileList(const Common::UString &listFile, std::vector<Common::UString> &files) {
+	Common::ScopedPtr<Common::ReadStream> list(openFileOrStdIn(listFile));
+
+	Common::MemoryWriteStreamDynamic listData(true);
+	listData.writeStream(*list);
+
+	Common::MemoryReadStream listStream(listData.getData(), listData.size());
+	while (!listStream.eos()) {
+		const Common::UString file = Common::readStringLine(listStream, Common::kEncodingUTF8);
+
+		if (!file.empty())
+			files.push_back(file);
+	}
+}
+
+/** A file to convert in batch mode. */
+struct BatchJob {
+	Common::UString inFile;
+	Common::UString outFile;
+
+	Aurora::FileType type; ///< The type of the file, if known by its name.
+
+	size_t size;    ///< The size of the input file.
+	double seconds; ///< The time it took to convert the file.
+
+	std::exception_ptr error;
+	bool done;
 
-		if (type == Aurora::kFileTypeNone) {
-			// Detect by file name
-			type = detectType(inFile);
+	BatchJob(const Common::UString &i, const Common::UString &o, Aurora::FileType t) :
+		inFile(i), outFile(o), type(t), size(0), seconds(0.0), done(false) { }
+};
 
-			if (type == Aurora::kFileTypeNone)
-				throw Common::Exception("Failed to detect type of file \"%s\"", inFile.c_str());
+static void printBatchJob(const BatchJob &job, size_t number, size_t fileCount) {
+	std::printf("Converting %s/%s: %s ... ", Common::composeString(number).c_str(),
+	                                         Common::composeString(fileCount).c_str(),
+	                                         job.inFile.c_str());
+
+	if (!job.error) {
+		std::printf("Done (%.2f ms)\n", job.seconds * 1000.0);
+		return;
+	}
+
+	std::fflush(stdout);
+
+	try {
+		std::rethrow_exception(job.error);
+	} catch (Common::Exception &e) {
+		Common::printException(e, "");
+	} catch (std::exception &e) {
+		Common::Exception se(e);
+		Common::printException(se, "");
+	} catch (...) {
+		Common::Exception se("Unknown exception caught");
+		Common::printException(se, "");
+	}
+}
+
+void convertBatch(const std::vector<Common::UString> &inFiles, const Common::UString &batchDir,
+                  Aurora::FileType type, bool flip, bool deswizzle, bool rle, int mipMap, uint32_t threads) {
+
+	typedef std::chrono::steady_clock Clock;
+
+	const Clock::time_point batchStart = Clock::now();
+
+	Common::FilePath::createDirectories(batchDir);
+
+	/* Figure out the output file names and the types by file name up front,
+	 * in this thread. The type manager is not safe to be used concurrently. */
+
+	std::vector<BatchJob> jobs;
+	jobs.reserve(inFiles.size());
+
+	// Input files with the same name in different directories would overwrite each other's TGA
+	std::map<Common::UString, Common::UString> outFiles;
+
+	for (std::vector<Common::UString>::const_iterator f = inFiles.begin(); f != inFiles.end(); ++f) {
+		const Common::UString outFile = batchDir + "/" +
+			Common::FilePath::changeExtension(Common::FilePath::getFile(*f), ".tga");
+
+		std::pair<std::map<Common::UString, Common::UString>::const_iterator, bool> out =
+			outFiles.insert(std::make_pair(outFile, *f));
+		if (!out.second)
+			throw Common::Exception("\"%s\" and \"%s\" would both be converted into \"%s\"",
+			                        out.first->second.c_str(), f->c_str(), outFile.c_str());
+
+		jobs.push_back(BatchJob(*f, outFile, (type != Aurora::kFileTypeNone) ? type : detectType(*f)));
+	}
+
+	/* Print the progress in list order. Whichever thread finishes the job
+	 * we're waiting on also prints all the finished jobs following it. */
+
+	std::mutex printMutex;
+	size_t nextPrint = 0;
+
+	Common::runParallel(threads, jobs.size(), [&](size_t UNUSED(worker), size_t j) {
+		BatchJob &job = jobs[j];
+
+		const Clock::time_point start = Clock::now();
+
+		try {
+			Common::ReadFile in(job.inFile);
+			job.size = in.size();
+
+			const Aurora::FileType fileType = (type != Aurora::kFileTypeNone) ?
+				type : detectType(in, job.inFile, job.type);
+
+			// We're already running several files at once, so each one is decompressed in one thread
+			Images::convertToTGA(in, fileType, job.outFile, flip, deswizzle, rle, mipMap, 1);
+		} catch (...) {
+			job.error = std::current_exception();
 		}
+
+		job.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(printMutex);
+
+		job.done = true;
+		while ((nextPrint < jobs.size()) && jobs[nextPrint].done) {
+			printBatchJob(jobs[nextPrint], nextPrint + 1, jobs.size());
+			nextPrint++;
+		}
+	});
+
+	const double seconds = std::chrono::duration<double>(Clock::now() - batchStart).count();
+
+	size_t converted = 0, size = 0;
+	for (std::vector<BatchJob>::const_iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		if (j->error)
+			continue;
+
+		converted++;
+		size += j->size;
 	}
 
-	Common::ScopedPtr<Images::Decoder> image(openImage(in, type, deswizzle));
-	if (flip)
-		image->flipVertically();
+	std::printf("\nConverted %s of %s files (%s) in %.2f seconds: %.1f files/s, %s/s\n",
+	            Common::composeString(converted).c_str(), Common::composeString(jobs.size()).c_str(),
+	            Common::FilePath::getHumanReadableSize(size).c_str(), seconds,
+	            (seconds > 0.0) ? (converted / seconds) : 0.0,
+	            Common::FilePath::getHumanReadableSize((seconds > 0.0) ? (size_t) (size / seconds) : 0).c_str());
+
+	std::fflush(stdout);
 
-	image->dumpTGA(outFile);
+	if (converted != jobs.size())
+		throw Common::Exception("Failed to convert %s files", Common::composeString(jobs.size() - converted).c_str());
 }
@@ -0,0 +1,181 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of the archive extraction in Archives::extractFiles().
+ *
+ *  We create a synthetic, zlib-compressed V2.2 ERF with a given number of
+ *  resources in a temporary directory, and measure the time spent extracting
+ *  all of them there, once with a single thread and once with one thread per
+ *  CPU core (but at least two). The results are written as CSV, one line per archive size and
+ *  thread count; the bytes column holds the uncompressed size of all
+ *  resources together.
+ *
+ *  Since extractFiles() prints its progress on stdout, the results go to
+ *  stderr, unless written into a file with -o.
+ *
+ *  Usage: benchmark_extract [-i <iterations>] [-n <resources>] [-o <results.csv>]
+ *
+ *  Run without arguments, like as part of the unit tests, every extraction
+ *  only runs once, on an ERF with 64 resources, to make sure the benchmark
+ *  itself still works.
+ */
+
+#include <cstdlib>
+
+#include <vector>
+#include <set>
+
+#include <boost/filesystem.hpp>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/platform.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/filepath.h"
+#include "src/common/parallel.h"
+#include "src/common/writefile.h"
+#include "src/common/mappedreadstream.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/erffile.h"
+
+#include "src/archives/util.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** The size of each resource within the ERF. */
+static const size_t kResourceSize = 256 * 1024;
+
+static Common::UString getResourceName(size_t i) {
+	return Common::UString::format("resource%05u", (uint)i);
+}
+
+/** Make sure all resources have been extracted, since extractFiles() doesn't throw on failures. */
+static void checkExtracted(size_t resourceCount) {
+	for (size_t i = 0; i < resourceCount; i++) {
+		const Common::UString fileName = getResourceName(i) + ".utc";
+
+		if (Common::FilePath::getFileSize(fileName) != kResourceSize)
+			throw Common::Exception("Failed to extract \"%s\"", fileName.c_str());
+	}
+}
+
+/** Write an ERF with this many resources, and return their uncompressed size. */
+static size_t createERF(const Common::UString &fileName, size_t resourceCount) {
+	Common::WriteFile erf(fileName);
+
+	Aurora::ERFWriter writer(MKTAG('E', 'R', 'F', ' '), resourceCount, erf,
+	                         Aurora::ERFWriter::kERFVersion22, Aurora::ERFWriter::kCompressionBiowareZlib);
+
+	std::vector<byte> data(kResourceSize);
+
+	for (size_t i = 0; i < resourceCount; i++) {
+		// Random data with runs of equal bytes, so that it's compressible
+		for (size_t j = 0; j < data.size(); j++) {
+			if ((j > 0) && ((std::rand() % 4) != 0))
+				data[j] = data[j - 1];
+			else
+				data[j] = std::rand() & 0xFF;
+		}
+
+		Common::MemoryReadStream resource(&data[0], data.size());
+		writer.add(getResourceName(i), Aurora::kFileTypeUTC, resource);
+	}
+
+	erf.flush();
+
+	return resourceCount * kResourceSize;
+}
+
+static Aurora::Archive *openERF(const Common::UString &fileName) {
+	return new Aurora::ERFFile(new Common::MappedReadStream(fileName));
+}
+
+static void benchmark(Benchmark::Results &results, const Common::UString &fileName,
+                      size_t resourceCount, size_t iterations) {
+
+	const size_t bytes = createERF(fileName, resourceCount);
+
+	Common::ScopedPtr<Aurora::Archive> erf(openERF(fileName));
+	const Archives::ArchiveOpener opener = [&fileName]() {
+		return openERF(fileName);
+	};
+
+	// One thread, and one per core. Always at least two, so that the parallel extraction runs
+	std::vector<size_t> threadCounts;
+	threadCounts.push_back(1);
+	threadCounts.push_back(MAX<size_t>(Common::getHardwareThreadCount(), 2));
+
+	for (std::vector<size_t>::const_iterator t = threadCounts.begin(); t != threadCounts.end(); ++t) {
+		const double seconds = Benchmark::measure(iterations, [&]() {
+			Archives::extractFiles(*erf, Aurora::kGameIDUnknown, false, std::set<Common::UString>(), *t, opener);
+		});
+
+		checkExtracted(resourceCount);
+
+		results.write(Common::UString::format("%u,%u", (uint)resourceCount, (uint)*t), iterations, bytes, seconds);
+	}
+}
+
+int main(int argc, char **argv) {
+	boost::filesystem::path oldPath, tempPath;
+
+	try {
+		Common::Platform::init();
+
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, false, "resources");
+
+		if (options.counts.empty())
+			options.counts.push_back(64);
+
+		Benchmark::Results results(options.outFile, "resources,threads", true);
+
+		// Extract everything into a temporary directory
+		oldPath  = boost::filesystem::current_path();
+		tempPath = boost::filesystem::temp_directory_path() /
+		           boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		boost::filesystem::create_directories(tempPath);
+		boost::filesystem::current_path(tempPath);
+
+		std::srand(0);
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n)
+			benchmark(results, "benchmark.erf", *n, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	if (!tempPath.empty()) {
+		boost::filesystem::current_path(oldPath);
+		boost::filesystem::remove_all(tempPath);
+	}
+
+	return 0;
+}
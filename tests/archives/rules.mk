@@ -0,0 +1,32 @@
+# xoreos-tools - Tools to help with xoreos development
+#
+# xoreos-tools is the legal property of its developers, whose names
+# can be found in the AUTHORS file distributed with this source
+# distribution.
+#
+# xoreos-tools is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or (at your option) any later version.
+#
+# xoreos-tools is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+
+# Benchmarks for the Archives namespace.
+
+check_PROGRAMS                          += tests/archives/benchmark_extract
+tests_archives_benchmark_extract_SOURCES  = tests/archives/benchmark_extract.cpp
+tests_archives_benchmark_extract_LDADD    = \
+    $(benchmark_LIBS) \
+    src/archives/libarchives.la \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_archives_benchmark_extract_CXXFLAGS = $(AM_CXXFLAGS)
@@ -0,0 +1,203 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of the resource lookup in Aurora::Archive.
+ *
+ *  We create synthetic archives with a given number of resources, and
+ *  measure the time spent building the lookup index (i.e. the first call
+ *  to findResource()) and looking up every resource, by name and type and
+ *  by hash, both from one thread and from all hardware threads at once.
+ *  For comparison, we also measure a linear search through the resource
+ *  list, like findResource() used to do, on a fixed sample of resources.
+ *  The results are written as CSV, one line per archive size and stage;
+ *  the bytes column holds the number of lookups.
+ *
+ *  Usage: benchmark_archive [-i <iterations>] [-n <resources>] [-o <results.csv>]
+ *
+ *  The option -n can be given multiple times, to benchmark several sizes,
+ *  like -n 1000 -n 10000 -n 100000 -n 1000000.
+ *
+ *  Run without arguments, like as part of the unit tests, every stage only
+ *  runs once, on archives with 10^3 and 10^4 resources, to make sure the
+ *  benchmark itself still works.
+ */
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/hash.h"
+#include "src/common/parallel.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/archive.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** Number of resources looked up with the linear search. */
+static const size_t kLinearSampleCount = 100;
+
+/** An archive with only a resource list, but without any contents. */
+class BenchmarkArchive : public Aurora::Archive {
+public:
+	BenchmarkArchive(size_t resourceCount) {
+		static const Aurora::FileType kTypes[] = {
+			Aurora::kFileTypeUTC, Aurora::kFileTypeDLG, Aurora::kFileTypeNSS, Aurora::kFileTypeNCS
+		};
+
+		for (size_t i = 0; i < resourceCount; i++) {
+			_resources.push_back(Resource());
+
+			Resource &resource = _resources.back();
+
+			resource.name  = Common::UString::format("resource%07u", (uint)(i / ARRAYSIZE(kTypes)));
+			resource.type  = kTypes[i % ARRAYSIZE(kTypes)];
+			resource.hash  = Common::hashStringFNV64(resource.name + "." + Common::composeString((uint)resource.type));
+			resource.index = i;
+		}
+	}
+
+	const ResourceList &getResources() const {
+		return _resources;
+	}
+
+	Common::SeekableReadStream *getResource(uint32 UNUSED(index), bool UNUSED(tryNoCopy)) const {
+		throw Common::Exception("BenchmarkArchive has no resource contents");
+	}
+
+	Common::HashAlgo getNameHashAlgo() const {
+		return Common::kHashFNV64;
+	}
+
+private:
+	ResourceList _resources;
+};
+
+static void writeResult(Benchmark::Results &results, const char *stage, size_t resourceCount,
+                        size_t threads, size_t iterations, size_t lookups, double seconds) {
+
+	results.write(Common::UString::format("%s,%u,%u", stage, (uint)resourceCount, (uint)threads),
+	              iterations, lookups, seconds);
+}
+
+static void checkIndex(uint32 index, uint32 expected) {
+	if (index != expected)
+		throw Common::Exception("Found resource %u, expected %u", index, expected);
+}
+
+static void benchmark(Benchmark::Results &results, size_t resourceCount, size_t iterations) {
+	const BenchmarkArchive archive(resourceCount);
+	const Aurora::Archive::ResourceList &resources = archive.getResources();
+
+	// Build the index, with a fresh archive every time
+	double seconds = Benchmark::measure(iterations, [&]() {
+		BenchmarkArchive fresh(resourceCount);
+		checkIndex(fresh.findResource(resources.front().name, resources.front().type), 0);
+	});
+
+	// That includes creating the archive, so subtract that again
+	seconds -= Benchmark::measure(iterations, [&]() {
+		BenchmarkArchive fresh(resourceCount);
+	});
+
+	writeResult(results, "build", resourceCount, 1, iterations, 1, MAX(seconds, 0.0));
+
+	const std::vector<Aurora::Archive::Resource> lookups(resources.begin(), resources.end());
+
+	// Look up every resource by name and type, and by hash
+	seconds = Benchmark::measure(iterations, [&]() {
+		for (size_t i = 0; i < lookups.size(); i++)
+			checkIndex(archive.findResource(lookups[i].name, lookups[i].type), lookups[i].index);
+	});
+
+	writeResult(results, "name", resourceCount, 1, iterations, lookups.size(), seconds);
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		for (size_t i = 0; i < lookups.size(); i++)
+			checkIndex(archive.findResource(lookups[i].hash), lookups[i].index);
+	});
+
+	writeResult(results, "hash", resourceCount, 1, iterations, lookups.size(), seconds);
+
+	/* The same, but from all threads at once, on a fresh archive so that they race for building
+	 * the index. This includes creating the archive and building the index. */
+	const size_t threads = Common::getHardwareThreadCount();
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		const BenchmarkArchive fresh(resourceCount);
+
+		Common::runParallel(threads, lookups.size(), [&](size_t UNUSED(worker), size_t i) {
+			checkIndex(fresh.findResource(lookups[i].name, lookups[i].type), lookups[i].index);
+		});
+	});
+
+	writeResult(results, "name_parallel", resourceCount, threads, iterations, lookups.size(), seconds);
+
+	// A linear search through the resource list, on an evenly spread sample
+	const size_t sampleCount = MIN(kLinearSampleCount, lookups.size());
+	const size_t sampleStep  = lookups.size() / sampleCount;
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		for (size_t i = 0; i < sampleCount; i++) {
+			const Aurora::Archive::Resource &lookup = lookups[i * sampleStep];
+
+			uint32 index = 0xFFFFFFFF;
+			for (Aurora::Archive::ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+				if ((r->type == lookup.type) && r->name.equalsIgnoreCase(lookup.name)) {
+					index = r->index;
+					break;
+				}
+			}
+
+			checkIndex(index, lookup.index);
+		}
+	});
+
+	writeResult(results, "name_linear", resourceCount, 1, iterations, sampleCount, seconds);
+}
+
+int main(int argc, char **argv) {
+	try {
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, false, "resources");
+
+		if (options.counts.empty()) {
+			options.counts.push_back(1000);
+			options.counts.push_back(10000);
+		}
+
+		Benchmark::Results results(options.outFile, "stage,resources,threads");
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n)
+			benchmark(results, *n, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	return 0;
+}
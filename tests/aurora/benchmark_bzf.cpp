@@ -0,0 +1,131 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of the LZMA decompression in BZFFile::getResource().
+ *
+ *  We write a synthetic BZF with a given number of resources into memory,
+ *  and measure the time spent decompressing all of them, once with a single
+ *  thread and once with one thread per CPU core (but at least two). The
+ *  results are written as CSV, one line per archive size and thread count;
+ *  the bytes column holds the uncompressed size of all resources together.
+ *
+ *  Usage: benchmark_bzf [-i <iterations>] [-n <resources>] [-o <results.csv>]
+ *
+ *  Run without arguments, like as part of the unit tests, every stage only
+ *  runs once, on a BZF with 8 resources, to make sure the benchmark itself
+ *  still works.
+ */
+
+#include <cstdlib>
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/parallel.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/bzfwriter.h"
+#include "src/aurora/bzffile.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** The size of each resource within the BZF. */
+static const size_t kResourceSize = 256 * 1024;
+
+/** Write a BZF with this many resources into memory. */
+static Aurora::BZFFile *createBZF(size_t resourceCount) {
+	Common::MemoryWriteStreamDynamic bzf(true);
+
+	Aurora::BZFWriter writer(resourceCount, bzf);
+
+	std::vector<byte> data(kResourceSize);
+
+	for (size_t i = 0; i < resourceCount; i++) {
+		// Random data with runs of equal bytes, so that it's compressible
+		for (size_t j = 0; j < data.size(); j++) {
+			if ((j > 0) && ((std::rand() % 4) != 0))
+				data[j] = data[j - 1];
+			else
+				data[j] = std::rand() & 0xFF;
+		}
+
+		Common::MemoryReadStream resource(&data[0], data.size());
+		writer.add(resource, Aurora::kFileTypeUTC);
+	}
+
+	bzf.setDisposable(false);
+
+	return new Aurora::BZFFile(new Common::MemoryReadStream(bzf.getData(), bzf.size(), true));
+}
+
+static void benchmark(Benchmark::Results &results, size_t resourceCount, size_t iterations) {
+	Common::ScopedPtr<Aurora::BZFFile> bzf(createBZF(resourceCount));
+
+	const size_t bytes = resourceCount * kResourceSize;
+
+	// One thread, and one per core. Always at least two, so that the parallel decompression runs
+	std::vector<size_t> threadCounts;
+	threadCounts.push_back(1);
+	threadCounts.push_back(MAX<size_t>(Common::getHardwareThreadCount(), 2));
+
+	for (std::vector<size_t>::const_iterator t = threadCounts.begin(); t != threadCounts.end(); ++t) {
+		const double seconds = Benchmark::measure(iterations, [&]() {
+			Common::runParallel(*t, resourceCount, [&](size_t UNUSED(worker), size_t job) {
+				Common::ScopedPtr<Common::SeekableReadStream> resource(bzf->getResource(job));
+
+				if (resource->size() != kResourceSize)
+					throw Common::Exception("Resource %u has the wrong size (%u)", (uint)job, (uint)resource->size());
+			});
+		});
+
+		results.write(Common::UString::format("%u,%u", (uint)resourceCount, (uint)*t), iterations, bytes, seconds);
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, false, "resources");
+
+		if (options.counts.empty())
+			options.counts.push_back(8);
+
+		Benchmark::Results results(options.outFile, "resources,threads");
+
+		std::srand(0);
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n)
+			benchmark(results, *n, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	return 0;
+}
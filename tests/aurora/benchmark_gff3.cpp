@@ -0,0 +1,264 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of our GFF3 writer.
+ *
+ *  We create synthetic GFF3s with a given number of fields, and measure
+ *  the time spent building them up in a GFF3Writer, writing them out,
+ *  reading them back in with a GFF3File and walking over all their fields,
+ *  each of those stages separately. Additionally, we measure the time spent
+ *  querying a single top-level value, both when loading the GFF3 completely
+ *  and when loading it lazily.
+ *  The results are written as CSV, one line per GFF3 and stage, so that
+ *  they can be tracked and compared between builds.
+ *
+ *  Usage: benchmark_gff3 [-i <iterations>] [-n <fields>] [-o <results.csv>]
+ *
+ *  The option -n can be given multiple times, to benchmark several sizes,
+ *  like -n 100000 -n 1000000.
+ *
+ *  Run without arguments, like as part of the unit tests, every stage only
+ *  runs once, on GFF3s with 10^4 fields, to make sure the benchmark itself
+ *  still works.
+ */
+
+#include <cstring>
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/language.h"
+#include "src/aurora/locstring.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** A kind of GFF3 to benchmark. */
+struct GFF3Kind {
+	const char *name;
+
+	/** Fill the writer with (about) this many fields, and return the actual number.
+	 *
+	 *  Like for GFF3Struct::getFieldCount(), structs in lists don't count as fields.
+	 */
+	size_t (*create)(Aurora::GFF3Writer &writer, size_t fieldCount);
+};
+
+
+/** A list of object instances, like in a module's .git file.
+ *
+ *  Some values, like the tags, are unique, while others, like the names
+ *  and templates, repeat.
+ */
+static size_t createInstances(Aurora::GFF3Writer &writer, size_t fieldCount) {
+	static const size_t kFieldsPerInstance = 11;
+
+	Aurora::LocString names[16];
+	for (size_t i = 0; i < ARRAYSIZE(names); i++)
+		names[i].setString(Aurora::kLanguageEnglish, Common::UString::format("Creature %u", (uint)i));
+
+	writer.getTopLevel()->addExoString("Name", "Instances");
+
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("Creature List");
+
+	const size_t instanceCount = MAX<size_t>(fieldCount / kFieldsPerInstance, 1);
+	for (size_t i = 0; i < instanceCount; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", 4);
+
+		// Small void data blobs, each of which is used by a few instances
+		byte *data = new byte[8];
+		std::memset(data, 0, 8);
+		data[0] = i & 0xFF;
+
+		strct->addExoString("Tag", Common::UString::format("creature_%u", (uint)i));
+		strct->addLocString("LocName", names[i % ARRAYSIZE(names)]);
+		strct->addResRef("TemplateResRef", Common::UString::format("c_template%02u", (uint)(i % 64)));
+		strct->addFloat("XPosition", (float) (i % 256));
+		strct->addFloat("YPosition", (float) (i / 256));
+		strct->addFloat("ZPosition", 0.0f);
+		strct->addOrientation("Orientation", 0.0f, 0.0f, (float) (i % 4), 1.0f);
+		strct->addUint64("ObjectId", 0x7F000000 + i);
+		strct->addUint16("Appearance", i % 32);
+		strct->addExoString("Comment", (i % 8) ? "" : "Needs a better script");
+		strct->addVoid("Data", new Common::MemoryReadStream(data, 8, true));
+	}
+
+	return instanceCount * kFieldsPerInstance + 2;
+}
+
+/** Structs with many different labels and values. */
+static size_t createLabels(Aurora::GFF3Writer &writer, size_t fieldCount) {
+	static const size_t kFieldsPerStruct = 100;
+
+	writer.getTopLevel()->addExoString("Name", "Labels");
+
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("List");
+
+	const size_t structCount = MAX<size_t>(fieldCount / kFieldsPerStruct, 1);
+	for (size_t i = 0; i < structCount; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("");
+
+		for (size_t j = 0; j < kFieldsPerStruct; j++) {
+			const size_t n = i * kFieldsPerStruct + j;
+
+			strct->addSint64(Common::UString::format("Field%u", (uint)n), n % 1024);
+		}
+	}
+
+	return structCount * kFieldsPerStruct + 2;
+}
+
+static const GFF3Kind kGFF3Kinds[] = {
+	{ "instances", &createInstances },
+	{ "labels"   , &createLabels    }
+};
+
+
+/** Read all fields of this struct and its children, by name, like gff2xml does. */
+static size_t walkStruct(const Aurora::GFF3Struct &strct) {
+	size_t fieldCount = 0;
+
+	const std::vector<Common::UString> &fields = strct.getFieldNames();
+	for (std::vector<Common::UString>::const_iterator f = fields.begin(); f != fields.end(); ++f) {
+		fieldCount++;
+
+		switch (strct.getFieldType(*f)) {
+			case Aurora::GFF3Struct::kFieldTypeStruct:
+				fieldCount += walkStruct(strct.getStruct(*f));
+				break;
+
+			case Aurora::GFF3Struct::kFieldTypeList: {
+					const Aurora::GFF3List &list = strct.getList(*f);
+					for (Aurora::GFF3List::const_iterator s = list.begin(); s != list.end(); ++s)
+						fieldCount += walkStruct(**s);
+				}
+				break;
+
+			case Aurora::GFF3Struct::kFieldTypeVoid:
+				delete strct.getData(*f);
+				break;
+
+			default:
+				strct.getString(*f);
+				break;
+		}
+	}
+
+	return fieldCount;
+}
+
+static void writeResult(Benchmark::Results &results, const GFF3Kind &kind, const char *stage,
+                        size_t fieldCount, size_t iterations, size_t bytes, double seconds) {
+
+	results.write(Common::UString::format("%s,%s,%u", kind.name, stage, (uint)fieldCount), iterations, bytes, seconds);
+}
+
+static void benchmark(Benchmark::Results &out, const GFF3Kind &kind, size_t fields, size_t iterations) {
+	// Build up the GFF3 in the writer
+	Common::ScopedPtr<Aurora::GFF3Writer> writer;
+	size_t fieldCount = 0;
+
+	const double buildSeconds = Benchmark::measure(iterations, [&]() {
+		writer.reset(new Aurora::GFF3Writer(MKTAG('G', 'I', 'T', ' '), MKTAG('V', '3', '.', '2')));
+		fieldCount = kind.create(*writer, fields);
+	});
+
+	// Write the GFF3 out
+	Common::MemoryWriteStreamDynamic gff3(true);
+
+	double seconds = Benchmark::measure(iterations, [&]() {
+		gff3.seek(0);
+		writer->write(gff3);
+	});
+
+	writeResult(out, kind, "build", fieldCount, iterations, gff3.size(), buildSeconds);
+	writeResult(out, kind, "write", fieldCount, iterations, gff3.size(), seconds);
+
+	// Read the GFF3 back in
+	Common::ScopedPtr<Aurora::GFF3File> gff;
+	seconds = Benchmark::measure(iterations, [&]() {
+		gff.reset(new Aurora::GFF3File(new Common::MemoryReadStream(gff3.getData(), gff3.size())));
+	});
+
+	writeResult(out, kind, "read", fieldCount, iterations, gff3.size(), seconds);
+
+	// Walk over all fields
+	size_t walkedCount = 0;
+	seconds = Benchmark::measure(iterations, [&]() {
+		walkedCount = walkStruct(gff->getTopLevel());
+	});
+
+	if (walkedCount != fieldCount)
+		throw Common::Exception("Walked over %u fields, expected %u", (uint)walkedCount, (uint)fieldCount);
+
+	writeResult(out, kind, "walk", fieldCount, iterations, gff3.size(), seconds);
+
+	// Only query the name, once loading the GFF3 fully, and once lazily
+	Common::UString name;
+	seconds = Benchmark::measure(iterations, [&]() {
+		Aurora::GFF3File query(new Common::MemoryReadStream(gff3.getData(), gff3.size()));
+		name = query.getTopLevel().getString("Name");
+	});
+
+	writeResult(out, kind, "query", fieldCount, iterations, gff3.size(), seconds);
+
+	Common::UString lazyName;
+	seconds = Benchmark::measure(iterations, [&]() {
+		Aurora::GFF3File query(new Common::MemoryReadStream(gff3.getData(), gff3.size()), 0xFFFFFFFF, false, true);
+		lazyName = query.getTopLevel().getString("Name");
+	});
+
+	if (lazyName != name)
+		throw Common::Exception("Lazily queried name \"%s\" != \"%s\"", lazyName.c_str(), name.c_str());
+
+	writeResult(out, kind, "query_lazy", fieldCount, iterations, gff3.size(), seconds);
+}
+
+int main(int argc, char **argv) {
+	try {
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, false, "fields");
+
+		if (options.counts.empty())
+			options.counts.push_back(10000);
+
+		Benchmark::Results results(options.outFile, "gff3,stage,fields");
+
+		for (std::vector<size_t>::const_iterator f = options.counts.begin(); f != options.counts.end(); ++f)
+			for (size_t i = 0; i < ARRAYSIZE(kGFF3Kinds); i++)
+				benchmark(results, kGFF3Kinds[i], *f, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	return 0;
+}
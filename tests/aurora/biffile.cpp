@@ -22,10 +22,14 @@
  *  Unit tests for our BIF file archive class.
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
+#include "src/common/parallel.h"
 
 #include "src/aurora/biffile.h"
 #include "src/aurora/keyfile.h"
@@ -161,6 +165,27 @@ GTEST_TEST(BIFFile10, getResource) {
 	delete file;
 }
 
+GTEST_TEST(BIFFile10, getResourceThreaded) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kBIF10File);
+	const Aurora::BIFFile bif(stream);
+
+	// Many threads reading from the same BIF at the same time
+	std::vector<int> correct(64, 0);
+
+	Common::runParallel(4, correct.size(), [&](size_t UNUSED(worker), size_t job) {
+		Common::ScopedPtr<Common::SeekableReadStream> file(bif.getResource(0, (job % 2) == 0));
+
+		int same = file->size() == strlen(kFileData);
+		for (size_t i = 0; same && (i < strlen(kFileData)); i++)
+			same = file->readByte() == (byte)kFileData[i];
+
+		correct[job] = same;
+	});
+
+	for (size_t i = 0; i < correct.size(); i++)
+		EXPECT_TRUE(correct[i]) << "At job " << i;
+}
+
 GTEST_TEST(BIFFile10, mergeKEY) {
 	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kBIF10File);
 	Aurora::BIFFile bif(stream);
@@ -168,6 +193,8 @@ GTEST_TEST(BIFFile10, mergeKEY) {
 	Common::MemoryReadStream keyStream(kKEYFile);
 	Aurora::KEYFile key(keyStream);
 
+	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeTXT), 0xFFFFFFFF);
+
 	bif.mergeKEY(key, 0);
 
 	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
@@ -294,6 +321,8 @@ GTEST_TEST(BIFFile11, mergeKEY) {
 	Common::MemoryReadStream keyStream(kKEYFile);
 	Aurora::KEYFile key(keyStream);
 
+	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeTXT), 0xFFFFFFFF);
+
 	bif.mergeKEY(key, 0);
 
 	EXPECT_EQ(bif.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
@@ -27,6 +27,7 @@
 #include "src/common/error.h"
 #include "src/common/hash.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 
 #include "src/aurora/locstring.h"
 #include "src/aurora/language.h"
@@ -212,6 +213,46 @@ GTEST_TEST(ERFFile10, getResource) {
 	delete file;
 }
 
+GTEST_TEST(ERFFile10, readIndex) {
+	LangMan.addLanguage(Aurora::kLanguageEnglish, 0, Common::kEncodingUTF8);
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(kERFFile10));
+
+	Common::MemoryWriteStreamDynamic index(true);
+	ASSERT_TRUE(erf.writeIndex(index));
+
+	Common::MemoryReadStream indexStream(index.getData(), index.size());
+	const Aurora::ERFFile indexERF(new Common::MemoryReadStream(kERFFile10), indexStream);
+
+	EXPECT_EQ(indexERF.getID(), erf.getID());
+	EXPECT_EQ(indexERF.getVersion(), erf.getVersion());
+	EXPECT_EQ(indexERF.getBuildYear(), 2000);
+	EXPECT_EQ(indexERF.getBuildDay(), 23);
+
+	EXPECT_STREQ(indexERF.getDescription().getString().c_str(), "xoreos unit test");
+
+	const Aurora::ERFFile::ResourceList &resources = indexERF.getResources();
+	ASSERT_EQ(resources.size(), 1);
+
+	EXPECT_STREQ(resources.begin()->name.c_str(), "ozymandias");
+	EXPECT_EQ(resources.begin()->type, Aurora::kFileTypeTXT);
+	EXPECT_EQ(resources.begin()->index, 0);
+
+	EXPECT_EQ(indexERF.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
+
+	Common::SeekableReadStream *file = indexERF.getResource(0);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	delete file;
+
+	Aurora::LanguageManager::destroy();
+}
+
 GTEST_TEST(ERFFile10, typeMOD) {
 	static const byte kERF[] = {
 		0x4D,0x4F,0x44,0x20,0x56,0x31,0x2E,0x30,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
@@ -1209,6 +1250,24 @@ GTEST_TEST(ERFFile22DeflateHeader, getResource) {
 	delete file;
 }
 
+GTEST_TEST(ERFFile22DeflateHeader, getResourceNoCopy) {
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(kERFFile22DH));
+
+	// Decompressed on demand, while reading
+	Common::SeekableReadStream *file = erf.getResource(0, true);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	file->seek(0);
+	EXPECT_EQ(file->readByte(), kFileData[0]);
+
+	delete file;
+}
+
 // --- ERF V2.2 (DEFLATE, raw) ---
 
 // Percy Bysshe Shelley's "Ozymandias", within an ERF V2.2 (DEFLATE, raw) file
@@ -2213,6 +2272,24 @@ GTEST_TEST(ERFFile30DeflateRaw, getResource) {
 	delete file;
 }
 
+GTEST_TEST(ERFFile30DeflateRaw, getResourceNoCopy) {
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(kERFFile30DR));
+
+	// Decompressed on demand, while reading
+	Common::SeekableReadStream *file = erf.getResource(0, true);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	file->seek(0);
+	EXPECT_EQ(file->readByte(), kFileData[0]);
+
+	delete file;
+}
+
 // --- ERF V3.0 (Blowfish) ---
 
 // Percy Bysshe Shelley's "Ozymandias", within an ERF V3.0 (Blowfish) file
@@ -27,12 +27,16 @@
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
+#include "src/common/endianness.h"
 #include "src/common/error.h"
+#include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 
 #include "src/aurora/locstring.h"
 #include "src/aurora/language.h"
 #include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
 
 // --- GFF3, single struct ---
 
@@ -147,6 +151,34 @@ GTEST_TEST(GFF3Struct, hasField) {
 	EXPECT_FALSE(strct.hasField("Nope"));
 }
 
+GTEST_TEST(GFF3Struct, findLabelID) {
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	const uint32 labelUint16 = gff3.findLabelID("FieldUint16");
+	const uint32 labelString = gff3.findLabelID("FieldExoString");
+	const uint32 labelNope   = gff3.findLabelID("Nope");
+
+	ASSERT_NE(labelUint16, Aurora::GFF3File::kLabelNone);
+	ASSERT_NE(labelString, Aurora::GFF3File::kLabelNone);
+	EXPECT_NE(labelUint16, labelString);
+	EXPECT_EQ(labelNope, Aurora::GFF3File::kLabelNone);
+
+	EXPECT_TRUE(strct.hasField(labelUint16));
+	EXPECT_FALSE(strct.hasField(labelNope));
+
+	EXPECT_EQ(strct.getFieldType(labelUint16), Aurora::GFF3Struct::kFieldTypeUint16);
+	EXPECT_EQ(strct.getFieldType(labelNope), Aurora::GFF3Struct::kFieldTypeNone);
+
+	EXPECT_EQ(strct.getUint(labelUint16), strct.getUint("FieldUint16"));
+	EXPECT_EQ(strct.getUint(labelNope, 99), 99);
+
+	EXPECT_EQ(strct.getString(labelString), strct.getString("FieldExoString"));
+	EXPECT_EQ(strct.getString(labelNope, "Default"), "Default");
+
+	EXPECT_THROW(strct.getUint(labelString), Common::Exception);
+}
+
 GTEST_TEST(GFF3Struct, getFieldNames) {
 	Aurora::GFF3File gff3(new Common::MemoryReadStream(kGFF3SingleStruct));
 	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
@@ -654,3 +686,146 @@ GTEST_TEST(GFF3File, GFF3V33) {
 	EXPECT_EQ(strct.getID(), 23);
 	EXPECT_EQ(strct.getUint("FieldUint32"), 32);
 }
+
+// --- GFF3, duplicate labels ---
+
+GTEST_TEST(GFF3Struct, duplicateLabels) {
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '), MKTAG('V', '3', '.', '2'));
+
+	// A small struct, with a linear field search
+	Aurora::GFF3WriterStructPtr small = writer.getTopLevel()->addStruct("Small");
+	small->addUint32("FieldA", 1);
+	small->addUint32("FieldB", 2);
+	small->addUint32("FieldA", 3);
+
+	// A larger struct, with a field index
+	Aurora::GFF3WriterStructPtr large = writer.getTopLevel()->addStruct("Large");
+	for (uint32 i = 0; i < 40; i++)
+		large->addUint32(Common::UString::format("Field%u", i), i);
+
+	large->addUint32("Field5", 100);
+	large->addUint32("Field7", 101);
+	large->addUint32("Field5", 102);
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	writer.write(writeStream);
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+
+	const Aurora::GFF3Struct &strctSmall = gff3.getTopLevel().getStruct("Small");
+
+	ASSERT_EQ(strctSmall.getFieldCount(), 2);
+	EXPECT_STREQ(strctSmall.getFieldNames()[0].c_str(), "FieldA");
+	EXPECT_STREQ(strctSmall.getFieldNames()[1].c_str(), "FieldB");
+	EXPECT_EQ(strctSmall.getUint("FieldA"), 3);
+	EXPECT_EQ(strctSmall.getUint("FieldB"), 2);
+	EXPECT_FALSE(strctSmall.hasField("Field5"));
+
+	const Aurora::GFF3Struct &strctLarge = gff3.getTopLevel().getStruct("Large");
+
+	ASSERT_EQ(strctLarge.getFieldCount(), 40);
+	for (uint32 i = 0; i < 40; i++) {
+		const Common::UString name = Common::UString::format("Field%u", i);
+
+		EXPECT_EQ(strctLarge.getFieldNames()[i], name) << "At index " << i;
+
+		if      (i == 5)
+			EXPECT_EQ(strctLarge.getUint(name), 102);
+		else if (i == 7)
+			EXPECT_EQ(strctLarge.getUint(name), 101);
+		else
+			EXPECT_EQ(strctLarge.getUint(name), i) << "At index " << i;
+	}
+
+	EXPECT_FALSE(strctLarge.hasField("FieldA"));
+	EXPECT_FALSE(strctLarge.hasField("Nope"));
+}
+
+// --- GFF3, lazy loading ---
+
+static void createLazyGFF3(Common::MemoryWriteStreamDynamic &stream) {
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '), MKTAG('V', '3', '.', '2'));
+
+	Aurora::GFF3WriterStructPtr top = writer.getTopLevel();
+	top->addExoString("Name", "Lazy");
+
+	Aurora::GFF3WriterListPtr list = top->addList("List");
+	for (uint32 i = 0; i < 3; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", 100 + i);
+
+		strct->addUint32("FieldUint32", i);
+		strct->addExoString("FieldExoString", Common::UString::format("String%u", i));
+	}
+
+	top->addStruct("Struct", 200)->addSint32("FieldSint32", -23);
+
+	writer.write(stream);
+}
+
+GTEST_TEST(GFF3File, lazy) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	createLazyGFF3(stream);
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(stream.getData(), stream.size()), 0xFFFFFFFF, false, true);
+	const Aurora::GFF3Struct &top = gff3.getTopLevel();
+
+	EXPECT_EQ(top.getFieldCount(), 3);
+	EXPECT_EQ(top.getString("Name"), "Lazy");
+	EXPECT_FALSE(top.hasField("FieldUint32"));
+
+	const Aurora::GFF3List &list = top.getList("List");
+	ASSERT_EQ(list.size(), 3);
+
+	for (uint32 i = 0; i < 3; i++) {
+		EXPECT_EQ(list[i]->getID(), 100 + i);
+		EXPECT_EQ(list[i]->getUint("FieldUint32"), i);
+		EXPECT_EQ(list[i]->getString("FieldExoString"), Common::UString::format("String%u", i));
+	}
+
+	// Accessing the list again gives us the same structs
+	EXPECT_EQ(&top.getList("List"), &list);
+	EXPECT_EQ(top.getList("List")[1], list[1]);
+
+	const Aurora::GFF3Struct &strct = top.getStruct("Struct");
+	EXPECT_EQ(strct.getID(), 200);
+	EXPECT_EQ(strct.getSint("FieldSint32"), -23);
+	EXPECT_EQ(&top.getStruct("Struct"), &strct);
+}
+
+GTEST_TEST(GFF3File, lazyFindLabelID) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	createLazyGFF3(stream);
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(stream.getData(), stream.size()), 0xFFFFFFFF, false, true);
+
+	// The label is only used by structs that haven't been read yet
+	const uint32 label = gff3.findLabelID("FieldUint32");
+	ASSERT_NE(label, Aurora::GFF3File::kLabelNone);
+
+	EXPECT_EQ(gff3.findLabelID("Nope"), Aurora::GFF3File::kLabelNone);
+
+	const Aurora::GFF3List &list = gff3.getTopLevel().getList("List");
+	ASSERT_EQ(list.size(), 3);
+
+	for (uint32 i = 0; i < 3; i++)
+		EXPECT_EQ(list[i]->getUint(label), i);
+}
+
+GTEST_TEST(GFF3File, lazyBroken) {
+	Common::MemoryWriteStreamDynamic stream(true);
+	createLazyGFF3(stream);
+
+	// Break the field index of the last struct, which only has one field
+	static const size_t kStructCount = 5;
+	WRITE_LE_UINT32(stream.getData() + 56 + (kStructCount - 1) * 12 + 4, 0x00FFFFFF);
+
+	EXPECT_THROW(Aurora::GFF3File(new Common::MemoryReadStream(stream.getData(), stream.size())), Common::Exception);
+
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(stream.getData(), stream.size()), 0xFFFFFFFF, false, true);
+	const Aurora::GFF3Struct &top = gff3.getTopLevel();
+
+	EXPECT_EQ(top.getString("Name"), "Lazy");
+	EXPECT_EQ(top.getList("List").size(), 3);
+
+	EXPECT_THROW(top.getStruct("Struct"), Common::Exception);
+}
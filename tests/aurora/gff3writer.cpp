@@ -28,6 +28,7 @@
 
 #include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 #include "src/common/writefile.h"
@@ -348,3 +349,69 @@ GTEST_TEST(GFF3Writer, WriteEquivalentValues) {
 
 	delete writeStream;
 }
+
+GTEST_TEST(GFF3Writer, WriteSharedData) {
+	static const byte vData1[8] = { '!', '[', 'D', 'A', 'T', 'A', ']', '!' };
+	static const byte vData2[8] = { '!', '[', 'D', 'A', 'T', 'A', ']', '!' };
+	static const byte vData3[4] = { 'D', 'A', 'T', 'A' };
+
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '), MKTAG('V', '3', '.', '2'));
+	Aurora::GFF3WriterStructPtr strct = writer.getTopLevel();
+
+	Aurora::LocString locString1, locString2;
+	locString1.setString(Aurora::kLanguageEnglish, Aurora::kLanguageGenderMale, "Test");
+	locString2.setString(Aurora::kLanguageGerman, Aurora::kLanguageGenderMale, "Test");
+
+	strct->addExoString("FieldExoString", "Foobar");
+	strct->addLocString("FieldLocString", locString1);
+	strct->addVoid("FieldVoid", new Common::MemoryReadStream(vData1));
+
+	Aurora::GFF3WriterStructPtr strct2 = strct->addStruct("Struct");
+
+	// Equal in content, but different streams: shared
+	strct2->addExoString("FieldExoString", "Foobar");
+	strct2->addLocString("FieldLocString", locString1);
+	strct2->addVoid("FieldVoid", new Common::MemoryReadStream(vData2));
+
+	// Different in content: not shared
+	strct2->addExoString("FieldExoString2", "Barfoo");
+	strct2->addLocString("FieldLocString2", locString2);
+	strct2->addVoid("FieldVoid2", new Common::MemoryReadStream(vData3));
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	writer.write(writeStream);
+
+	Common::MemoryReadStream gffStream(writeStream.getData(), writeStream.size());
+
+	// 7 labels, and field data for 2 ExoStrings, 2 LocStrings and 2 voids
+	EXPECT_EQ(gffStream.readUint32BE(), MKTAG('G', 'F', 'F', ' '));
+	gffStream.skip(24);
+	EXPECT_EQ(gffStream.readUint32LE(), 7U);
+	gffStream.skip(4);
+	EXPECT_EQ(gffStream.readUint32LE(), 2 * (4 + 6) + 2 * (12 + 8 + 4) + (4 + 8) + (4 + 4));
+
+	Aurora::GFF3File gff(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+
+	const Aurora::GFF3Struct &gffStrct2 = gff.getTopLevel().getStruct("Struct");
+	EXPECT_EQ(gff.getTopLevel().getString("FieldExoString"), "Foobar");
+	EXPECT_EQ(gffStrct2.getString("FieldExoString"), "Foobar");
+	EXPECT_EQ(gffStrct2.getString("FieldExoString2"), "Barfoo");
+
+	Aurora::LocString loc1, loc2, loc3;
+	EXPECT_TRUE(gff.getTopLevel().getLocString("FieldLocString", loc1));
+	EXPECT_TRUE(gffStrct2.getLocString("FieldLocString", loc2));
+	EXPECT_TRUE(gffStrct2.getLocString("FieldLocString2", loc3));
+	EXPECT_EQ(loc1, locString1);
+	EXPECT_EQ(loc2, locString1);
+	EXPECT_EQ(loc3, locString2);
+
+	Common::ScopedPtr<Common::SeekableReadStream> data1(gff.getTopLevel().getData("FieldVoid"));
+	Common::ScopedPtr<Common::SeekableReadStream> data2(gffStrct2.getData("FieldVoid"));
+	Common::ScopedPtr<Common::SeekableReadStream> data3(gffStrct2.getData("FieldVoid2"));
+	ASSERT_EQ(data1->size(), 8U);
+	ASSERT_EQ(data2->size(), 8U);
+	ASSERT_EQ(data3->size(), 4U);
+	EXPECT_EQ(data1->readUint32BE(), MKTAG('!', '[', 'D', 'A'));
+	EXPECT_EQ(data2->readUint32BE(), MKTAG('!', '[', 'D', 'A'));
+	EXPECT_EQ(data3->readUint32BE(), MKTAG('D', 'A', 'T', 'A'));
+}
@@ -27,6 +27,7 @@
 #include "src/common/error.h"
 #include "src/common/hash.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 
 #include "src/aurora/herffile.h"
 
@@ -286,3 +287,43 @@ GTEST_TEST(HERFFileWithDict, getResource) {
 
 	delete file;
 }
+
+GTEST_TEST(HERFFileWithDict, readIndex) {
+	const Aurora::HERFFile herf(new Common::MemoryReadStream(kHERFFileWithDict));
+
+	Common::MemoryWriteStreamDynamic index(true);
+	herf.writeIndex(index);
+
+	Common::MemoryReadStream indexStream(index.getData(), index.size());
+	const Aurora::HERFFile indexHERF(new Common::MemoryReadStream(kHERFFileWithDict), indexStream);
+
+	const Aurora::HERFFile::ResourceList &resources = indexHERF.getResources();
+	ASSERT_EQ(resources.size(), 2);
+
+	Aurora::HERFFile::ResourceList::const_iterator resourceIterator = resources.begin();
+
+	const Aurora::HERFFile::Resource &resource1 = *resourceIterator++;
+
+	EXPECT_STREQ(resource1.name.c_str(), "ozymandias");
+	EXPECT_EQ(resource1.type, Aurora::kFileTypeTXT);
+	EXPECT_EQ(resource1.hash, Common::hashStringDJB2("ozymandias.txt"));
+	EXPECT_EQ(resource1.index, 0);
+
+	const Aurora::HERFFile::Resource &resource2 = *resourceIterator++;
+
+	EXPECT_STREQ(resource2.name.c_str(), "erf");
+	EXPECT_EQ(resource2.type, Aurora::kFileTypeDICT);
+	EXPECT_EQ(resource2.index, 1);
+
+	EXPECT_EQ(indexHERF.getResourceSize(0), strlen(kFileData));
+
+	Common::SeekableReadStream *file = indexHERF.getResource(0);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	delete file;
+}
@@ -0,0 +1,148 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our persistent archive index cache.
+ */
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/platform.h"
+#include "src/common/scopedptr.h"
+#include "src/common/readstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/indexcache.h"
+
+static const uint32 kIndexType = MKTAG('T', 'E', 'S', 'T');
+
+static const byte kIndexData[] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF };
+
+boost::filesystem::path kTempPath;
+
+class IndexCache : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kTempPath = tmpPath / uniquePath;
+
+		boost::filesystem::create_directories(kTempPath);
+	}
+
+	static void TearDownTestCase() {
+		if (!kTempPath.empty())
+			boost::filesystem::remove_all(kTempPath);
+	}
+
+	static void writeArchive(const boost::filesystem::path &file, size_t size) {
+		boost::filesystem::ofstream archive(file, std::ofstream::binary);
+
+		for (size_t i = 0; i < size; i++)
+			archive.put((char) i);
+	}
+
+	static void writeIndex(Aurora::IndexCache &cache, const boost::filesystem::path &file, uint32 type) {
+		Common::MemoryWriteStreamDynamic index(true);
+		index.write(kIndexData, sizeof(kIndexData));
+
+		cache.putIndex(file.generic_string(), type, index);
+	}
+};
+
+GTEST_TEST_F(IndexCache, getIndex) {
+	ASSERT_FALSE(kTempPath.empty());
+
+	const boost::filesystem::path archive = kTempPath / "getIndex.erf";
+	writeArchive(archive, 64);
+
+	Aurora::IndexCache cache((kTempPath / "cache").generic_string());
+
+	Common::ScopedPtr<Common::SeekableReadStream> index(cache.getIndex(archive.generic_string(), kIndexType));
+	EXPECT_FALSE(index);
+
+	writeIndex(cache, archive, kIndexType);
+
+	index.reset(cache.getIndex(archive.generic_string(), kIndexType));
+	ASSERT_TRUE(index);
+
+	ASSERT_EQ(index->size(), sizeof(kIndexData));
+
+	for (size_t i = 0; i < sizeof(kIndexData); i++)
+		EXPECT_EQ(index->readByte(), kIndexData[i]) << "At index " << i;
+}
+
+GTEST_TEST_F(IndexCache, getIndexWrongType) {
+	ASSERT_FALSE(kTempPath.empty());
+
+	const boost::filesystem::path archive = kTempPath / "getIndexWrongType.erf";
+	writeArchive(archive, 64);
+
+	Aurora::IndexCache cache((kTempPath / "cache").generic_string());
+	writeIndex(cache, archive, kIndexType);
+
+	Common::ScopedPtr<Common::SeekableReadStream> index(cache.getIndex(archive.generic_string(), MKTAG('N', 'O', 'P', 'E')));
+	EXPECT_FALSE(index);
+}
+
+GTEST_TEST_F(IndexCache, getIndexChangedFile) {
+	ASSERT_FALSE(kTempPath.empty());
+
+	const boost::filesystem::path archive = kTempPath / "getIndexChangedFile.erf";
+	writeArchive(archive, 64);
+
+	Aurora::IndexCache cache((kTempPath / "cache").generic_string());
+	writeIndex(cache, archive, kIndexType);
+
+	writeArchive(archive, 65);
+
+	Common::ScopedPtr<Common::SeekableReadStream> index(cache.getIndex(archive.generic_string(), kIndexType));
+	EXPECT_FALSE(index);
+
+	writeIndex(cache, archive, kIndexType);
+
+	index.reset(cache.getIndex(archive.generic_string(), kIndexType));
+	EXPECT_TRUE(index);
+}
+
+GTEST_TEST_F(IndexCache, getIndexOtherFile) {
+	ASSERT_FALSE(kTempPath.empty());
+
+	const boost::filesystem::path archive1 = kTempPath / "getIndexOtherFile1.erf";
+	const boost::filesystem::path archive2 = kTempPath / "getIndexOtherFile2.erf";
+	writeArchive(archive1, 64);
+	writeArchive(archive2, 64);
+
+	Aurora::IndexCache cache((kTempPath / "cache").generic_string());
+	writeIndex(cache, archive1, kIndexType);
+
+	Common::ScopedPtr<Common::SeekableReadStream> index(cache.getIndex(archive2.generic_string(), kIndexType));
+	EXPECT_FALSE(index);
+
+	index.reset(cache.getIndex(archive1.generic_string(), kIndexType));
+	EXPECT_TRUE(index);
+}
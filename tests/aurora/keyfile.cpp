@@ -26,6 +26,8 @@
 
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/scopedptr.h"
 
 #include "src/aurora/keyfile.h"
 
@@ -65,6 +67,47 @@ GTEST_TEST(KEYFile10, getResources) {
 	EXPECT_EQ(res[0].resIndex, 1);
 }
 
+GTEST_TEST(KEYFile10, getBIFResources) {
+	Common::MemoryReadStream stream(kKEY10File);
+	Aurora::KEYFile key(stream);
+
+	const Aurora::KEYFile::ResourceIndexList &res = key.getBIFResources(0);
+	ASSERT_EQ(res.size(), 1);
+
+	EXPECT_EQ(res[0], 0);
+
+	EXPECT_TRUE(key.getBIFResources(1).empty());
+}
+
+GTEST_TEST(KEYFile10, readIndex) {
+	Common::MemoryReadStream stream(kKEY10File);
+	Aurora::KEYFile key(stream);
+
+	Common::MemoryWriteStreamDynamic index(true);
+	key.writeIndex(index);
+
+	Common::MemoryReadStream indexStream(index.getData(), index.size());
+	Common::ScopedPtr<Aurora::KEYFile> indexKey(Aurora::KEYFile::readIndex(indexStream));
+
+	EXPECT_EQ(indexKey->getID(), key.getID());
+	EXPECT_EQ(indexKey->getVersion(), key.getVersion());
+
+	const Aurora::KEYFile::BIFList &bifs = indexKey->getBIFs();
+	ASSERT_EQ(bifs.size(), 1);
+
+	EXPECT_STREQ(bifs[0].c_str(), "data/xoreos.bif");
+
+	const Aurora::KEYFile::ResourceList &res = indexKey->getResources();
+	ASSERT_EQ(res.size(), 1);
+
+	EXPECT_STREQ(res[0].name.c_str(), "ozymandias");
+	EXPECT_EQ(res[0].type, Aurora::kFileTypeTXT);
+	EXPECT_EQ(res[0].bifIndex, 0);
+	EXPECT_EQ(res[0].resIndex, 1);
+
+	EXPECT_EQ(indexKey->getBIFResources(0).size(), 1);
+}
+
 // --- KEY V1.1 ---
 
 static const byte kKEY11File[] = {
@@ -136,6 +136,7 @@ GTEST_TEST(RIMFile, findResourceName) {
 	const Aurora::RIMFile rim(stream);
 
 	EXPECT_EQ(rim.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
+	EXPECT_EQ(rim.findResource("OzYmAnDiAs", Aurora::kFileTypeTXT), 0);
 
 	EXPECT_EQ(rim.findResource("ozymandias", Aurora::kFileTypeBMP), 0xFFFFFFFF);
 	EXPECT_EQ(rim.findResource("nope"      , Aurora::kFileTypeTXT), 0xFFFFFFFF);
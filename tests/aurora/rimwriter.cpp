@@ -22,6 +22,8 @@
  *  Unit tests for our RIM file archive writer class.
  */
 
+#include <memory>
+
 #include "gtest/gtest.h"
 
 #include "src/common/memwritestream.h"
@@ -66,6 +66,11 @@ tests_aurora_test_herffile_SOURCES  = tests/aurora/herffile.cpp
 tests_aurora_test_herffile_LDADD    = $(aurora_LIBS)
 tests_aurora_test_herffile_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                       += tests/aurora/test_indexcache
+tests_aurora_test_indexcache_SOURCES  = tests/aurora/indexcache.cpp
+tests_aurora_test_indexcache_LDADD    = $(aurora_LIBS)
+tests_aurora_test_indexcache_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                   += tests/aurora/test_ndsrom
 tests_aurora_test_ndsrom_SOURCES  = tests/aurora/ndsrom.cpp
 tests_aurora_test_ndsrom_LDADD    = $(aurora_LIBS)
@@ -155,3 +160,37 @@ check_PROGRAMS                      += tests/aurora/test_rimwriter
 tests_aurora_test_rimwriter_SOURCES  = tests/aurora/rimwriter.cpp
 tests_aurora_test_rimwriter_LDADD    = $(aurora_LIBS)
 tests_aurora_test_rimwriter_CXXFLAGS = $(test_CXXFLAGS)
+
+# Benchmark of the GFF3 writer. As a unit test, it only runs each stage once
+check_PROGRAMS                       += tests/aurora/benchmark_gff3
+tests_aurora_benchmark_gff3_SOURCES   = tests/aurora/benchmark_gff3.cpp
+tests_aurora_benchmark_gff3_LDADD     = \
+    $(benchmark_LIBS) \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_aurora_benchmark_gff3_CXXFLAGS  = $(AM_CXXFLAGS)
+
+check_PROGRAMS                       += tests/aurora/benchmark_archive
+tests_aurora_benchmark_archive_SOURCES = tests/aurora/benchmark_archive.cpp
+tests_aurora_benchmark_archive_LDADD   = \
+    $(benchmark_LIBS) \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_aurora_benchmark_archive_CXXFLAGS = $(AM_CXXFLAGS)
+
+check_PROGRAMS                       += tests/aurora/benchmark_bzf
+tests_aurora_benchmark_bzf_SOURCES    = tests/aurora/benchmark_bzf.cpp
+tests_aurora_benchmark_bzf_LDADD      = \
+    $(benchmark_LIBS) \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_aurora_benchmark_bzf_CXXFLAGS   = $(AM_CXXFLAGS)
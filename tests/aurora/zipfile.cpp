@@ -128,6 +128,7 @@ GTEST_TEST(ZIPFile, findResourceName) {
 	const Aurora::ZIPFile zip(stream);
 
 	EXPECT_EQ(zip.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
+	EXPECT_EQ(zip.findResource("OzYmAnDiAs", Aurora::kFileTypeTXT), 0);
 
 	EXPECT_EQ(zip.findResource("ozymandias", Aurora::kFileTypeBMP), 0xFFFFFFFF);
 	EXPECT_EQ(zip.findResource("nope"      , Aurora::kFileTypeTXT), 0xFFFFFFFF);
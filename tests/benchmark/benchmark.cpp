@@ -0,0 +1,137 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Shared scaffolding of our benchmark programs.
+ */
+
+#include <cstdio>
+
+#include <chrono>
+
+#include "src/common/error.h"
+#include "src/common/writestream.h"
+#include "src/common/strutil.h"
+#include "src/common/writefile.h"
+#include "src/common/stdoutstream.h"
+
+#include "tests/benchmark/benchmark.h"
+
+namespace Benchmark {
+
+typedef std::chrono::steady_clock Clock;
+
+/** A WriteStream writing into stderr. */
+class StdErrStream : public Common::WriteStream {
+public:
+	size_t write(const void *dataPtr, size_t dataSize) {
+		return std::fwrite(dataPtr, 1, dataSize, stderr);
+	}
+
+	void flush() {
+		if (std::fflush(stderr) != 0)
+			throw Common::Exception(Common::kWriteError);
+	}
+};
+
+Options::Options() : iterations(1) {
+}
+
+void parseCommandLine(int argc, char **argv, Options &options,
+                      bool acceptCounts, bool acceptFiles, const char *countName) {
+
+	for (int i = 1; i < argc; i++) {
+		const Common::UString arg = argv[i];
+
+		if        ((arg == "-i") && ((i + 1) < argc)) {
+			uint32 iterations = 0;
+			Common::parseString(argv[++i], iterations);
+			if (iterations == 0)
+				throw Common::Exception("Invalid number of iterations");
+
+			options.iterations = iterations;
+
+		} else if (acceptCounts && (arg == "-n") && ((i + 1) < argc)) {
+			uint32 count = 0;
+			Common::parseString(argv[++i], count);
+			if (count == 0)
+				throw Common::Exception("Invalid %s", countName);
+
+			options.counts.push_back(count);
+
+		} else if ((arg == "-o") && ((i + 1) < argc)) {
+			options.outFile = argv[++i];
+
+		} else if (acceptFiles && !arg.beginsWith("-")) {
+			options.files.push_back(arg);
+
+		} else
+			throw Common::Exception("Usage: %s [-i <iterations>]%s [-o <results.csv>]%s", argv[0],
+			                        acceptCounts ? Common::UString::format(" [-n <%s>]", countName).c_str() : "",
+			                        acceptFiles ? " [<file> [...]]" : "");
+	}
+}
+
+double measure(size_t iterations, const std::function<void ()> &func) {
+	const Clock::time_point start = Clock::now();
+
+	for (size_t i = 0; i < iterations; i++)
+		func();
+
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double getMBPerSecond(size_t bytes, size_t iterations, double seconds) {
+	if (seconds <= 0.0)
+		return 0.0;
+
+	return ((bytes * (double) iterations) / (1024.0 * 1024.0)) / seconds;
+}
+
+
+Results::Results(const Common::UString &outFile, const char *columns, bool stdErr) {
+	if (outFile.empty() && stdErr)
+		_out.reset(new StdErrStream);
+	else if (outFile.empty())
+		_out.reset(new Common::StdOutStream);
+	else
+		_out.reset(new Common::WriteFile(outFile));
+
+	_out->writeString(Common::UString::format("%s,iterations,bytes,seconds,mb_per_s\n", columns));
+}
+
+Results::~Results() {
+	try {
+		flush();
+	} catch (...) {
+	}
+}
+
+void Results::write(const Common::UString &columns, size_t iterations, size_t bytes, double seconds) {
+	_out->writeString(Common::UString::format("%s,%u,%u,%.9f,%.3f\n", columns.c_str(),
+	                  (uint)iterations, (uint)bytes, seconds / iterations,
+	                  getMBPerSecond(bytes, iterations, seconds)));
+}
+
+void Results::flush() {
+	_out->flush();
+}
+
+} // End of namespace Benchmark
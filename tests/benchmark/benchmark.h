@@ -0,0 +1,113 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Shared scaffolding of our benchmark programs.
+ *
+ *  All benchmarks understand the same basic command line:
+ *
+ *  [-i <iterations>] [-n <count> [...]] [-o <results.csv>] [<file> [...]]
+ *
+ *  and write their results as CSV, one line per measurement, ending in
+ *  the columns "iterations,bytes,seconds,mb_per_s".
+ */
+
+#ifndef TESTS_BENCHMARK_BENCHMARK_H
+#define TESTS_BENCHMARK_BENCHMARK_H
+
+#include <vector>
+#include <functional>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+	class WriteStream;
+}
+
+namespace Benchmark {
+
+/** The command line options of a benchmark. */
+struct Options {
+	/** Number of times to run each measurement (-i). */
+	size_t iterations;
+
+	/** Sizes to benchmark (-n), like a number of fields or resources. */
+	std::vector<size_t> counts;
+
+	/** File to write the results to (-o). If empty, write them to stdout. */
+	Common::UString outFile;
+
+	/** Input files, like fixtures to measure in addition to synthetic data. */
+	std::vector<Common::UString> files;
+
+	Options();
+};
+
+/** Parse the command line of a benchmark.
+ *
+ *  @param argc, argv The command line.
+ *  @param options Receives the parsed options.
+ *  @param acceptCounts Does this benchmark take the -n option?
+ *  @param acceptFiles Does this benchmark take input files?
+ *  @param countName What -n counts, for the usage message.
+ */
+void parseCommandLine(int argc, char **argv, Options &options,
+                      bool acceptCounts, bool acceptFiles, const char *countName = "count");
+
+/** Run this function a number of times, and return the number of seconds that took. */
+double measure(size_t iterations, const std::function<void ()> &func);
+
+/** Return the throughput of processing these many bytes a number of times, in MB/s. */
+double getMBPerSecond(size_t bytes, size_t iterations, double seconds);
+
+/** CSV writer for the results of a benchmark. */
+class Results : boost::noncopyable {
+public:
+	/** Open the results file and write the CSV header.
+	 *
+	 *  @param outFile The file to write to. If empty, write to stdout.
+	 *  @param columns The benchmark-specific leading columns, like "image,stage".
+	 *  @param stdErr Write to stderr instead of stdout, for benchmarking code that prints to stdout.
+	 */
+	Results(const Common::UString &outFile, const char *columns, bool stdErr = false);
+	~Results();
+
+	/** Write a result line.
+	 *
+	 *  @param columns Values of the benchmark-specific columns, comma-separated.
+	 *  @param iterations How many times the measured function ran.
+	 *  @param bytes How many bytes the measured function processed per run.
+	 *  @param seconds How many seconds all the runs took together.
+	 */
+	void write(const Common::UString &columns, size_t iterations, size_t bytes, double seconds);
+
+	void flush();
+
+private:
+	Common::ScopedPtr<Common::WriteStream> _out;
+};
+
+} // End of namespace Benchmark
+
+#endif // TESTS_BENCHMARK_BENCHMARK_H
@@ -0,0 +1,125 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our base64 encoder and decoder.
+ */
+
+#include <list>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/base64.h"
+#include "src/common/encoding.h"
+#include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/error.h"
+
+static const char *kDataDecoded[] = {
+	"", "f", "fo", "foo", "foob", "fooba", "foobar"
+};
+
+static const char *kDataEncoded[] = {
+	"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"
+};
+
+GTEST_TEST(Base64, encode) {
+	for (size_t i = 0; i < ARRAYSIZE(kDataDecoded); i++) {
+		Common::MemoryReadStream stream(kDataDecoded[i]);
+
+		Common::UString base64;
+		Common::encodeBase64(stream, base64);
+
+		EXPECT_STREQ(base64.c_str(), kDataEncoded[i]) << "At index " << i;
+	}
+}
+
+GTEST_TEST(Base64, encodeAppend) {
+	Common::MemoryReadStream stream("foobar");
+
+	Common::UString base64("Data: ");
+	Common::encodeBase64(stream, base64);
+
+	EXPECT_STREQ(base64.c_str(), "Data: Zm9vYmFy");
+}
+
+GTEST_TEST(Base64, encodeList) {
+	Common::MemoryReadStream stream("foobar");
+
+	std::list<Common::UString> base64;
+	Common::encodeBase64(stream, base64, 3);
+
+	ASSERT_EQ(base64.size(), 3);
+
+	std::list<Common::UString>::const_iterator line = base64.begin();
+	EXPECT_STREQ((line++)->c_str(), "Zm9");
+	EXPECT_STREQ((line++)->c_str(), "vYm");
+	EXPECT_STREQ((line++)->c_str(), "Fy");
+}
+
+GTEST_TEST(Base64, encodeListEmpty) {
+	Common::MemoryReadStream stream("");
+
+	std::list<Common::UString> base64;
+	Common::encodeBase64(stream, base64, 64);
+
+	EXPECT_TRUE(base64.empty());
+}
+
+GTEST_TEST(Base64, encodeListInvalidLength) {
+	Common::MemoryReadStream stream("foobar");
+
+	std::list<Common::UString> base64;
+	EXPECT_THROW(Common::encodeBase64(stream, base64, 0), Common::Exception);
+}
+
+GTEST_TEST(Base64, decode) {
+	for (size_t i = 0; i < ARRAYSIZE(kDataEncoded); i++) {
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::decodeBase64(kDataEncoded[i]));
+
+		const Common::UString decoded = Common::readString(*stream, Common::kEncodingASCII);
+
+		EXPECT_STREQ(decoded.c_str(), kDataDecoded[i]) << "At index " << i;
+	}
+}
+
+GTEST_TEST(Base64, roundTripLarge) {
+	// Several encoding blocks, and an incomplete last 3-byte group
+	static const size_t kSize = 10000;
+
+	Common::ScopedArray<byte> data(new byte[kSize]);
+	for (size_t i = 0; i < kSize; i++)
+		data[i] = (byte) ((i * 7) ^ (i >> 8));
+
+	Common::MemoryReadStream stream(data.get(), kSize);
+
+	std::list<Common::UString> base64;
+	Common::encodeBase64(stream, base64, 64);
+
+	ASSERT_EQ(base64.size(), ((kSize + 2) / 3 * 4 + 63) / 64);
+
+	Common::ScopedPtr<Common::SeekableReadStream> decoded(Common::decodeBase64(base64));
+	ASSERT_EQ(decoded->size(), kSize);
+
+	for (size_t i = 0; i < kSize; i++)
+		EXPECT_EQ(decoded->readByte(), data[i]) << "At index " << i;
+}
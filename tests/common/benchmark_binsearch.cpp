@@ -0,0 +1,186 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of the lookup in a Common::EytzingerIndex against binarySearch().
+ *
+ *  We create sorted tables of random 32-bit hashes with a given number of
+ *  entries, like the table of known Sonic file names, and measure the time
+ *  spent building the EytzingerIndex over it, and looking up random keys
+ *  that are in the table and random keys that aren't, once with
+ *  binarySearch() and once with the EytzingerIndex.
+ *  The results are written as CSV, one line per table size, search and
+ *  stage; the bytes column holds the number of lookups.
+ *
+ *  Usage: benchmark_binsearch [-i <iterations>] [-n <entries>] [-o <results.csv>]
+ *
+ *  The option -n can be given multiple times, to benchmark several sizes,
+ *  like -n 100 -n 10000 -n 1000000.
+ *
+ *  Run without arguments, like as part of the unit tests, every stage only
+ *  runs once, on tables with 10^3 and 10^4 entries, to make sure the
+ *  benchmark itself still works.
+ */
+
+#include <cstdlib>
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/binsearch.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** The number of keys looked up per stage. */
+static const size_t kLookupCount = 262144;
+
+typedef Common::BinSearchValue<uint32, uint32> TableEntry;
+
+/** Sink for the values found, so that the lookups aren't optimized away. */
+static volatile uint32 gSink = 0;
+
+static uint32 getRandom() {
+	return ((uint32) std::rand() << 16) ^ (uint32) std::rand();
+}
+
+/** Create a sorted table of this many unique random keys. */
+static void createTable(std::vector<TableEntry> &table, std::set<uint32> &keys, size_t entryCount) {
+	keys.clear();
+	while (keys.size() < entryCount)
+		keys.insert(getRandom());
+
+	table.clear();
+	table.reserve(entryCount);
+
+	for (std::set<uint32>::const_iterator k = keys.begin(); k != keys.end(); ++k) {
+		const TableEntry entry = { *k, (uint32) table.size() };
+
+		table.push_back(entry);
+	}
+}
+
+/** Pick random keys that are in the table, or random keys that aren't. */
+static void createLookups(std::vector<uint32> &lookups, const std::vector<TableEntry> &table,
+                          const std::set<uint32> &keys, bool hits) {
+
+	lookups.resize(kLookupCount);
+
+	for (size_t i = 0; i < lookups.size(); i++) {
+		if (hits) {
+			lookups[i] = table[getRandom() % table.size()].key;
+			continue;
+		}
+
+		do {
+			lookups[i] = getRandom();
+		} while (keys.find(lookups[i]) != keys.end());
+	}
+}
+
+template<typename Search>
+static void benchmarkLookups(Benchmark::Results &results, const std::vector<uint32> &lookups,
+                             size_t entryCount, const char *search, const char *stage,
+                             bool hits, size_t iterations, Search find) {
+
+	const double seconds = Benchmark::measure(iterations, [&]() {
+		uint32 found = 0;
+
+		for (size_t i = 0; i < lookups.size(); i++) {
+			const TableEntry *entry = find(lookups[i]);
+
+			if (!entry != !hits)
+				throw Common::Exception("%s search for %u gave the wrong result", search, (uint)lookups[i]);
+
+			if (entry)
+				found += entry->value;
+		}
+
+		gSink = found;
+	});
+
+	results.write(Common::UString::format("%u,%s,%s", (uint)entryCount, search, stage),
+	              iterations, lookups.size(), seconds);
+}
+
+static void benchmark(Benchmark::Results &results, size_t entryCount, size_t iterations) {
+	std::vector<TableEntry> table;
+	std::set<uint32> keys;
+
+	createTable(table, keys, entryCount);
+
+	const double seconds = Benchmark::measure(iterations, [&]() {
+		Common::EytzingerIndex<uint32, uint32> index(&table[0], table.size());
+	});
+
+	results.write(Common::UString::format("%u,eytzinger,build", (uint)entryCount),
+	              iterations, table.size(), seconds);
+
+	const Common::EytzingerIndex<uint32, uint32> index(&table[0], table.size());
+
+	std::vector<uint32> lookups;
+	for (int hits = 1; hits >= 0; hits--) {
+		createLookups(lookups, table, keys, hits);
+
+		const char *stage = hits ? "hit" : "miss";
+
+		benchmarkLookups(results, lookups, entryCount, "binary", stage, hits, iterations, [&](uint32 key) {
+			return Common::binarySearch(&table[0], table.size(), key);
+		});
+
+		benchmarkLookups(results, lookups, entryCount, "eytzinger", stage, hits, iterations, [&](uint32 key) {
+			return index.find(key);
+		});
+	}
+}
+
+int main(int argc, char **argv) {
+	try {
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, false, "entries");
+
+		if (options.counts.empty()) {
+			options.counts.push_back(1000);
+			options.counts.push_back(10000);
+		}
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n)
+			if (*n == 0)
+				throw Common::Exception("Tables need at least one entry");
+
+		Benchmark::Results results(options.outFile, "entries,search,stage");
+
+		std::srand(0);
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n)
+			benchmark(results, *n, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	return 0;
+}
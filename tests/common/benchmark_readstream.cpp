@@ -0,0 +1,283 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of BufferedReadStream against a raw ReadFile.
+ *
+ *  We write a file of random data with a given size into a temporary
+ *  directory, and measure the time spent reading all of it as single bytes,
+ *  as 16-bit and 32-bit values and as 64 byte blocks, and reading 32-bit
+ *  values at random positions, each once straight out of a ReadFile and once
+ *  through a BufferedReadStream, and then again through a sequential and a
+ *  positional substream over each of them, like the ones many formats parse
+ *  their data through. We
+ *  also write a synthetic GFF3 and measure loading it through all kinds of
+ *  streams. GFF, 2DA and KEY files given on
+ *  the command line are loaded as well.
+ *  The results are written as CSV, one line per file, stage and stream.
+ *
+ *  Usage: benchmark_readstream [-i <iterations>] [-n <kilobytes>] [-o <results.csv>] [<file> [...]]
+ *
+ *  Run without arguments, like as part of the unit tests, every stage only
+ *  runs once, on a file of 1MB, to make sure the benchmark itself still works.
+ */
+
+#include <cstdlib>
+
+#include <vector>
+#include <functional>
+
+#include <boost/filesystem.hpp>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/platform.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/filepath.h"
+#include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/bufferedreadstream.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/util.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
+#include "src/aurora/2dafile.h"
+#include "src/aurora/keyfile.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** The number of random positions to read from. */
+static const size_t kSeekCount = 65536;
+
+/** The number of structs in the synthetic GFF3. */
+static const size_t kGFF3StructCount = 10000;
+
+/** Sink for the values read, so that the reads aren't optimized away. */
+static volatile uint32 gSink = 0;
+
+/** Open a file, either as a raw ReadFile or through a BufferedReadStream, optionally within a substream. */
+typedef std::function<Common::SeekableReadStream *(const Common::UString &fileName)> StreamOpener;
+
+struct StreamKind {
+	const char *name;
+	StreamOpener open;
+};
+
+static const StreamKind kStreamKinds[] = {
+	{ "file"    , [](const Common::UString &fileName) -> Common::SeekableReadStream * {
+		return new Common::ReadFile(fileName);
+	} },
+	{ "buffered", [](const Common::UString &fileName) -> Common::SeekableReadStream * {
+		return new Common::BufferedReadStream(new Common::ReadFile(fileName), true);
+	} },
+	{ "file_sub", [](const Common::UString &fileName) -> Common::SeekableReadStream * {
+		Common::SeekableReadStream *file = new Common::ReadFile(fileName);
+		return new Common::SeekableSubReadStream(file, 0, file->size(), true);
+	} },
+	{ "buffered_sub", [](const Common::UString &fileName) -> Common::SeekableReadStream * {
+		Common::SeekableReadStream *file = new Common::BufferedReadStream(new Common::ReadFile(fileName), true);
+		return new Common::SeekableSubReadStream(file, 0, file->size(), true);
+	} },
+	{ "file_positional", [](const Common::UString &fileName) -> Common::SeekableReadStream * {
+		Common::SeekableReadStream *file = new Common::ReadFile(fileName);
+		return new Common::PositionalSubReadStream(file, 0, file->size(), true);
+	} },
+	{ "buffered_positional", [](const Common::UString &fileName) -> Common::SeekableReadStream * {
+		Common::SeekableReadStream *file = new Common::BufferedReadStream(new Common::ReadFile(fileName), true);
+		return new Common::PositionalSubReadStream(file, 0, file->size(), true);
+	} }
+};
+
+
+static void writeData(const Common::UString &fileName, size_t size) {
+	std::vector<byte> data(size);
+	for (size_t i = 0; i < size; i++)
+		data[i] = std::rand() & 0xFF;
+
+	Common::WriteFile file(fileName);
+	file.write(&data[0], data.size());
+	file.flush();
+}
+
+static void writeGFF3(const Common::UString &fileName) {
+	Aurora::GFF3Writer writer(MKTAG('U', 'T', 'C', ' '), MKTAG('V', '3', '.', '2'));
+
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("List");
+	for (size_t i = 0; i < kGFF3StructCount; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", i % 8);
+
+		strct->addUint32("ID", i);
+		strct->addSint16("Value", i % 1000);
+		strct->addFloat("Position", i * 0.5f);
+		strct->addExoString("Tag", Common::UString::format("tag_%u", (uint)i));
+		strct->addResRef("ResRef", Common::UString::format("res_%u", (uint)(i % 64)));
+	}
+
+	Common::WriteFile file(fileName);
+	writer.write(file);
+	file.flush();
+}
+
+/** Load a GFF, 2DA or KEY file out of the stream. */
+static void loadFile(Common::SeekableReadStream *stream, Aurora::FileType type) {
+	Common::ScopedPtr<Common::SeekableReadStream> file(stream);
+
+	if (type == Aurora::kFileType2DA) {
+		Aurora::TwoDAFile twoDA(*file);
+	} else if (type == Aurora::kFileTypeKEY) {
+		Aurora::KEYFile key(*file);
+	} else {
+		Aurora::GFF3File gff3(file.release());
+	}
+}
+
+static void writeResult(Benchmark::Results &results, const Common::UString &file, const char *stage,
+                        const StreamKind &kind, size_t iterations, size_t bytes, double seconds) {
+
+	results.write(Common::UString::format("%s,%s,%s", file.c_str(), stage, kind.name), iterations, bytes, seconds);
+}
+
+static void benchmarkReads(Benchmark::Results &results, const Common::UString &fileName, size_t iterations) {
+	const size_t size = Common::FilePath::getFileSize(fileName);
+
+	std::vector<size_t> positions(kSeekCount);
+	for (size_t i = 0; i < positions.size(); i++)
+		positions[i] = (((size_t) std::rand() << 16) ^ std::rand()) % (size - 3);
+
+	for (size_t k = 0; k < ARRAYSIZE(kStreamKinds); k++) {
+		const StreamKind &kind = kStreamKinds[k];
+
+		uint32 sum = 0;
+
+		double seconds = Benchmark::measure(iterations, [&]() {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(kind.open(fileName));
+			for (size_t i = 0; i < size; i++)
+				sum += stream->readByte();
+		});
+
+		writeResult(results, "data", "uint8", kind, iterations, size, seconds);
+
+		seconds = Benchmark::measure(iterations, [&]() {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(kind.open(fileName));
+			for (size_t i = 0; i < (size / 2); i++)
+				sum += stream->readUint16LE();
+		});
+
+		writeResult(results, "data", "uint16le", kind, iterations, size & ~1, seconds);
+
+		seconds = Benchmark::measure(iterations, [&]() {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(kind.open(fileName));
+			for (size_t i = 0; i < (size / 4); i++)
+				sum += stream->readUint32LE();
+		});
+
+		writeResult(results, "data", "uint32le", kind, iterations, size & ~3, seconds);
+
+		seconds = Benchmark::measure(iterations, [&]() {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(kind.open(fileName));
+
+			byte block[64];
+			for (size_t i = 0; i < (size / sizeof(block)); i++) {
+				stream->read(block, sizeof(block));
+				sum += block[0];
+			}
+		});
+
+		writeResult(results, "data", "block64", kind, iterations, size & ~63, seconds);
+
+		seconds = Benchmark::measure(iterations, [&]() {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(kind.open(fileName));
+			for (size_t i = 0; i < positions.size(); i++) {
+				stream->seek(positions[i]);
+				sum += stream->readUint32LE();
+			}
+		});
+
+		writeResult(results, "data", "seek_uint32le", kind, iterations, positions.size() * 4, seconds);
+
+		// Make sure the reads aren't optimized away
+		gSink = sum;
+	}
+}
+
+static void benchmarkLoad(Benchmark::Results &results, const Common::UString &fileName, size_t iterations) {
+	const Aurora::FileType type = TypeMan.getFileType(fileName);
+	const size_t size = Common::FilePath::getFileSize(fileName);
+
+	for (size_t k = 0; k < ARRAYSIZE(kStreamKinds); k++) {
+		const StreamKind &kind = kStreamKinds[k];
+
+		const double seconds = Benchmark::measure(iterations, [&]() {
+			loadFile(kind.open(fileName), type);
+		});
+
+		writeResult(results, Common::FilePath::getFile(fileName), "load", kind, iterations, size, seconds);
+	}
+}
+
+int main(int argc, char **argv) {
+	boost::filesystem::path tempPath;
+
+	try {
+		Common::Platform::init();
+
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, true, "kilobytes");
+
+		if (options.counts.empty())
+			options.counts.push_back(1024);
+
+		tempPath = boost::filesystem::temp_directory_path() /
+		           boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		boost::filesystem::create_directories(tempPath);
+
+		const Common::UString dataFile = (tempPath / "benchmark.dat").generic_string();
+		const Common::UString gff3File = (tempPath / "benchmark.utc").generic_string();
+
+		std::srand(0);
+
+		Benchmark::Results results(options.outFile, "file,stage,stream");
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n) {
+			writeData(dataFile, *n * 1024);
+			benchmarkReads(results, dataFile, options.iterations);
+		}
+
+		writeGFF3(gff3File);
+		benchmarkLoad(results, gff3File, options.iterations);
+
+		for (std::vector<Common::UString>::const_iterator f = options.files.begin(); f != options.files.end(); ++f)
+			benchmarkLoad(results, *f, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	if (!tempPath.empty())
+		boost::filesystem::remove_all(tempPath);
+
+	return 0;
+}
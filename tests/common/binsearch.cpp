@@ -22,6 +22,8 @@
  *  Unit tests for our generic binary search.
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
@@ -47,3 +49,50 @@ GTEST_TEST(BinSearch, negative) {
 
 	ASSERT_EQ(entry, static_cast<const TestBinSearch *>(0));
 }
+
+GTEST_TEST(EytzingerIndex, positive) {
+	const Common::EytzingerIndex<uint8, uint8> index(kTestBinSearch, ARRAYSIZE(kTestBinSearch));
+
+	for (size_t i = 0; i < ARRAYSIZE(kTestBinSearch); i++) {
+		const TestBinSearch *entry = index.find(kTestBinSearch[i].key);
+
+		ASSERT_EQ(entry, &kTestBinSearch[i]) << "At index " << i;
+	}
+}
+
+GTEST_TEST(EytzingerIndex, negative) {
+	const Common::EytzingerIndex<uint8, uint8> index(kTestBinSearch, ARRAYSIZE(kTestBinSearch));
+
+	EXPECT_EQ(index.find(0), static_cast<const TestBinSearch *>(0));
+	EXPECT_EQ(index.find(4), static_cast<const TestBinSearch *>(0));
+	EXPECT_EQ(index.find(8), static_cast<const TestBinSearch *>(0));
+	EXPECT_EQ(index.find(42), static_cast<const TestBinSearch *>(0));
+}
+
+GTEST_TEST(EytzingerIndex, empty) {
+	const Common::EytzingerIndex<uint8, uint8> index(kTestBinSearch, 0);
+
+	EXPECT_EQ(index.find(5), static_cast<const TestBinSearch *>(0));
+}
+
+GTEST_TEST(EytzingerIndex, sizes) {
+	typedef Common::BinSearchValue<uint32, uint32> TestSearch;
+
+	// Keys are the odd numbers, so that there's a missing key around every present one
+	std::vector<TestSearch> map;
+	for (uint32 i = 0; i < 300; i++) {
+		const TestSearch value = { 2 * i + 1, i };
+		map.push_back(value);
+	}
+
+	for (size_t size = 1; size <= map.size(); size++) {
+		const Common::EytzingerIndex<uint32, uint32> index(&map[0], size);
+
+		for (size_t i = 0; i < size; i++) {
+			ASSERT_EQ(index.find(map[i].key), &map[i]) << "At index " << i << ", size " << size;
+			ASSERT_EQ(index.find(map[i].key - 1), static_cast<const TestSearch *>(0)) << "At index " << i << ", size " << size;
+		}
+
+		ASSERT_EQ(index.find(2 * size + 1), static_cast<const TestSearch *>(0)) << "Size " << size;
+	}
+}
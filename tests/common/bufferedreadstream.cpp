@@ -0,0 +1,216 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our buffering read stream wrapper.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/bufferedreadstream.h"
+
+static const byte kData[11] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B
+};
+
+/** A MemoryReadStream that counts how often it's read from. */
+class CountingReadStream : public Common::MemoryReadStream {
+public:
+	size_t readAtCount;
+
+	template<size_t N>
+	CountingReadStream(const byte (&array)[N]) : Common::MemoryReadStream(array), readAtCount(0) {
+	}
+
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize) {
+		readAtCount++;
+
+		return Common::MemoryReadStream::readAt(offset, dataPtr, dataSize);
+	}
+};
+
+GTEST_TEST(BufferedReadStream, size) {
+	Common::MemoryReadStream stream(kData);
+	Common::BufferedReadStream buffered(&stream, false, 4);
+
+	EXPECT_EQ(buffered.size(), ARRAYSIZE(kData));
+	EXPECT_EQ(buffered.pos(), 0);
+}
+
+GTEST_TEST(BufferedReadStream, readFixed) {
+	Common::MemoryReadStream stream(kData);
+
+	// With a buffer of 3 bytes, the values straddle the buffer boundaries
+	Common::BufferedReadStream buffered(&stream, false, 3);
+
+	EXPECT_EQ(buffered.readByte(), 0x01);
+	EXPECT_EQ(buffered.readUint16LE(), 0x0302);
+	EXPECT_EQ(buffered.readUint32BE(), 0x04050607);
+	EXPECT_EQ(buffered.pos(), 7);
+	EXPECT_EQ(buffered.readUint32LE(), 0x0B0A0908);
+	EXPECT_EQ(buffered.pos(), 11);
+
+	EXPECT_FALSE(buffered.eos());
+	EXPECT_THROW(buffered.readByte(), Common::Exception);
+	EXPECT_TRUE(buffered.eos());
+
+	// The parent stream's position is never touched
+	EXPECT_EQ(stream.pos(), 0);
+}
+
+GTEST_TEST(BufferedReadStream, read) {
+	Common::MemoryReadStream stream(kData);
+	Common::BufferedReadStream buffered(&stream, false, 4);
+
+	byte readData[ARRAYSIZE(kData) + 1] = { 0 };
+
+	// Partially buffered, then a read that's bigger than the buffer
+	EXPECT_EQ(buffered.read(readData, 1), 1);
+	EXPECT_EQ(buffered.read(readData + 1, 9), 9);
+	EXPECT_EQ(buffered.pos(), 10);
+
+	// Reading past the end
+	EXPECT_EQ(buffered.read(readData + 10, 2), 1);
+	EXPECT_TRUE(buffered.eos());
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(readData[i], kData[i]) << "At index " << i;
+}
+
+GTEST_TEST(BufferedReadStream, seek) {
+	Common::MemoryReadStream stream(kData);
+	Common::BufferedReadStream buffered(&stream, false, 4);
+
+	EXPECT_EQ(buffered.readByte(), 0x01);
+
+	// Within the buffer
+	EXPECT_EQ(buffered.seek(3), 1);
+	EXPECT_EQ(buffered.readByte(), 0x04);
+
+	// Backwards, out of the buffer
+	EXPECT_EQ(buffered.seek(-2, Common::SeekableReadStream::kOriginCurrent), 4);
+	EXPECT_EQ(buffered.readByte(), 0x03);
+
+	// Relative to the end, out of the buffer
+	EXPECT_EQ(buffered.seek(-1, Common::SeekableReadStream::kOriginEnd), 3);
+	EXPECT_EQ(buffered.readByte(), 0x0B);
+
+	EXPECT_THROW(buffered.readByte(), Common::Exception);
+	EXPECT_TRUE(buffered.eos());
+
+	buffered.seek(0);
+	EXPECT_FALSE(buffered.eos());
+	EXPECT_EQ(buffered.readByte(), 0x01);
+
+	EXPECT_THROW(buffered.seek(ARRAYSIZE(kData) + 1), Common::Exception);
+}
+
+GTEST_TEST(BufferedReadStream, parentPosition) {
+	Common::MemoryReadStream stream(kData);
+	stream.seek(5);
+
+	// The buffered stream starts at the parent's current position
+	Common::BufferedReadStream buffered(&stream, false, 4);
+
+	EXPECT_EQ(buffered.pos(), 5);
+	EXPECT_EQ(buffered.readByte(), 0x06);
+}
+
+GTEST_TEST(BufferedReadStream, readAt) {
+	Common::MemoryReadStream stream(kData);
+	Common::BufferedReadStream buffered(&stream, false, 4);
+
+	EXPECT_EQ(buffered.readByte(), 0x01);
+
+	byte readData[2];
+	EXPECT_EQ(buffered.readAt(8, readData, 2), 2);
+	EXPECT_EQ(readData[0], 0x09);
+	EXPECT_EQ(readData[1], 0x0A);
+
+	EXPECT_EQ(buffered.pos(), 1);
+	EXPECT_EQ(buffered.readByte(), 0x02);
+}
+
+GTEST_TEST(BufferedReadStream, readAtBuffered) {
+	CountingReadStream stream(kData);
+	Common::BufferedReadStream buffered(&stream, false, 4);
+
+	EXPECT_EQ(buffered.readByte(), 0x01);
+	EXPECT_EQ(stream.readAtCount, 1);
+
+	byte readData[4];
+
+	// Within the buffer
+	EXPECT_EQ(buffered.readAt(2, readData, 2), 2);
+	EXPECT_EQ(readData[0], 0x03);
+	EXPECT_EQ(readData[1], 0x04);
+	EXPECT_EQ(stream.readAtCount, 1);
+
+	// Outside of the buffer, refilling it
+	EXPECT_EQ(buffered.readAt(6, readData, 2), 2);
+	EXPECT_EQ(readData[0], 0x07);
+	EXPECT_EQ(readData[1], 0x08);
+	EXPECT_EQ(stream.readAtCount, 2);
+
+	EXPECT_EQ(buffered.readAt(8, readData, 1), 1);
+	EXPECT_EQ(readData[0], 0x09);
+	EXPECT_EQ(stream.readAtCount, 2);
+
+	// Past the end
+	EXPECT_EQ(buffered.readAt(9, readData, 3), 2);
+	EXPECT_EQ(readData[0], 0x0A);
+	EXPECT_EQ(readData[1], 0x0B);
+	EXPECT_EQ(buffered.readAt(ARRAYSIZE(kData), readData, 1), 0);
+	EXPECT_THROW(buffered.readAt(ARRAYSIZE(kData) + 1, readData, 1), Common::Exception);
+
+	// Big reads bypass the buffer
+	const size_t count = stream.readAtCount;
+	EXPECT_EQ(buffered.readAt(3, readData, 4), 4);
+	EXPECT_EQ(readData[0], 0x04);
+	EXPECT_EQ(readData[3], 0x07);
+	EXPECT_EQ(stream.readAtCount, count + 1);
+
+	// The position stayed the same all along
+	EXPECT_EQ(buffered.pos(), 1);
+	EXPECT_EQ(buffered.readByte(), 0x02);
+	EXPECT_EQ(buffered.readUint16BE(), 0x0304);
+	EXPECT_EQ(buffered.pos(), 4);
+}
+
+GTEST_TEST(BufferedReadStream, positionalSubStream) {
+	CountingReadStream stream(kData);
+	Common::BufferedReadStream buffered(&stream, false, 8);
+
+	Common::PositionalSubReadStream subStream(&buffered, 1, 9);
+
+	EXPECT_EQ(subStream.readUint32BE(), 0x02030405);
+	EXPECT_EQ(subStream.readUint16BE(), 0x0607);
+	EXPECT_EQ(subStream.readByte(), 0x08);
+	EXPECT_EQ(subStream.readByte(), 0x09);
+
+	// All of the substream fit into the buffer
+	EXPECT_EQ(stream.readAtCount, 1);
+
+	EXPECT_EQ(buffered.pos(), 0);
+	EXPECT_EQ(buffered.readByte(), 0x01);
+}
@@ -22,8 +22,11 @@
  *  Unit tests for our DEFLATE decompressor (which uses zlib).
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "src/common/scopedptr.h"
 #include "src/common/deflate.h"
 #include "src/common/memreadstream.h"
 #include "src/common/error.h"
@@ -166,6 +169,69 @@ GTEST_TEST(DEFLATE, decompressFailInputCut) {
 	             Common::Exception);
 }
 
+GTEST_TEST(DEFLATE, decompressOnDemand) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed);
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::DeflateReadStream stream(new Common::MemoryReadStream(kDataCompressed, kSizeCompressed), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMaxRaw, 16);
+
+	EXPECT_EQ(stream.size(), kSizeDecompressed);
+
+	// Nothing is decompressed into memory as a whole for sequential reads
+	for (size_t i = 0; i < kSizeDecompressed; i++)
+		EXPECT_EQ(stream.readByte(), kDataUncompressed[i]) << "At index " << i;
+
+	EXPECT_EQ(stream.getData(), static_cast<const byte *>(0));
+
+	EXPECT_FALSE(stream.eos());
+	EXPECT_THROW(stream.readByte(), Common::Exception);
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(DEFLATE, decompressOnDemandSeek) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed);
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::DeflateReadStream stream(new Common::MemoryReadStream(kDataCompressed, kSizeCompressed), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMaxRaw, 16);
+
+	// Seeking forward
+	stream.seek(100);
+	EXPECT_EQ(stream.pos(), 100);
+	EXPECT_EQ(stream.readByte(), kDataUncompressed[100]);
+
+	stream.skip(50);
+	EXPECT_EQ(stream.readByte(), kDataUncompressed[151]);
+
+	EXPECT_EQ(stream.getData(), static_cast<const byte *>(0));
+
+	// Seeking backwards decompresses everything
+	stream.seek(10);
+	EXPECT_EQ(stream.pos(), 10);
+	EXPECT_EQ(stream.readByte(), kDataUncompressed[10]);
+
+	ASSERT_NE(stream.getData(), static_cast<const byte *>(0));
+	for (size_t i = 0; i < kSizeDecompressed; i++)
+		EXPECT_EQ(stream.getData()[i], kDataUncompressed[i]) << "At index " << i;
+
+	stream.seek(-1, Common::SeekableReadStream::kOriginEnd);
+	EXPECT_EQ(stream.readByte(), kDataUncompressed[kSizeDecompressed - 1]);
+
+	EXPECT_THROW(stream.seek(kSizeDecompressed + 1), Common::Exception);
+}
+
+GTEST_TEST(DEFLATE, decompressOnDemandFailInputCut) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed) / 2;
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::DeflateReadStream stream(new Common::MemoryReadStream(kDataCompressed, kSizeCompressed), true,
+	                                 kSizeDecompressed, Common::kWindowBitsMaxRaw);
+
+	std::vector<byte> data(kSizeDecompressed);
+	EXPECT_THROW(stream.read(&data[0], kSizeDecompressed), Common::Exception);
+}
+
 GTEST_TEST(DEFLATE, decompressChunked) {
 	static const byte kDataChunked[] = {
 		0x78,0x9C,0x25,0x8B,0x31,0x0E,0xC2,0x40,0x0C,0x04,0xFB,0xBC,0x62,0x1F,0x80,0xF2,
@@ -266,3 +332,27 @@ GTEST_TEST(DEFLATE, decompressChunked) {
 
 	delete[] output;
 }
+
+GTEST_TEST(DEFLATE, compressIncompressible) {
+	/* Random data doesn't compress, so the compressed data is bigger than the input,
+	 * and still pending within zlib when all of the input has been consumed. */
+	std::vector<byte> data(64 * 1024);
+
+	uint32 seed = 1;
+	for (size_t i = 0; i < data.size(); i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (seed >> 16) & 0xFF;
+	}
+
+	size_t compressedSize = 0;
+	Common::ScopedArray<byte> compressed(Common::compressDeflate(&data[0], data.size(), compressedSize,
+	                                                             Common::kWindowBitsMaxRaw, 4096));
+
+	ASSERT_GT(compressedSize, data.size());
+
+	Common::ScopedArray<byte> decompressed(Common::decompressDeflate(compressed.get(), compressedSize,
+	                                                                 data.size(), Common::kWindowBitsMaxRaw));
+
+	for (size_t i = 0; i < data.size(); i++)
+		EXPECT_EQ(decompressed[i], data[i]) << "At index " << i;
+}
@@ -22,9 +22,13 @@
  *  Unit tests for our LZMA decompressor (which uses lzma).
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "src/common/lzma.h"
+#include "src/common/scopedptr.h"
+#include "src/common/parallel.h"
 #include "src/common/memreadstream.h"
 #include "src/common/error.h"
 
@@ -132,3 +136,69 @@ GTEST_TEST(LZMA1, decompressFailInputCut) {
 	EXPECT_THROW(Common::decompressLZMA1(kDataCompressed, kSizeCompressed, kSizeDecompressed),
 	             Common::Exception);
 }
+
+GTEST_TEST(LZMA1, decompressReuse) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed);
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	// The decoder is reused between calls, even after one of them failed
+
+	for (size_t n = 0; n < 4; n++) {
+		EXPECT_THROW(Common::decompressLZMA1(kDataCompressed, kSizeCompressed / 2, kSizeDecompressed),
+		             Common::Exception);
+
+		const byte *decompressed =
+			Common::decompressLZMA1(kDataCompressed, kSizeCompressed, kSizeDecompressed);
+		ASSERT_NE(decompressed, static_cast<const byte *>(0));
+
+		for (size_t i = 0; i < kSizeDecompressed; i++)
+			EXPECT_EQ(decompressed[i], kDataUncompressed[i]) << "At index " << i << ", run " << n;
+
+		delete[] decompressed;
+	}
+}
+
+GTEST_TEST(LZMA1, decompressThreaded) {
+	static const size_t kSizeCompressed   = sizeof(kDataCompressed);
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	static const size_t kJobCount = 64;
+
+	std::vector<int> matches(kJobCount, 0);
+
+	Common::runParallel(4, kJobCount, [&](size_t, size_t job) {
+		const byte *decompressed =
+			Common::decompressLZMA1(kDataCompressed, kSizeCompressed, kSizeDecompressed);
+
+		matches[job] = !memcmp(decompressed, kDataUncompressed, kSizeDecompressed);
+
+		delete[] decompressed;
+	});
+
+	for (size_t i = 0; i < kJobCount; i++)
+		EXPECT_TRUE(matches[i]) << "At job " << i;
+}
+
+GTEST_TEST(LZMA1, compressLarge) {
+	// Pseudo-random data, large enough that the encoder still holds output after consuming all input
+	static const size_t kSize = 256 * 1024;
+
+	std::vector<byte> data(kSize);
+
+	uint32 seed = 0x12345678;
+	for (size_t i = 0; i < kSize; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = (seed >> 16) & 0xFF;
+	}
+
+	Common::MemoryReadStream input(&data[0], kSize);
+	Common::ScopedPtr<Common::SeekableReadStream> compressed(Common::compressLZMA1(input, kSize));
+	ASSERT_TRUE(compressed);
+
+	Common::ScopedPtr<Common::SeekableReadStream>
+		decompressed(Common::decompressLZMA1(*compressed, compressed->size(), kSize, true));
+	ASSERT_EQ(decompressed->size(), kSize);
+
+	for (size_t i = 0; i < kSize; i++)
+		ASSERT_EQ(decompressed->readByte(), data[i]) << "At index " << i;
+}
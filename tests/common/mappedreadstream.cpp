@@ -0,0 +1,143 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our memory-mapped file read stream.
+ */
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/platform.h"
+#include "src/common/mappedreadstream.h"
+
+boost::filesystem::path kFilePath;
+
+static const byte kData[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+class MappedReadStream : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kFilePath = tmpPath / uniquePath;
+	}
+
+	static void TearDownTestCase() {
+		if (!kFilePath.empty())
+			boost::filesystem::remove(kFilePath);
+	}
+
+	static void writeFile(const byte *data, size_t size) {
+		boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+		testFile.write(reinterpret_cast<const char *>(data), size);
+		testFile.flush();
+		ASSERT_FALSE(testFile.fail());
+
+		testFile.close();
+	}
+};
+
+GTEST_TEST_F(MappedReadStream, read) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	writeFile(kData, ARRAYSIZE(kData));
+
+	Common::MappedReadStream stream(kFilePath.generic_string());
+
+	EXPECT_EQ(stream.size(), ARRAYSIZE(kData));
+
+	byte readData[ARRAYSIZE(kData)];
+	const size_t readCount = stream.read(readData, sizeof(readData));
+	EXPECT_EQ(readCount, ARRAYSIZE(readData));
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(readData[i], kData[i]) << "At index " << i;
+
+	EXPECT_FALSE(stream.eos());
+	EXPECT_EQ(stream.read(readData, 1), 0);
+	EXPECT_TRUE(stream.eos());
+
+	EXPECT_EQ(stream.seek(-2, Common::SeekableReadStream::kOriginEnd), ARRAYSIZE(kData));
+	EXPECT_FALSE(stream.eos());
+	EXPECT_EQ(stream.readUint16BE(), 0x7890);
+
+	EXPECT_THROW(stream.seek(ARRAYSIZE(kData) + 1), Common::Exception);
+}
+
+GTEST_TEST_F(MappedReadStream, getData) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	writeFile(kData, ARRAYSIZE(kData));
+
+	Common::MappedReadStream stream(kFilePath.generic_string());
+
+	const byte *data = stream.getData();
+	ASSERT_NE(data, static_cast<const byte *>(0));
+
+	for (size_t i = 0; i < ARRAYSIZE(kData); i++)
+		EXPECT_EQ(data[i], kData[i]) << "At index " << i;
+}
+
+GTEST_TEST_F(MappedReadStream, getSubStream) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	writeFile(kData, ARRAYSIZE(kData));
+
+	Common::MappedReadStream stream(kFilePath.generic_string());
+
+	Common::ScopedPtr<Common::SeekableReadStream> subStream(stream.getSubStream(1, 4));
+
+	// The sub stream should be a direct view into the data of the parent stream
+	EXPECT_EQ(subStream->getData(), stream.getData() + 1);
+
+	EXPECT_EQ(subStream->size(), 3);
+	EXPECT_EQ(subStream->readUint16BE(), 0x3456);
+	EXPECT_EQ(subStream->readByte(), 0x78);
+	EXPECT_THROW(subStream->readByte(), Common::Exception);
+
+	EXPECT_THROW(stream.getSubStream(2, ARRAYSIZE(kData) + 1), Common::Exception);
+}
+
+GTEST_TEST_F(MappedReadStream, empty) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	writeFile(kData, 0);
+
+	Common::MappedReadStream stream(kFilePath.generic_string());
+
+	EXPECT_EQ(stream.size(), 0);
+
+	byte readData;
+	EXPECT_EQ(stream.read(&readData, 1), 0);
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST_F(MappedReadStream, missing) {
+	EXPECT_THROW(Common::MappedReadStream stream("/this/file/does/not/exist.xoreos"), Common::Exception);
+}
@@ -105,6 +105,47 @@ GTEST_TEST(MemoryReadStream, readStream) {
 	EXPECT_THROW(stream.readStream(ARRAYSIZE(data) + 1), Common::Exception);
 }
 
+GTEST_TEST(MemoryReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	stream.seek(1);
+
+	byte readData[4] = { 0 };
+	size_t readCount = stream.readAt(2, readData, 4);
+
+	EXPECT_EQ(readCount, 3);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+	EXPECT_EQ(readData[2], data[4]);
+
+	// The position and eos flag of the stream stay untouched
+	EXPECT_EQ(stream.pos(), 1);
+	EXPECT_FALSE(stream.eos());
+
+	readCount = stream.readAt(ARRAYSIZE(data), readData, 1);
+	EXPECT_EQ(readCount, 0);
+
+	EXPECT_THROW(stream.readAt(ARRAYSIZE(data) + 1, readData, 1), Common::Exception);
+}
+
+GTEST_TEST(MemoryReadStream, readStreamAt) {
+	static const byte data[3] = { 0x12, 0x34, 0x56 };
+	Common::MemoryReadStream stream(data);
+
+	Common::MemoryReadStream *streamRead = stream.readStreamAt(1, 2);
+
+	EXPECT_EQ(streamRead->size(), 2);
+	EXPECT_EQ(streamRead->readByte(), data[1]);
+	EXPECT_EQ(streamRead->readByte(), data[2]);
+
+	delete streamRead;
+
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_THROW(stream.readStreamAt(1, ARRAYSIZE(data)), Common::Exception);
+}
+
 GTEST_TEST(MemoryReadStream, readChar) {
 	static const byte data[3] = { 0x12, 0x34, 0x56 };
 	Common::MemoryReadStream stream(data);
@@ -315,6 +356,45 @@ GTEST_TEST(SeekableSubReadStream, fromMem) {
 	EXPECT_FALSE(subStream.eos());
 }
 
+GTEST_TEST(SeekableSubReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	Common::SeekableSubReadStream subStream(&stream, 1, 4);
+
+	byte readData[4] = { 0 };
+	const size_t readCount = subStream.readAt(1, readData, 4);
+
+	EXPECT_EQ(readCount, 2);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+
+	// The substream placed the parent at its beginning, and readAt() kept it there
+	EXPECT_EQ(subStream.pos(), 0);
+	EXPECT_EQ(stream.pos(), 1);
+
+	EXPECT_THROW(subStream.readAt(4, readData, 1), Common::Exception);
+}
+
+GTEST_TEST(PositionalSubReadStream, interleaved) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	// Two substreams of the same parent don't interfere with each other or the parent
+	Common::PositionalSubReadStream subStream1(&stream, 0, 3);
+	Common::PositionalSubReadStream subStream2(&stream, 2, 5);
+
+	stream.seek(4);
+
+	EXPECT_EQ(subStream1.readByte(), data[0]);
+	EXPECT_EQ(subStream2.readByte(), data[2]);
+	EXPECT_EQ(subStream1.readByte(), data[1]);
+	EXPECT_EQ(subStream2.readByte(), data[3]);
+
+	EXPECT_EQ(stream.pos(), 4);
+	EXPECT_EQ(stream.readByte(), data[4]);
+}
+
 GTEST_TEST(SeekableSubReadStreamEndian, streamEndianLE) {
 	static const byte data[4] = { 0x78, 0x56, 0x34, 0x12 };
 	Common::MemoryReadStream stream(data);
@@ -0,0 +1,83 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our parallel job runner.
+ */
+
+#include <vector>
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/parallel.h"
+
+GTEST_TEST(Parallel, getHardwareThreadCount) {
+	EXPECT_GE(Common::getHardwareThreadCount(), 1);
+}
+
+GTEST_TEST(Parallel, runAllJobs) {
+	static const size_t kJobCount = 1000;
+
+	std::vector<std::atomic<int>> runs(kJobCount);
+	for (size_t i = 0; i < kJobCount; i++)
+		runs[i] = 0;
+
+	Common::runParallel(4, kJobCount, [&](size_t worker, size_t job) {
+		EXPECT_LT(worker, 4);
+
+		runs[job]++;
+	});
+
+	for (size_t i = 0; i < kJobCount; i++)
+		EXPECT_EQ(runs[i], 1) << "At index " << i;
+}
+
+GTEST_TEST(Parallel, singleThread) {
+	std::vector<size_t> order;
+
+	Common::runParallel(1, 10, [&](size_t worker, size_t job) {
+		EXPECT_EQ(worker, 0);
+
+		order.push_back(job);
+	});
+
+	ASSERT_EQ(order.size(), 10);
+	for (size_t i = 0; i < order.size(); i++)
+		EXPECT_EQ(order[i], i) << "At index " << i;
+}
+
+GTEST_TEST(Parallel, noJobs) {
+	bool called = false;
+
+	Common::runParallel(4, 0, [&](size_t, size_t) {
+		called = true;
+	});
+
+	EXPECT_FALSE(called);
+}
+
+GTEST_TEST(Parallel, exception) {
+	EXPECT_THROW(Common::runParallel(4, 100, [&](size_t, size_t job) {
+		if (job == 50)
+			throw Common::Exception("Job %u", (uint) job);
+	}), Common::Exception);
+}
@@ -32,6 +32,7 @@
 
 #include "src/common/util.h"
 #include "src/common/platform.h"
+#include "src/common/error.h"
 #include "src/common/readfile.h"
 
 boost::filesystem::path kFilePath;
@@ -87,3 +88,99 @@ GTEST_TEST_F(ReadFile, write) {
 	for (size_t i = 0; i < ARRAYSIZE(data); i++)
 		EXPECT_EQ(readData[i], data[i]) << "At index " << i;
 }
+
+GTEST_TEST_F(ReadFile, readAt) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	Common::ReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.readByte(), data[0]);
+
+	byte readData[4] = { 0 };
+	const size_t readCount = file.readAt(2, readData, 4);
+
+	EXPECT_EQ(readCount, 3);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+	EXPECT_EQ(readData[2], data[4]);
+
+	// The position of the file stays untouched
+	EXPECT_EQ(file.pos(), 1);
+	EXPECT_EQ(file.readByte(), data[1]);
+
+	EXPECT_THROW(file.readAt(ARRAYSIZE(data) + 1, readData, 1), Common::Exception);
+}
+
+GTEST_TEST_F(ReadFile, large) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	// We can't address files bigger than 4GB with a 32-bit size_t
+	if (sizeof(size_t) < 8)
+		return;
+
+	static const uint64 kLargeSize = 0x140000000ULL; // 5GB
+	static const uint64 kMarkerPos = 0x100000010ULL; // 4GB + 16
+
+	static const byte data[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+	// Create a sparse input file, with a marker above 4GB and at the very end
+
+	{
+		boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+		ASSERT_FALSE(testFile.fail());
+	}
+
+	boost::system::error_code error;
+	boost::filesystem::resize_file(kFilePath, kLargeSize, error);
+	if (error) {
+		std::cerr << "Can't create a sparse " << kLargeSize << " bytes file, skipping test" << std::endl;
+		return;
+	}
+
+	{
+		boost::filesystem::fstream testFile(kFilePath, std::ios::in | std::ios::out | std::ios::binary);
+
+		testFile.seekp(kMarkerPos);
+		testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+		testFile.seekp(kLargeSize - ARRAYSIZE(data));
+		testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+		testFile.flush();
+		ASSERT_FALSE(testFile.fail());
+	}
+
+	// Read the file with our ReadFile class
+
+	Common::ReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.size(), kLargeSize);
+
+	file.seek(kMarkerPos);
+	EXPECT_EQ(file.pos(), kMarkerPos);
+	EXPECT_EQ(file.readUint32BE(), 0x12345678);
+	EXPECT_EQ(file.pos(), kMarkerPos + 4);
+
+	file.seek(-4, Common::SeekableReadStream::kOriginEnd);
+	EXPECT_EQ(file.pos(), kLargeSize - 4);
+	EXPECT_EQ(file.readUint32BE(), 0x12345678);
+
+	file.seek(-(ptrdiff_t)(kLargeSize - kMarkerPos), Common::SeekableReadStream::kOriginCurrent);
+	EXPECT_EQ(file.readUint32LE(), 0x78563412);
+
+	EXPECT_THROW(file.seek(kLargeSize + 1), Common::Exception);
+
+	file.close();
+
+	boost::filesystem::remove(kFilePath);
+}
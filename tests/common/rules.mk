@@ -85,6 +85,16 @@ tests_common_test_readfile_SOURCES  = tests/common/readfile.cpp
 tests_common_test_readfile_LDADD    = $(common_LIBS)
 tests_common_test_readfile_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                             += tests/common/test_mappedreadstream
+tests_common_test_mappedreadstream_SOURCES  = tests/common/mappedreadstream.cpp
+tests_common_test_mappedreadstream_LDADD    = $(common_LIBS)
+tests_common_test_mappedreadstream_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                               += tests/common/test_bufferedreadstream
+tests_common_test_bufferedreadstream_SOURCES  = tests/common/bufferedreadstream.cpp
+tests_common_test_bufferedreadstream_LDADD    = $(common_LIBS)
+tests_common_test_bufferedreadstream_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                      += tests/common/test_writefile
 tests_common_test_writefile_SOURCES  = tests/common/writefile.cpp
 tests_common_test_writefile_LDADD    = $(common_LIBS)
@@ -172,6 +182,11 @@ tests_common_test_md5_SOURCES  = tests/common/md5.cpp
 tests_common_test_md5_LDADD    = $(common_LIBS)
 tests_common_test_md5_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                   += tests/common/test_base64
+tests_common_test_base64_SOURCES  = tests/common/base64.cpp
+tests_common_test_base64_LDADD    = $(common_LIBS)
+tests_common_test_base64_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                    += tests/common/test_deflate
 tests_common_test_deflate_SOURCES  = tests/common/deflate.cpp
 tests_common_test_deflate_LDADD    = $(common_LIBS)
@@ -196,3 +211,29 @@ check_PROGRAMS                  += tests/common/test_maths
 tests_common_test_maths_SOURCES  = tests/common/maths.cpp
 tests_common_test_maths_LDADD    = $(common_LIBS)
 tests_common_test_maths_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                     += tests/common/test_parallel
+tests_common_test_parallel_SOURCES  = tests/common/parallel.cpp
+tests_common_test_parallel_LDADD    = $(common_LIBS)
+tests_common_test_parallel_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                           += tests/common/benchmark_readstream
+tests_common_benchmark_readstream_SOURCES  = tests/common/benchmark_readstream.cpp
+tests_common_benchmark_readstream_LDADD    = \
+    $(benchmark_LIBS) \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_common_benchmark_readstream_CXXFLAGS = $(AM_CXXFLAGS)
+
+check_PROGRAMS                          += tests/common/benchmark_binsearch
+tests_common_benchmark_binsearch_SOURCES  = tests/common/benchmark_binsearch.cpp
+tests_common_benchmark_binsearch_LDADD    = \
+    $(benchmark_LIBS) \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_common_benchmark_binsearch_CXXFLAGS = $(AM_CXXFLAGS)
@@ -0,0 +1,848 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmark of our image decoders.
+ *
+ *  For every Images::Decoder, we create a synthetic image and measure the
+ *  time spent loading it, decompressing its S3TC data (where it has any),
+ *  flipping it, deswizzling it and dumping it into a TGA, each of those
+ *  stages separately. Fixture files given on the command line are measured
+ *  as well. The results are written as CSV, one line per image and stage,
+ *  so that they can be tracked and compared between builds.
+ *
+ *  On top of that, we dump large raw BGRA and BGR textures, 4096x4096 by
+ *  default, into raw and RLE-compressed TGAs. And we decompress a corpus of
+ *  DXT1, DXT3 and DXT5 textures of many sizes, with all their mip maps. DDS
+ *  fixtures in one of those formats are added to the corpus as well.
+ *
+ *  Usage: benchmark [-i <iterations>] [-n <size>] [-o <results.csv>] [<fixture> [...]]
+ *
+ *  Run without arguments, like as part of the unit tests, every stage only
+ *  runs once, to make sure the benchmark itself still works.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include <vector>
+#include <functional>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ptrvector.h"
+#include "src/common/ustring.h"
+#include "src/common/filepath.h"
+#include "src/common/readfile.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/util.h"
+#include "src/aurora/smallfile.h"
+
+#include "src/images/util.h"
+#include "src/images/decoder.h"
+#include "src/images/dumptga.h"
+#include "src/images/convert.h"
+#include "src/images/dds.h"
+#include "src/images/tpc.h"
+#include "src/images/txb.h"
+#include "src/images/sbm.h"
+#include "src/images/tga.h"
+#include "src/images/xoreositex.h"
+#include "src/images/ncgr.h"
+#include "src/images/nbfs.h"
+#include "src/images/cbgt.h"
+#include "src/images/cdpth.h"
+#include "src/images/winiconimage.h"
+
+#include "tests/benchmark/benchmark.h"
+
+typedef std::vector<byte> Buffer;
+typedef std::vector<Buffer> Files;
+
+/** A decoder giving us access to the decompression, and to raw random images. */
+class BenchmarkDecoder : public Images::Decoder {
+public:
+	static void decompress(MipMap &out, const MipMap &in, Images::PixelFormat format) {
+		Images::Decoder::decompress(out, in, format);
+	}
+
+	BenchmarkDecoder(Images::PixelFormat format, int width, int height) {
+		_format = format;
+
+		_mipMaps.push_back(new MipMap);
+
+		MipMap &mipMap = *_mipMaps.back();
+
+		mipMap.width  = width;
+		mipMap.height = height;
+		mipMap.size   = Images::getDataSize(format, width, height);
+
+		mipMap.data.reset(new byte[mipMap.size]);
+
+		// Random pixels, with runs of equal pixels mixed in
+		const int bpp = Images::getBPP(format);
+		for (uint32 i = 0; i < mipMap.size; i += bpp) {
+			if ((i > 0) && ((std::rand() % 4) != 0))
+				std::memcpy(&mipMap.data[i], &mipMap.data[i - bpp], bpp);
+			else
+				for (int j = 0; j < bpp; j++)
+					mipMap.data[i + j] = std::rand() & 0xFF;
+		}
+	}
+};
+
+/** An image to benchmark. */
+struct Image {
+	Common::UString name;
+
+	/** All the files making up the image, like the image data and the palette. */
+	Files files;
+	/** Open the image out of its files. */
+	std::function<Images::Decoder *(const Files &files)> open;
+
+	/** The S3TC-compressed mip maps within the files, if any. */
+	Common::PtrVector<Images::Decoder::MipMap> compressed;
+	Images::PixelFormat compressedFormat;
+
+	Image(const Common::UString &n) : name(n), compressedFormat(Images::kPixelFormatB8G8R8A8) {
+	}
+};
+
+
+static Buffer createData(size_t size, bool runs = false) {
+	Buffer data(size);
+
+	for (size_t i = 0; i < size; i++) {
+		if (runs && (i > 0) && ((std::rand() % 4) != 0))
+			data[i] = data[i - 1];
+		else
+			data[i] = std::rand() & 0xFF;
+	}
+
+	return data;
+}
+
+static Buffer toBuffer(Common::MemoryWriteStreamDynamic &stream) {
+	return Buffer(stream.getData(), stream.getData() + stream.size());
+}
+
+/** Create a chain of random S3TC mip maps, and write them into the stream. */
+static void createCompressed(Image &image, Common::WriteStream &stream, Images::PixelFormat format,
+                             uint32 width, uint32 height, size_t mipMapCount) {
+
+	image.compressedFormat = format;
+
+	for (size_t i = 0; i < mipMapCount; i++) {
+		image.compressed.push_back(new Images::Decoder::MipMap);
+
+		Images::Decoder::MipMap &mipMap = *image.compressed.back();
+
+		mipMap.width  = MAX<uint32>(width  >> i, 1);
+		mipMap.height = MAX<uint32>(height >> i, 1);
+		mipMap.size   = Images::getDataSize(format, mipMap.width, mipMap.height);
+
+		const Buffer data = createData(mipMap.size);
+
+		mipMap.data.reset(new byte[mipMap.size]);
+		std::memcpy(mipMap.data.get(), &data[0], mipMap.size);
+
+		stream.write(mipMap.data.get(), mipMap.size);
+	}
+}
+
+/** Create an LZSS-compressed cell file, as used by CBGT and CDPTH. */
+static Buffer createCells(size_t cellCount, size_t cellSize) {
+	Common::MemoryWriteStreamDynamic table(true), cells(true);
+
+	for (size_t i = 0; i < cellCount; i++) {
+		const Buffer cell = createData(cellSize, true);
+		Common::MemoryReadStream cellStream(&cell[0], cell.size());
+
+		const size_t offset = cells.size();
+		Aurora::Small::compress10(cellStream, cells);
+
+		table.writeUint16LE(cells.size() - offset);
+		table.writeUint16LE((0x4000 + offset) / 512);
+
+		cells.writeZeros((512 - (cells.size() % 512)) % 512);
+	}
+
+	table.writeZeros(0x4000 - table.size());
+
+	Buffer file = toBuffer(table);
+	file.insert(file.end(), cells.getData(), cells.getData() + cells.size());
+
+	return file;
+}
+
+/** Create a Nitro palette file with 256 colors. */
+static Buffer createNCLR() {
+	Common::MemoryWriteStreamDynamic nclr(true);
+
+	nclr.writeUint32BE(MKTAG('R', 'L', 'C', 'N'));
+	nclr.writeUint16BE(0xFFFE);
+	nclr.writeUint16LE(0x0100);
+	nclr.writeUint32LE(16 + 24 + 512);
+	nclr.writeUint16LE(16);
+	nclr.writeUint16LE(1);
+
+	nclr.writeUint32BE(MKTAG('T', 'T', 'L', 'P'));
+	nclr.writeUint32LE(24 + 512);
+	nclr.writeUint16LE(4);
+	nclr.writeZeros(6);
+	nclr.writeUint32LE(512);
+	nclr.writeUint32LE(16);
+
+	const Buffer colors = createData(512);
+	nclr.write(&colors[0], colors.size());
+
+	return toBuffer(nclr);
+}
+
+static Image *createDDS(uint32 width, uint32 height, bool compressed) {
+	Common::ScopedPtr<Image> image(new Image(compressed ? "DDS" : "DDS-BGRA"));
+
+	const size_t mipMapCount = Common::intLog2(MAX(width, height)) + 1;
+
+	Common::MemoryWriteStreamDynamic dds(true);
+
+	dds.writeUint32BE(MKTAG('D', 'D', 'S', ' '));
+	dds.writeUint32LE(124);
+	dds.writeUint32LE(0x00021007);
+	dds.writeUint32LE(height);
+	dds.writeUint32LE(width);
+	dds.writeZeros(4 + 4);
+	dds.writeUint32LE(mipMapCount);
+	dds.writeZeros(44);
+
+	dds.writeUint32LE(32);
+
+	if (compressed) {
+		dds.writeUint32LE(0x00000004);
+		dds.writeUint32BE(MKTAG('D', 'X', 'T', '1'));
+		dds.writeZeros(4 + 4 * 4);
+	} else {
+		dds.writeUint32LE(0x00000041);
+		dds.writeUint32LE(0);
+		dds.writeUint32LE(32);
+		dds.writeUint32LE(0x00FF0000);
+		dds.writeUint32LE(0x0000FF00);
+		dds.writeUint32LE(0x000000FF);
+		dds.writeUint32LE(0xFF000000);
+	}
+
+	dds.writeZeros(16 + 4);
+
+	if (compressed) {
+		createCompressed(*image, dds, Images::kPixelFormatDXT1, width, height, mipMapCount);
+	} else {
+		for (size_t i = 0; i < mipMapCount; i++) {
+			const Buffer mipMap = createData(MAX<uint32>(width >> i, 1) * MAX<uint32>(height >> i, 1) * 4, true);
+
+			dds.write(&mipMap[0], mipMap.size());
+		}
+	}
+
+	image->files.push_back(toBuffer(dds));
+	image->open = [](const Files &files) {
+		return new Images::DDS(new Common::MemoryReadStream(&files[0][0], files[0].size()));
+	};
+
+	return image.release();
+}
+
+static Image *createBioWareDDS(uint32 width, uint32 height) {
+	Common::ScopedPtr<Image> image(new Image("DDS-BioWare"));
+
+	Common::MemoryWriteStreamDynamic dds(true);
+
+	dds.writeUint32LE(width);
+	dds.writeUint32LE(height);
+	dds.writeUint32LE(4);
+	dds.writeUint32LE(width * height);
+	dds.writeZeros(4);
+
+	createCompressed(*image, dds, Images::kPixelFormatDXT5, width, height,
+	                 Common::intLog2(MAX(width, height)) + 1);
+
+	image->files.push_back(toBuffer(dds));
+	image->open = [](const Files &files) {
+		return new Images::DDS(new Common::MemoryReadStream(&files[0][0], files[0].size()));
+	};
+
+	return image.release();
+}
+
+static Image *createTPC(uint32 width, uint32 height) {
+	Common::ScopedPtr<Image> image(new Image("TPC"));
+
+	const size_t mipMapCount = Common::intLog2(MAX(width, height)) + 1;
+
+	Common::MemoryWriteStreamDynamic tpc(true);
+
+	tpc.writeUint32LE(width * height);
+	tpc.writeZeros(4);
+	tpc.writeUint16LE(width);
+	tpc.writeUint16LE(height);
+	tpc.writeByte(0x04);
+	tpc.writeByte(mipMapCount);
+	tpc.writeZeros(114);
+
+	createCompressed(*image, tpc, Images::kPixelFormatDXT5, width, height, mipMapCount);
+
+	image->files.push_back(toBuffer(tpc));
+	image->open = [](const Files &files) {
+		return new Images::TPC(new Common::MemoryReadStream(&files[0][0], files[0].size()));
+	};
+
+	return image.release();
+}
+
+static Image *createTXB(uint32 width, uint32 height) {
+	Common::ScopedPtr<Image> image(new Image("TXB"));
+
+	// Swizzled BGRA mip maps
+	const size_t mipMapCount = Common::intLog2(MAX(width, height)) + 1;
+
+	Buffer data;
+	for (size_t i = 0; i < mipMapCount; i++) {
+		const Buffer mipMap = createData(MAX<uint32>(width >> i, 1) * MAX<uint32>(height >> i, 1) * 4, true);
+
+		data.insert(data.end(), mipMap.begin(), mipMap.end());
+	}
+
+	Common::MemoryWriteStreamDynamic txb(true);
+
+	txb.writeUint32LE(data.size());
+	txb.writeZeros(4);
+	txb.writeUint16LE(width);
+	txb.writeUint16LE(height);
+	txb.writeByte(0x04);
+	txb.writeByte(mipMapCount);
+	txb.writeUint16LE(0x0101);
+	txb.writeZeros(4 + 108);
+
+	txb.write(&data[0], data.size());
+
+	image->files.push_back(toBuffer(txb));
+	image->open = [](const Files &files) {
+		return new Images::TXB(new Common::MemoryReadStream(&files[0][0], files[0].size()));
+	};
+
+	return image.release();
+}
+
+static Image *createSBM(size_t rowCount) {
+	Common::ScopedPtr<Image> image(new Image("SBM"));
+
+	image->files.push_back(createData(rowCount * 1024, true));
+	image->open = [](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		return new Images::SBM(stream, true);
+	};
+
+	return image.release();
+}
+
+static Image *createTGA(uint32 width, uint32 height, bool rle) {
+	Common::ScopedPtr<Image> image(new Image(rle ? "TGA-RLE" : "TGA"));
+
+	const BenchmarkDecoder source(Images::kPixelFormatB8G8R8A8, width, height);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, source, rle);
+
+	image->files.push_back(toBuffer(tga));
+	image->open = [](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		return new Images::TGA(stream);
+	};
+
+	return image.release();
+}
+
+static Image *createXEOSITEX(uint32 width, uint32 height) {
+	Common::ScopedPtr<Image> image(new Image("XEOSITEX"));
+
+	const Buffer data = createData(width * height * 4, true);
+
+	Common::MemoryWriteStreamDynamic xeositex(true);
+
+	xeositex.writeUint32BE(MKTAG('X', 'E', 'O', 'S'));
+	xeositex.writeUint32BE(MKTAG('I', 'T', 'E', 'X'));
+	xeositex.writeUint32LE(0);
+	xeositex.writeUint32LE(4);
+	xeositex.writeZeros(6);
+	xeositex.writeUint32LE(1);
+
+	xeositex.writeUint32LE(width);
+	xeositex.writeUint32LE(height);
+	xeositex.writeUint32LE(data.size());
+	xeositex.write(&data[0], data.size());
+
+	image->files.push_back(toBuffer(xeositex));
+	image->open = [](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		return new Images::XEOSITEX(stream);
+	};
+
+	return image.release();
+}
+
+static Image *createNCGR(uint32 width, uint32 height, uint8 depth) {
+	Common::ScopedPtr<Image> image(new Image((depth == 4) ? "NCGR-4" : "NCGR"));
+
+	const Buffer data = createData(width * height * depth / 8, true);
+
+	Common::MemoryWriteStreamDynamic ncgr(true);
+
+	ncgr.writeUint32BE(MKTAG('R', 'G', 'C', 'N'));
+	ncgr.writeUint16BE(0xFFFE);
+	ncgr.writeUint16LE(0x0101);
+	ncgr.writeUint32LE(16 + 32 + data.size());
+	ncgr.writeUint16LE(16);
+	ncgr.writeUint16LE(1);
+
+	ncgr.writeUint32BE(MKTAG('R', 'A', 'H', 'C'));
+	ncgr.writeUint32LE(32 + data.size());
+	ncgr.writeUint16LE(height / 8);
+	ncgr.writeUint16LE(width  / 8);
+	ncgr.writeUint32LE((depth == 4) ? 3 : 4);
+	ncgr.writeZeros(4 + 1 + 1 + 2);
+	ncgr.writeUint32LE(data.size());
+	ncgr.writeUint32LE(24);
+
+	ncgr.write(&data[0], data.size());
+
+	image->files.push_back(toBuffer(ncgr));
+	image->files.push_back(createNCLR());
+	image->open = [](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		Common::MemoryReadStream palette(&files[1][0], files[1].size());
+		return new Images::NCGR(stream, palette);
+	};
+
+	return image.release();
+}
+
+static Image *createNBFS(uint32 width, uint32 height) {
+	Common::ScopedPtr<Image> image(new Image("NBFS"));
+
+	image->files.push_back(createData(width * height, true));
+	image->files.push_back(createData(512));
+	image->open = [width, height](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		Common::MemoryReadStream palette(&files[1][0], files[1].size());
+		return new Images::NBFS(stream, palette, width, height);
+	};
+
+	return image.release();
+}
+
+static Image *createCBGT(uint32 cellsX, uint32 cellsY) {
+	Common::ScopedPtr<Image> image(new Image("CBGT"));
+
+	// Two palettes, alternating in a checkerboard pattern
+	Common::UString twoDA = "2DA V2.0\n\n";
+	for (uint32 x = 0; x < cellsX; x++)
+		twoDA += Common::UString::format(" %u", x);
+	twoDA += "\n";
+
+	for (uint32 y = 0; y < cellsY; y++) {
+		twoDA += Common::UString::format("%u", y);
+		for (uint32 x = 0; x < cellsX; x++)
+			twoDA += Common::UString::format(" palette%02u.pal", (x + y) % 2);
+		twoDA += "\n";
+	}
+
+	image->files.push_back(createCells(cellsX * cellsY, 64 * 64));
+	image->files.push_back(createData(2 * 512));
+	image->files.push_back(Buffer(twoDA.c_str(), twoDA.c_str() + std::strlen(twoDA.c_str())));
+	image->open = [](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		Common::MemoryReadStream palette(&files[1][0], files[1].size());
+		Common::MemoryReadStream mapping(&files[2][0], files[2].size());
+		return new Images::CBGT(stream, palette, mapping);
+	};
+
+	return image.release();
+}
+
+static Image *createCDPTH(uint32 cellsX, uint32 cellsY) {
+	Common::ScopedPtr<Image> image(new Image("CDPTH"));
+
+	image->files.push_back(createCells(cellsX * cellsY, 64 * 64 * 2));
+	image->open = [cellsX, cellsY](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		return new Images::CDPTH(stream, cellsX * 64, cellsY * 64);
+	};
+
+	return image.release();
+}
+
+static Image *createICO(uint32 size) {
+	Common::ScopedPtr<Image> image(new Image("ICO"));
+
+	const Buffer xorMap = createData(size * size * 3, true);
+	const Buffer andMap = createData(size * size / 8, true);
+
+	Common::MemoryWriteStreamDynamic ico(true);
+
+	ico.writeUint16LE(0);
+	ico.writeUint16LE(1);
+	ico.writeUint16LE(1);
+
+	ico.writeByte(size & 0xFF);
+	ico.writeByte(size & 0xFF);
+	ico.writeByte(0);
+	ico.writeByte(0);
+	ico.writeUint16LE(1);
+	ico.writeUint16LE(24);
+	ico.writeUint32LE(40 + xorMap.size() + andMap.size());
+	ico.writeUint32LE(6 + 16);
+
+	ico.writeUint32LE(40);
+	ico.writeUint32LE(size);
+	ico.writeUint32LE(size * 2);
+	ico.writeUint16LE(1);
+	ico.writeUint16LE(24);
+	ico.writeUint32LE(0);
+	ico.writeUint32LE(xorMap.size() + andMap.size());
+	ico.writeZeros(16);
+
+	ico.write(&xorMap[0], xorMap.size());
+	ico.write(&andMap[0], andMap.size());
+
+	image->files.push_back(toBuffer(ico));
+	image->open = [](const Files &files) {
+		Common::MemoryReadStream stream(&files[0][0], files[0].size());
+		return new Images::WinIconImage(stream);
+	};
+
+	return image.release();
+}
+
+static Image *openFixture(const Common::UString &fileName) {
+	Common::ScopedPtr<Image> image(new Image(Common::FilePath::getFile(fileName)));
+
+	Common::ReadFile file(fileName);
+
+	image->files.push_back(Buffer(file.size()));
+	if (file.read(&image->files[0][0], file.size()) != file.size())
+		throw Common::Exception(Common::kReadError);
+
+	const Aurora::FileType type = TypeMan.getFileType(fileName);
+
+	if (Images::isTextureType(type)) {
+		image->open = [type](const Files &files) {
+			return Images::openImage(new Common::MemoryReadStream(&files[0][0], files[0].size()), type);
+		};
+
+	} else if (type == Aurora::kFileTypeXEOSITEX) {
+		image->open = [](const Files &files) {
+			Common::MemoryReadStream stream(&files[0][0], files[0].size());
+			return new Images::XEOSITEX(stream);
+		};
+
+	} else if ((type == Aurora::kFileTypeCUR) || (type == Aurora::kFileTypeICO)) {
+		image->open = [](const Files &files) {
+			Common::MemoryReadStream stream(&files[0][0], files[0].size());
+			return new Images::WinIconImage(stream);
+		};
+
+	} else
+		throw Common::Exception("Unsupported fixture \"%s\"", fileName.c_str());
+
+	return image.release();
+}
+
+/** Create a corpus of S3TC-compressed textures of many sizes, with all their mip maps. */
+static Image *createDXTCorpus(Images::PixelFormat format, const char *name) {
+	Common::ScopedPtr<Image> image(new Image(Common::UString::format("%s-corpus", name)));
+
+	for (uint32 size = 16; size <= 1024; size *= 2) {
+		Common::MemoryWriteStreamDynamic data(true);
+
+		createCompressed(*image, data, format, size, size, Common::intLog2(size) + 1);
+		createCompressed(*image, data, format, size, size / 2, Common::intLog2(size) + 1);
+	}
+
+	return image.release();
+}
+
+/** Add the mip maps of an S3TC-compressed DDS fixture to the DXT corpus of its format.
+ *
+ *  Returns false if the file is not a standard DDS in one of the formats of the corpus.
+ */
+static bool addToDXTCorpus(Common::PtrVector<Image> &corpus, const Common::UString &fileName) {
+	if (TypeMan.getFileType(fileName) != Aurora::kFileTypeDDS)
+		return false;
+
+	Common::ReadFile dds(fileName);
+
+	if ((dds.size() < 128) || (dds.readUint32BE() != MKTAG('D', 'D', 'S', ' ')))
+		return false;
+
+	dds.seek(12);
+	const uint32 height = dds.readUint32LE();
+	const uint32 width  = dds.readUint32LE();
+
+	dds.seek(28);
+	const size_t mipMapCount = MAX<uint32>(dds.readUint32LE(), 1);
+
+	dds.seek(84);
+	const uint32 fourCC = dds.readUint32BE();
+
+	Image *image = 0;
+	for (Common::PtrVector<Image>::iterator c = corpus.begin(); c != corpus.end(); ++c) {
+		const Images::PixelFormat format = (*c)->compressedFormat;
+
+		if (((format == Images::kPixelFormatDXT1) && (fourCC == MKTAG('D', 'X', 'T', '1'))) ||
+		    ((format == Images::kPixelFormatDXT3) && (fourCC == MKTAG('D', 'X', 'T', '3'))) ||
+		    ((format == Images::kPixelFormatDXT5) && (fourCC == MKTAG('D', 'X', 'T', '5'))))
+			image = *c;
+	}
+
+	if (!image)
+		return false;
+
+	dds.seek(128);
+
+	for (size_t i = 0; i < mipMapCount; i++) {
+		Common::ScopedPtr<Images::Decoder::MipMap> mipMap(new Images::Decoder::MipMap);
+
+		mipMap->width  = MAX<uint32>(width  >> i, 1);
+		mipMap->height = MAX<uint32>(height >> i, 1);
+		mipMap->size   = Images::getDataSize(image->compressedFormat, mipMap->width, mipMap->height);
+
+		mipMap->data.reset(new byte[mipMap->size]);
+		if (dds.read(mipMap->data.get(), mipMap->size) != mipMap->size)
+			throw Common::Exception(Common::kReadError);
+
+		image->compressed.push_back(mipMap.release());
+	}
+
+	return true;
+}
+
+static void createImages(Common::PtrVector<Image> &images) {
+	std::srand(0);
+
+	images.push_back(createDDS(256, 256, true));
+	images.push_back(createDDS(256, 256, false));
+	images.push_back(createBioWareDDS(256, 256));
+	images.push_back(createTPC(256, 256));
+	images.push_back(createTXB(256, 256));
+	images.push_back(createSBM(8));
+	images.push_back(createTGA(256, 256, false));
+	images.push_back(createTGA(256, 256, true));
+	images.push_back(createXEOSITEX(256, 256));
+	images.push_back(createNCGR(256, 256, 8));
+	images.push_back(createNCGR(256, 256, 4));
+	images.push_back(createNBFS(256, 256));
+	images.push_back(createCBGT(4, 4));
+	images.push_back(createCDPTH(4, 4));
+	images.push_back(createICO(256));
+}
+
+static void createDXTCorpora(Common::PtrVector<Image> &corpus) {
+	std::srand(0);
+
+	corpus.push_back(createDXTCorpus(Images::kPixelFormatDXT1, "DXT1"));
+	corpus.push_back(createDXTCorpus(Images::kPixelFormatDXT3, "DXT3"));
+	corpus.push_back(createDXTCorpus(Images::kPixelFormatDXT5, "DXT5"));
+}
+
+
+static void writeResult(Benchmark::Results &results, const Image &image, const char *stage,
+                        const Images::Decoder::MipMap &mipMap, size_t iterations, size_t bytes, double seconds) {
+
+	results.write(Common::UString::format("%s,%s,%d,%d", image.name.c_str(), stage, mipMap.width, mipMap.height),
+	              iterations, bytes, seconds);
+}
+
+static void benchmark(Benchmark::Results &out, const Image &image, size_t iterations) {
+	size_t inputSize = 0;
+	for (Files::const_iterator f = image.files.begin(); f != image.files.end(); ++f)
+		inputSize += f->size();
+
+	// Load the image, including all its conversion into a usable format
+	Common::ScopedPtr<Images::Decoder> decoder;
+	double seconds = Benchmark::measure(iterations, [&]() {
+		decoder.reset(image.open(image.files));
+	});
+
+	const Images::Decoder::MipMap &mipMap = decoder->getMipMap(0);
+	writeResult(out, image, "load", mipMap, iterations, inputSize, seconds);
+
+	size_t imageSize = 0;
+	for (size_t i = 0; i < decoder->getLayerCount(); i++)
+		for (size_t j = 0; j < decoder->getMipMapCount(); j++)
+			imageSize += decoder->getMipMap(j, i).size;
+
+	// Only the S3TC decompression, which is already part of loading
+	if (!image.compressed.empty()) {
+		size_t decompressedSize = 0;
+		seconds = Benchmark::measure(iterations, [&]() {
+			decompressedSize = 0;
+
+			for (size_t i = 0; i < image.compressed.size(); i++) {
+				Images::Decoder::MipMap decompressed;
+				BenchmarkDecoder::decompress(decompressed, *image.compressed[i], image.compressedFormat);
+
+				decompressedSize += decompressed.size;
+			}
+		});
+
+		writeResult(out, image, "decompress", mipMap, iterations, decompressedSize, seconds);
+	}
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		decoder->flipHorizontally();
+		decoder->flipVertically();
+	});
+
+	writeResult(out, image, "flip", mipMap, iterations, imageSize, seconds);
+
+	// Deswizzling only works on power-of-two dimensions
+	const int bpp = Images::getBPP(decoder->getFormat());
+	const bool widthPOT  = (mipMap.width  & (mipMap.width  - 1)) == 0;
+	const bool heightPOT = (mipMap.height & (mipMap.height - 1)) == 0;
+
+	if ((bpp > 0) && widthPOT && heightPOT) {
+		Buffer deswizzled(mipMap.size);
+
+		seconds = Benchmark::measure(iterations, [&]() {
+			Images::deSwizzle(&deswizzled[0], mipMap.getData(), mipMap.width, mipMap.height, bpp);
+		});
+
+		writeResult(out, image, "deswizzle", mipMap, iterations, mipMap.size, seconds);
+	}
+
+	Common::MemoryWriteStreamDynamic tga(true);
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		tga.seek(0);
+		Images::dumpTGA(tga, *decoder, false);
+	});
+
+	writeResult(out, image, "dumptga", mipMap, iterations, tga.pos(), seconds);
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		tga.seek(0);
+		Images::dumpTGA(tga, *decoder, true);
+	});
+
+	writeResult(out, image, "dumptga_rle", mipMap, iterations, tga.pos(), seconds);
+}
+
+/** Decompress all the mip maps in a DXT corpus. */
+static void benchmarkDXTCorpus(Benchmark::Results &out, const Image &corpus, size_t iterations) {
+	// The biggest texture in the corpus, for the width and height columns
+	const Images::Decoder::MipMap *biggest = corpus.compressed[0];
+	for (size_t i = 0; i < corpus.compressed.size(); i++)
+		if (corpus.compressed[i]->size > biggest->size)
+			biggest = corpus.compressed[i];
+
+	size_t decompressedSize = 0;
+	const double seconds = Benchmark::measure(iterations, [&]() {
+		decompressedSize = 0;
+
+		for (size_t i = 0; i < corpus.compressed.size(); i++) {
+			Images::Decoder::MipMap decompressed;
+			BenchmarkDecoder::decompress(decompressed, *corpus.compressed[i], corpus.compressedFormat);
+
+			decompressedSize += decompressed.size;
+		}
+	});
+
+	writeResult(out, corpus, "decompress", *biggest, iterations, decompressedSize, seconds);
+}
+
+/** Dump a large texture, of size x size pixels, into a raw and an RLE-compressed TGA. */
+static void benchmarkLargeTGA(Benchmark::Results &out, Images::PixelFormat format, const char *name,
+                              uint32 size, size_t iterations) {
+
+	const Image image(Common::UString::format("%s-large", name));
+	const BenchmarkDecoder decoder(format, size, size);
+
+	const Images::Decoder::MipMap &mipMap = decoder.getMipMap(0);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+
+	double seconds = Benchmark::measure(iterations, [&]() {
+		tga.seek(0);
+		Images::dumpTGA(tga, decoder, false);
+	});
+
+	writeResult(out, image, "dumptga", mipMap, iterations, tga.pos(), seconds);
+
+	seconds = Benchmark::measure(iterations, [&]() {
+		tga.seek(0);
+		Images::dumpTGA(tga, decoder, true);
+	});
+
+	writeResult(out, image, "dumptga_rle", mipMap, iterations, tga.pos(), seconds);
+}
+
+int main(int argc, char **argv) {
+	try {
+		Benchmark::Options options;
+		Benchmark::parseCommandLine(argc, argv, options, true, true, "size");
+
+		if (options.counts.empty())
+			options.counts.push_back(4096);
+
+		Common::PtrVector<Image> images, corpus;
+		createImages(images);
+		createDXTCorpora(corpus);
+
+		for (std::vector<Common::UString>::const_iterator f = options.files.begin(); f != options.files.end(); ++f) {
+			images.push_back(openFixture(*f));
+			addToDXTCorpus(corpus, *f);
+		}
+
+		Benchmark::Results results(options.outFile, "image,stage,width,height");
+
+		for (Common::PtrVector<Image>::const_iterator i = images.begin(); i != images.end(); ++i)
+			benchmark(results, **i, options.iterations);
+
+		for (std::vector<size_t>::const_iterator n = options.counts.begin(); n != options.counts.end(); ++n) {
+			benchmarkLargeTGA(results, Images::kPixelFormatB8G8R8A8, "BGRA", *n, options.iterations);
+			benchmarkLargeTGA(results, Images::kPixelFormatB8G8R8  , "BGR" , *n, options.iterations);
+		}
+
+		for (Common::PtrVector<Image>::const_iterator c = corpus.begin(); c != corpus.end(); ++c)
+			benchmarkDXTCorpus(results, **c, options.iterations);
+
+		results.flush();
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+	}
+
+	return 0;
+}
@@ -0,0 +1,274 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the generic image decoder interface.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/images/decoder.h"
+#include "src/images/util.h"
+#include "src/images/s3tc.h"
+#include "src/images/dds.h"
+
+/** An image decoder with a chain of random DXTn mip maps in each layer. */
+class TestDecoder : public Images::Decoder {
+public:
+	TestDecoder(Images::PixelFormat format, size_t layerCount, int width, int height) {
+		_format     = format;
+		_layerCount = layerCount;
+
+		std::srand(width * height);
+
+		for (size_t l = 0; l < layerCount; l++) {
+			for (int w = width, h = height; (w > 0) && (h > 0); w /= 2, h /= 2) {
+				_mipMaps.push_back(new MipMap);
+
+				MipMap &mipMap = *_mipMaps.back();
+
+				mipMap.width  = w;
+				mipMap.height = h;
+				mipMap.size   = Images::getDataSize(format, w, h);
+
+				mipMap.data.reset(new byte[mipMap.size]);
+				for (uint32 i = 0; i < mipMap.size; i++)
+					mipMap.data[i] = std::rand() & 0xFF;
+			}
+		}
+	}
+
+	void decompress(size_t threads) {
+		Images::Decoder::decompress(threads);
+	}
+
+	void dropUnusedMipMaps(int mipMap) {
+		Images::Decoder::dropUnusedMipMaps(mipMap);
+	}
+};
+
+static void decompressReference(std::vector<byte> &out, const Images::Decoder::MipMap &in, Images::PixelFormat format) {
+	out.resize(MAX(in.width * in.height * 4, 64));
+
+	if      (format == Images::kPixelFormatDXT1)
+		Images::decompressDXT1(&out[0], in.data.get(), in.size, in.width, in.height, in.width * 4);
+	else if (format == Images::kPixelFormatDXT3)
+		Images::decompressDXT3(&out[0], in.data.get(), in.size, in.width, in.height, in.width * 4);
+	else if (format == Images::kPixelFormatDXT5)
+		Images::decompressDXT5(&out[0], in.data.get(), in.size, in.width, in.height, in.width * 4);
+}
+
+static void testDecompress(Images::PixelFormat format, size_t threads) {
+	const TestDecoder compressed(format, 6, 128, 256);
+
+	TestDecoder decompressed(compressed);
+
+	decompressed.decompress(threads);
+
+	EXPECT_EQ(decompressed.getFormat(), Images::kPixelFormatR8G8B8A8);
+
+	ASSERT_EQ(decompressed.getLayerCount() , compressed.getLayerCount());
+	ASSERT_EQ(decompressed.getMipMapCount(), compressed.getMipMapCount());
+
+	for (size_t l = 0; l < compressed.getLayerCount(); l++) {
+		for (size_t m = 0; m < compressed.getMipMapCount(); m++) {
+			const Images::Decoder::MipMap &mipMap = decompressed.getMipMap(m, l);
+
+			std::vector<byte> reference;
+			decompressReference(reference, compressed.getMipMap(m, l), format);
+
+			// Only compare the actual pixels, not the padding of tiny mip maps
+			ASSERT_EQ(mipMap.size, reference.size()) << "At layer " << l << ", mip map " << m;
+			ASSERT_EQ(std::memcmp(mipMap.data.get(), &reference[0], mipMap.width * mipMap.height * 4), 0)
+				<< "At layer " << l << ", mip map " << m;
+		}
+	}
+}
+
+GTEST_TEST(Decoder, decompressDXT1) {
+	testDecompress(Images::kPixelFormatDXT1, 1);
+}
+
+GTEST_TEST(Decoder, decompressDXT5) {
+	testDecompress(Images::kPixelFormatDXT5, 1);
+}
+
+GTEST_TEST(Decoder, decompressDXT1Threaded) {
+	testDecompress(Images::kPixelFormatDXT1, 4);
+}
+
+GTEST_TEST(Decoder, decompressDXT3Threaded) {
+	testDecompress(Images::kPixelFormatDXT3, 4);
+}
+
+GTEST_TEST(Decoder, decompressDXT5Threaded) {
+	testDecompress(Images::kPixelFormatDXT5, 4);
+}
+
+GTEST_TEST(Decoder, dropUnusedMipMaps) {
+	const TestDecoder full(Images::kPixelFormatDXT1, 6, 32, 64);
+	ASSERT_EQ(full.getMipMapCount(), 6);
+
+	for (int level = 0; level < 6; level++) {
+		TestDecoder image(full);
+
+		image.dropUnusedMipMaps(level);
+
+		ASSERT_EQ(image.getLayerCount() , 6);
+		ASSERT_EQ(image.getMipMapCount(), 1);
+
+		for (size_t l = 0; l < 6; l++) {
+			const Images::Decoder::MipMap &mipMap = image.getMipMap(0, l);
+			const Images::Decoder::MipMap &fullMipMap = full.getMipMap(level, l);
+
+			EXPECT_EQ(mipMap.width , fullMipMap.width);
+			EXPECT_EQ(mipMap.height, fullMipMap.height);
+
+			ASSERT_EQ(mipMap.size, fullMipMap.size);
+			EXPECT_EQ(std::memcmp(mipMap.data.get(), fullMipMap.data.get(), mipMap.size), 0)
+				<< "At level " << level << ", layer " << l;
+		}
+	}
+}
+
+GTEST_TEST(Decoder, dropUnusedMipMapsKeepAll) {
+	TestDecoder image(Images::kPixelFormatDXT1, 1, 32, 64);
+
+	image.dropUnusedMipMaps(-1);
+	EXPECT_EQ(image.getMipMapCount(), 6);
+}
+
+GTEST_TEST(Decoder, dropUnusedMipMapsInvalid) {
+	TestDecoder image(Images::kPixelFormatDXT1, 1, 32, 64);
+
+	EXPECT_THROW(image.dropUnusedMipMaps(6), Common::Exception);
+
+	EXPECT_EQ(image.getMipMapCount(), 6);
+}
+
+/** Create a standard DDS with a single uncompressed, random B8G8R8A8 mip map. */
+static std::vector<byte> createDDS(uint32 width, uint32 height) {
+	Common::MemoryWriteStreamDynamic dds(true);
+
+	dds.writeUint32BE(MKTAG('D', 'D', 'S', ' '));
+	dds.writeUint32LE(124);
+	dds.writeUint32LE(0x00001007);
+	dds.writeUint32LE(height);
+	dds.writeUint32LE(width);
+	dds.writeZeros(4 + 4 + 4 + 44);
+
+	dds.writeUint32LE(32);
+	dds.writeUint32LE(0x00000041);
+	dds.writeUint32LE(0);
+	dds.writeUint32LE(32);
+	dds.writeUint32LE(0x00FF0000);
+	dds.writeUint32LE(0x0000FF00);
+	dds.writeUint32LE(0x000000FF);
+	dds.writeUint32LE(0xFF000000);
+
+	dds.writeZeros(16 + 4);
+
+	std::srand(width * height);
+	for (uint32 i = 0; i < (width * height * 4); i++)
+		dds.writeByte(std::rand() & 0xFF);
+
+	return std::vector<byte>(dds.getData(), dds.getData() + dds.size());
+}
+
+GTEST_TEST(Decoder, borrowedMipMaps) {
+	const std::vector<byte> file = createDDS(16, 8);
+
+	Images::DDS dds(new Common::MemoryReadStream(&file[0], file.size()));
+
+	const Images::Decoder::MipMap &mipMap = dds.getMipMap(0);
+	ASSERT_EQ(mipMap.size, 16 * 8 * 4);
+
+	// The pixel data is used right out of the stream's memory
+	EXPECT_FALSE(mipMap.data);
+	EXPECT_EQ(mipMap.getData(), &file[128]);
+}
+
+GTEST_TEST(Decoder, borrowedMipMapsCopied) {
+	const std::vector<byte> file = createDDS(16, 8);
+
+	// We don't own the stream, so the pixel data needs to be copied
+	Common::MemoryReadStream stream(&file[0], file.size());
+	Images::DDS dds(stream);
+
+	const Images::Decoder::MipMap &mipMap = dds.getMipMap(0);
+	ASSERT_EQ(mipMap.size, 16 * 8 * 4);
+
+	EXPECT_TRUE(mipMap.data);
+	EXPECT_EQ(mipMap.getData(), mipMap.data.get());
+	EXPECT_EQ(std::memcmp(mipMap.getData(), &file[128], mipMap.size), 0);
+}
+
+GTEST_TEST(Decoder, borrowedMipMapsFlip) {
+	const std::vector<byte> file = createDDS(16, 8);
+	const std::vector<byte> original = file;
+
+	Images::DDS dds(new Common::MemoryReadStream(&file[0], file.size()));
+
+	dds.flipVertically();
+
+	// Modifying the image copies the data, leaving the stream's memory alone
+	const Images::Decoder::MipMap &mipMap = dds.getMipMap(0);
+	ASSERT_TRUE(mipMap.data);
+
+	EXPECT_TRUE(file == original);
+
+	for (int y = 0; y < 8; y++)
+		EXPECT_EQ(std::memcmp(mipMap.getData() + y * 16 * 4, &file[128 + (7 - y) * 16 * 4], 16 * 4), 0) <<
+			"At row " << y;
+}
+
+GTEST_TEST(Decoder, borrowedMipMapsCopyDecoder) {
+	const std::vector<byte> file = createDDS(16, 8);
+
+	Images::DDS dds(new Common::MemoryReadStream(&file[0], file.size()));
+
+	// A copy of the image owns its data, so it can outlive the stream
+	const Images::Decoder copy(dds);
+
+	const Images::Decoder::MipMap &mipMap = copy.getMipMap(0);
+	ASSERT_EQ(mipMap.size, 16 * 8 * 4);
+
+	EXPECT_TRUE(mipMap.data);
+	EXPECT_EQ(std::memcmp(mipMap.getData(), &file[128], mipMap.size), 0);
+}
+
+GTEST_TEST(Decoder, loadMipMap) {
+	const std::vector<byte> file = createDDS(16, 8);
+
+	Images::DDS dds(new Common::MemoryReadStream(&file[0], file.size()), 0);
+	EXPECT_EQ(dds.getMipMapCount(), 1);
+
+	EXPECT_THROW(Images::DDS(new Common::MemoryReadStream(&file[0], file.size()), 1), Common::Exception);
+}
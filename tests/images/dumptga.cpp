@@ -0,0 +1,196 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our TGA image dumper.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/images/decoder.h"
+#include "src/images/dumptga.h"
+#include "src/images/util.h"
+#include "src/images/tga.h"
+
+/** An image decoder with a single random mip map in a certain format. */
+class TestDecoder : public Images::Decoder {
+public:
+	TestDecoder(Images::PixelFormat format, int width, int height, bool runs = false) {
+		_format = format;
+
+		_mipMaps.push_back(new MipMap);
+
+		MipMap &mipMap = *_mipMaps.back();
+
+		mipMap.width  = width;
+		mipMap.height = height;
+		mipMap.size   = width * height * Images::getBPP(format);
+
+		mipMap.data.reset(new byte[mipMap.size]);
+
+		std::srand(width * height);
+		for (uint32 i = 0; i < mipMap.size; i++)
+			mipMap.data[i] = std::rand() & 0xFF;
+
+		// Create runs of equal pixels of all kinds of lengths
+		if (runs) {
+			const int bpp = Images::getBPP(format);
+
+			for (uint32 i = bpp; i < mipMap.size; i += bpp)
+				if ((std::rand() % 8) != 0)
+					std::memcpy(&mipMap.data[i], &mipMap.data[i - bpp], bpp);
+		}
+	}
+};
+
+/** Convert a pixel the way dumpTGA() always used to, one byte at a time. */
+static void convertPixel(byte *dest, const byte *&data, Images::PixelFormat format) {
+	if (format == Images::kPixelFormatR8G8B8) {
+		dest[0] = data[2]; dest[1] = data[1]; dest[2] = data[0]; dest[3] = 0xFF;
+		data += 3;
+	} else if (format == Images::kPixelFormatB8G8R8) {
+		dest[0] = data[0]; dest[1] = data[1]; dest[2] = data[2]; dest[3] = 0xFF;
+		data += 3;
+	} else if (format == Images::kPixelFormatR8G8B8A8) {
+		dest[0] = data[2]; dest[1] = data[1]; dest[2] = data[0]; dest[3] = data[3];
+		data += 4;
+	} else if (format == Images::kPixelFormatB8G8R8A8) {
+		dest[0] = data[0]; dest[1] = data[1]; dest[2] = data[2]; dest[3] = data[3];
+		data += 4;
+	} else if (format == Images::kPixelFormatR5G6B5) {
+		const uint16 color = READ_LE_UINT16(data);
+		dest[0] =  color & 0x001F;
+		dest[1] = (color & 0x07E0) >>  5;
+		dest[2] = (color & 0xF800) >> 11;
+		dest[3] = 0xFF;
+		data += 2;
+	} else if (format == Images::kPixelFormatA1R5G5B5) {
+		const uint16 color = READ_LE_UINT16(data);
+		dest[0] =  color & 0x001F;
+		dest[1] = (color & 0x03E0) >>  5;
+		dest[2] = (color & 0x7C00) >> 10;
+		dest[3] = (color & 0x8000) ? 0xFF : 0x00;
+		data += 2;
+	} else if (format == Images::kPixelFormatDepth16) {
+		const uint16 color = READ_LE_UINT16(data);
+		dest[0] = dest[1] = dest[2] = color / 128;
+		dest[3] = (color >= 0x7FFF) ? 0x00 : 0xFF;
+		data += 2;
+	}
+}
+
+static const Images::PixelFormat kFormats[] = {
+	Images::kPixelFormatR8G8B8  , Images::kPixelFormatB8G8R8  , Images::kPixelFormatR8G8B8A8,
+	Images::kPixelFormatB8G8R8A8, Images::kPixelFormatR5G6B5  , Images::kPixelFormatA1R5G5B5,
+	Images::kPixelFormatDepth16
+};
+
+static const byte kHeader[] = {
+	0x00,0x00,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x05,0x00,
+	0x20,0x00
+};
+
+GTEST_TEST(DumpTGA, header) {
+	const TestDecoder image(Images::kPixelFormatB8G8R8A8, 7, 5);
+
+	Common::MemoryWriteStreamDynamic tga(true);
+	Images::dumpTGA(tga, image);
+
+	ASSERT_EQ(tga.size(), sizeof(kHeader) + 7 * 5 * 4);
+
+	for (size_t i = 0; i < sizeof(kHeader); i++)
+		EXPECT_EQ(tga.getData()[i], kHeader[i]) << "At index " << i;
+}
+
+GTEST_TEST(DumpTGA, convert) {
+	for (size_t f = 0; f < ARRAYSIZE(kFormats); f++) {
+		const TestDecoder image(kFormats[f], 13, 7);
+
+		Common::MemoryWriteStreamDynamic tga(true);
+		Images::dumpTGA(tga, image);
+
+		ASSERT_EQ(tga.size(), sizeof(kHeader) + 13 * 7 * 4) << "At format " << kFormats[f];
+
+		const byte *data   = image.getMipMap(0).data.get();
+		const byte *pixels = tga.getData() + sizeof(kHeader);
+
+		for (size_t i = 0; i < 13 * 7; i++, pixels += 4) {
+			byte pixel[4];
+			convertPixel(pixel, data, kFormats[f]);
+
+			for (size_t j = 0; j < 4; j++)
+				ASSERT_EQ(pixels[j], pixel[j]) << "At format " << kFormats[f] << ", pixel " << i;
+		}
+	}
+}
+
+GTEST_TEST(DumpTGA, rle) {
+	for (size_t f = 0; f < ARRAYSIZE(kFormats); f++) {
+		const TestDecoder image(kFormats[f], 300, 9, true);
+
+		Common::MemoryWriteStreamDynamic raw(true), rle(true);
+		Images::dumpTGA(raw, image, false);
+		Images::dumpTGA(rle, image, true);
+
+		EXPECT_EQ(rle.getData()[2], 10);
+		EXPECT_LT(rle.size(), raw.size());
+
+		Common::MemoryReadStream rleStream(rle.getData(), rle.size());
+		const Images::TGA decoded(rleStream);
+
+		EXPECT_EQ(rleStream.pos(), rleStream.size());
+
+		const Images::Decoder::MipMap &mipMap = decoded.getMipMap(0);
+		ASSERT_EQ(mipMap.width , 300);
+		ASSERT_EQ(mipMap.height,   9);
+
+		ASSERT_EQ(std::memcmp(mipMap.data.get(), raw.getData() + sizeof(kHeader), 300 * 9 * 4), 0)
+			<< "At format " << kFormats[f];
+	}
+}
+
+GTEST_TEST(DumpTGA, unsupportedFormat) {
+	class CompressedDecoder : public Images::Decoder {
+	public:
+		CompressedDecoder() {
+			_format = Images::kPixelFormatDXT1;
+
+			_mipMaps.push_back(new MipMap);
+			_mipMaps.back()->width  = 4;
+			_mipMaps.back()->height = 4;
+			_mipMaps.back()->size   = 8;
+			_mipMaps.back()->data.reset(new byte[8]());
+		}
+	};
+
+	const CompressedDecoder compressed;
+
+	Common::MemoryWriteStreamDynamic compressedTGA(true);
+	EXPECT_THROW(Images::dumpTGA(compressedTGA, compressed), Common::Exception);
+	EXPECT_EQ(compressedTGA.size(), 0);
+}
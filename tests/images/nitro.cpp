@@ -0,0 +1,229 @@
+/* xoreos-tools - Tools to help with xoreos development
+ *
+ * xoreos-tools is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos-tools is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos-tools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos-tools. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our Nintendo DS (Nitro) graphics decoding helpers.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+
+#include "src/images/nitro.h"
+#include "src/images/ncgr.h"
+
+static void createPalette(byte *palette, bool is0Transp) {
+	for (size_t i = 0; i < 768; i++)
+		palette[i] = std::rand() & 0xF8;
+
+	if (is0Transp) {
+		palette[0] = 0xF8;
+		palette[1] = 0x00;
+		palette[2] = 0xF8;
+	}
+}
+
+/** Draw tiles the way NCGR and CBGT always used to, one pixel at a time. */
+static void drawTilesReference(byte *data, uint32 imageWidth, uint32 imagePos, const byte *tiles,
+                               uint32 tilesX, uint32 tilesY, uint8 depth, const byte *palette) {
+
+	const bool is0Transp = (palette[0] == 0xF8) && (palette[1] == 0x00) && (palette[2] == 0xF8);
+
+	size_t n = 0;
+	for (uint32 yT = 0; yT < tilesY; yT++) {
+		for (uint32 xT = 0; xT < tilesX; xT++) {
+			const uint32 tilePos = xT * 8 + yT * 8 * imageWidth;
+
+			for (uint32 y = 0; y < 8; y++) {
+				for (uint32 x = 0; x < 8; x++, n++) {
+					const uint32 pos = imagePos + tilePos + x + y * imageWidth;
+
+					uint8 pixel = tiles[n * depth / 8];
+					if (depth == 4)
+						pixel = (n & 1) ? (pixel >> 4) : (pixel & 0x0F);
+
+					data[pos * 4 + 0] = palette[pixel * 3 + 0];
+					data[pos * 4 + 1] = palette[pixel * 3 + 1];
+					data[pos * 4 + 2] = palette[pixel * 3 + 2];
+					data[pos * 4 + 3] = ((pixel == 0) && is0Transp) ? 0x00 : 0xFF;
+				}
+			}
+		}
+	}
+}
+
+static void testDrawTiles(uint8 depth, bool is0Transp) {
+	std::srand(depth + (is0Transp ? 1 : 0));
+
+	const uint32 imageWidth  = 48;
+	const uint32 imageHeight = 40;
+	const uint32 tilesX      = 4;
+	const uint32 tilesY      = 3;
+
+	// Put the block somewhere into the middle of the image
+	const uint32 imagePos = 8 * imageWidth + 16;
+
+	byte palette[768];
+	createPalette(palette, is0Transp);
+
+	std::vector<byte> tiles(tilesX * tilesY * Images::getNitroTileSize(depth));
+	for (size_t i = 0; i < tiles.size(); i++)
+		tiles[i] = std::rand() & 0xFF;
+
+	// Make sure index 0 is in there, for the transparency
+	tiles[0] = 0x00;
+
+	std::vector<byte> reference(imageWidth * imageHeight * 4, 0x55);
+	std::vector<byte> data     (imageWidth * imageHeight * 4, 0x55);
+
+	drawTilesReference(&reference[0], imageWidth, imagePos, &tiles[0], tilesX, tilesY, depth, palette);
+
+	byte expandedPalette[Images::kNitroPaletteSize];
+	Images::expandNitroPalette(expandedPalette, palette);
+
+	Images::drawNitroTiles(&data[0] + imagePos * 4, imageWidth * 4, &tiles[0], tilesX, tilesY,
+	                       depth, expandedPalette);
+
+	for (size_t i = 0; i < data.size(); i++)
+		if (data[i] != reference[i])
+			FAIL() << "Depth " << (uint)depth << ", transparency " << is0Transp << ", byte " << i;
+}
+
+GTEST_TEST(NitroImages, expandNitroPalette) {
+	byte palette[768];
+	createPalette(palette, false);
+
+	byte expandedPalette[Images::kNitroPaletteSize];
+	Images::expandNitroPalette(expandedPalette, palette);
+
+	for (size_t i = 0; i < 256; i++) {
+		EXPECT_EQ(expandedPalette[i * 4 + 0], palette[i * 3 + 0]) << "At index " << i;
+		EXPECT_EQ(expandedPalette[i * 4 + 1], palette[i * 3 + 1]) << "At index " << i;
+		EXPECT_EQ(expandedPalette[i * 4 + 2], palette[i * 3 + 2]) << "At index " << i;
+		EXPECT_EQ(expandedPalette[i * 4 + 3], 0xFF) << "At index " << i;
+	}
+}
+
+GTEST_TEST(NitroImages, expandNitroPaletteTransparent) {
+	byte palette[768];
+	createPalette(palette, true);
+
+	byte expandedPalette[Images::kNitroPaletteSize];
+	Images::expandNitroPalette(expandedPalette, palette);
+
+	EXPECT_EQ(expandedPalette[3], 0x00);
+
+	for (size_t i = 1; i < 256; i++)
+		EXPECT_EQ(expandedPalette[i * 4 + 3], 0xFF) << "At index " << i;
+}
+
+GTEST_TEST(NitroImages, drawNitroTiles8) {
+	testDrawTiles(8, false);
+	testDrawTiles(8, true);
+}
+
+GTEST_TEST(NitroImages, drawNitroTiles4) {
+	testDrawTiles(4, false);
+	testDrawTiles(4, true);
+}
+
+GTEST_TEST(NitroImages, drawNitroTilesInvalidDepth) {
+	byte tiles[16] = { 0 }, palette[Images::kNitroPaletteSize] = { 0 }, data[8 * 8 * 4];
+
+	EXPECT_THROW(Images::drawNitroTiles(data, 8 * 4, tiles, 1, 1, 2, palette), Common::Exception);
+}
+
+GTEST_TEST(NitroImages, drawNitroPixels) {
+	byte palette[768];
+	createPalette(palette, true);
+
+	byte expandedPalette[Images::kNitroPaletteSize];
+	Images::expandNitroPalette(expandedPalette, palette);
+
+	byte pixels[256];
+	for (size_t i = 0; i < sizeof(pixels); i++)
+		pixels[i] = 255 - i;
+
+	byte data[256 * 4];
+	Images::drawNitroPixels(data, pixels, sizeof(pixels), expandedPalette);
+
+	for (size_t i = 0; i < sizeof(pixels); i++)
+		EXPECT_EQ(std::memcmp(data + i * 4, expandedPalette + pixels[i] * 4, 4), 0) << "At index " << i;
+}
+
+// A 16x8 NCGR with 4-bit graphics, in two tiles
+static const byte kNCGR4[] = {
+	'R','G','C','N', 0xFF,0xFE, 0x01,0x01, 0x70,0x00,0x00,0x00, 0x10,0x00, 0x01,0x00,
+	'R','A','H','C', 0x60,0x00,0x00,0x00, 0x01,0x00, 0x02,0x00, 0x03,0x00,0x00,0x00,
+	0x00,0x00,0x00,0x00, 0x00, 0x00, 0x00,0x00, 0x40,0x00,0x00,0x00, 0x18,0x00,0x00,0x00,
+	0x10,0x32,0x54,0x76, 0x98,0xBA,0xDC,0xFE, 0x10,0x32,0x54,0x76, 0x98,0xBA,0xDC,0xFE,
+	0x10,0x32,0x54,0x76, 0x98,0xBA,0xDC,0xFE, 0x10,0x32,0x54,0x76, 0x98,0xBA,0xDC,0xFE,
+	0xFF,0xFF,0xFF,0xFF, 0xEE,0xEE,0xEE,0xEE, 0xDD,0xDD,0xDD,0xDD, 0xCC,0xCC,0xCC,0xCC,
+	0xBB,0xBB,0xBB,0xBB, 0xAA,0xAA,0xAA,0xAA, 0x99,0x99,0x99,0x99, 0x88,0x88,0x88,0x88
+};
+
+// A palette of 16 colors, with a transparent color 0
+static const byte kNCLR4[] = {
+	'R','L','C','N', 0xFF,0xFE, 0x00,0x01, 0x48,0x00,0x00,0x00, 0x10,0x00, 0x01,0x00,
+	'T','T','L','P', 0x38,0x00,0x00,0x00, 0x03,0x00, 0x00,0x00,0x00,0x00,0x00,0x00,
+	0x20,0x00,0x00,0x00, 0x10,0x00,0x00,0x00,
+	0x1F,0x7C, 0x01,0x00, 0x02,0x00, 0x03,0x00, 0x04,0x00, 0x05,0x00, 0x06,0x00, 0x07,0x00,
+	0x08,0x00, 0x09,0x00, 0x0A,0x00, 0x0B,0x00, 0x0C,0x00, 0x0D,0x00, 0x0E,0x00, 0x0F,0x00
+};
+
+GTEST_TEST(NitroImages, NCGR4) {
+	Common::MemoryReadStream ncgr(kNCGR4);
+	Common::MemoryReadStream nclr(kNCLR4);
+
+	const Images::NCGR image(ncgr, nclr);
+
+	ASSERT_EQ(image.getMipMapCount(), 1);
+
+	const Images::Decoder::MipMap &mipMap = image.getMipMap(0);
+	ASSERT_EQ(mipMap.width , 16);
+	ASSERT_EQ(mipMap.height,  8);
+
+	for (int y = 0; y < 8; y++) {
+		for (int x = 0; x < 16; x++) {
+			// The first tile counts up in every row, the second has a color per row
+			const byte index = (x < 8) ? (y & 1) * 8 + x : 15 - y;
+
+			const byte *pixel = mipMap.data.get() + (y * 16 + x) * 4;
+			if (index == 0) {
+				EXPECT_EQ(pixel[0], 0xF8) << "At " << x << "x" << y;
+				EXPECT_EQ(pixel[1], 0x00) << "At " << x << "x" << y;
+				EXPECT_EQ(pixel[2], 0xF8) << "At " << x << "x" << y;
+				EXPECT_EQ(pixel[3], 0x00) << "At " << x << "x" << y;
+			} else {
+				EXPECT_EQ(pixel[0], 0x00) << "At " << x << "x" << y;
+				EXPECT_EQ(pixel[1], 0x00) << "At " << x << "x" << y;
+				EXPECT_EQ(pixel[2], index << 3) << "At " << x << "x" << y;
+				EXPECT_EQ(pixel[3], 0xFF) << "At " << x << "x" << y;
+			}
+		}
+	}
+}
@@ -36,3 +36,36 @@ check_PROGRAMS                       += tests/images/test_xoreositex
 tests_images_test_xoreositex_SOURCES  = tests/images/xoreositex.cpp
 tests_images_test_xoreositex_LDADD    = $(images_LIBS)
 tests_images_test_xoreositex_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                 += tests/images/test_s3tc
+tests_images_test_s3tc_SOURCES  = tests/images/s3tc.cpp
+tests_images_test_s3tc_LDADD    = $(images_LIBS)
+tests_images_test_s3tc_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/images/test_decoder
+tests_images_test_decoder_SOURCES  = tests/images/decoder.cpp
+tests_images_test_decoder_LDADD    = $(images_LIBS)
+tests_images_test_decoder_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/images/test_dumptga
+tests_images_test_dumptga_SOURCES  = tests/images/dumptga.cpp
+tests_images_test_dumptga_LDADD    = $(images_LIBS)
+tests_images_test_dumptga_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                  += tests/images/test_nitro
+tests_images_test_nitro_SOURCES  = tests/images/nitro.cpp
+tests_images_test_nitro_LDADD    = $(images_LIBS)
+tests_images_test_nitro_CXXFLAGS = $(test_CXXFLAGS)
+
+# Benchmark of the image decoders. As a unit test, it only runs each stage once
+check_PROGRAMS                    += tests/images/benchmark
+tests_images_benchmark_SOURCES     = tests/images/benchmark.cpp
+tests_images_benchmark_LDADD       = \
+    $(benchmark_LIBS) \
+    src/images/libimages.la \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD) \
+    $(EMPTY)
+tests_images_benchmark_CXXFLAGS    = $(AM_CXXFLAGS)
@@ -24,6 +24,8 @@
 
 #include <cstring>
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "src/common/error.h"
@@ -479,3 +481,43 @@ GTEST_TEST(ImagesUtil, deSwizzleOffset) {
 	for (size_t i = 0; i < (kWidth * kHeight); i++)
 		EXPECT_EQ(buffer[i], kSwizzled[i]) << "At index " << i;
 }
+
+/** Check deSwizzle() against deSwizzleOffset() on an image with pixels holding their own index. */
+static void testDeSwizzle(uint32 width, uint32 height, uint32 bpp, std::vector<byte> &src, std::vector<byte> &dst) {
+	const size_t size = width * height * bpp;
+
+	src.resize(size);
+	dst.resize(size);
+
+	for (uint32 i = 0; i < (width * height); i++)
+		for (uint32 j = 0; j < bpp; j++)
+			src[i * bpp + j] = (i >> (j * 8)) & 0xFF;
+
+	Images::deSwizzle(&dst[0], &src[0], width, height, bpp);
+
+	const byte *pixel = &dst[0];
+	for (uint32 y = 0; y < height; y++) {
+		for (uint32 x = 0; x < width; x++, pixel += bpp) {
+			const uint32 offset = Images::deSwizzleOffset(x, y, width, height) * bpp;
+
+			if (std::memcmp(pixel, &src[offset], bpp) != 0)
+				FAIL() << "At " << width << "x" << height << "x" << bpp << ", pixel " << x << ", " << y;
+		}
+	}
+}
+
+GTEST_TEST(ImagesUtil, deSwizzle) {
+	std::vector<byte> src, dst;
+
+	for (uint32 width = 1; width <= 4096; width *= 2)
+		for (uint32 height = 1; height <= 4096; height *= 2)
+			testDeSwizzle(width, height, 4, src, dst);
+
+	for (uint32 width = 1; width <= 256; width *= 2)
+		for (uint32 height = 1; height <= 256; height *= 2)
+			testDeSwizzle(width, height, 3, src, dst);
+
+	// Images with a non-power-of-two height only use part of the y bits
+	testDeSwizzle(32,  3, 4, src, dst);
+	testDeSwizzle(64, 24, 3, src, dst);
+}
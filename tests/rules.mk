@@ -36,8 +36,10 @@ noinst_HEADERS += \
     $(EMPTY)
 
 include tests/version/rules.mk
+include tests/benchmark/rules.mk
 include tests/common/rules.mk
 include tests/aurora/rules.mk
+include tests/archives/rules.mk
 include tests/images/rules.mk
 include tests/xml/rules.mk
 
@@ -31,3 +31,13 @@ check_PROGRAMS                   += tests/xml/test_xmlparser
 tests_xml_test_xmlparser_SOURCES  = tests/xml/xmlparser.cpp
 tests_xml_test_xmlparser_LDADD    = $(xml_LIBS)
 tests_xml_test_xmlparser_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                   += tests/xml/test_xmlreader
+tests_xml_test_xmlreader_SOURCES  = tests/xml/xmlreader.cpp
+tests_xml_test_xmlreader_LDADD    = $(xml_LIBS)
+tests_xml_test_xmlreader_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                   += tests/xml/test_xmlwriter
+tests_xml_test_xmlwriter_SOURCES  = tests/xml/xmlwriter.cpp
+tests_xml_test_xmlwriter_LDADD    = $(xml_LIBS)
+tests_xml_test_xmlwriter_CXXFLAGS = $(test_CXXFLAGS)
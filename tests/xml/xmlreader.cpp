@@ -0,0 +1,148 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our streaming XML reader.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+
+#include "src/xml/xmlreader.h"
+
+static const char *kXML =
+	"<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n"
+	"<foo>\n"
+	"  <node1></node1>\n"
+	"  <node2/>\n"
+	"  <node3 prop1=\"foo\" prop2=\"bar\"/>\n"
+	"  <node4>blubb</node4>\n"
+	"  <node5><node6>skipped</node6></node5>\n"
+	"  <NoDE7></NoDE7>\n"
+	"  <node8>foobar&apos;s barfoo</node8>\n"
+	"</foo>";
+
+static const char *kXMLBroken =
+	"<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n"
+	"<foo>\n"
+	"  <node1></node5>\n"
+	"</foo>";
+
+static const char * const kFirstChildNodes[] =
+	{ "node1", "node2", "node3", "node4", "node5", "NoDE7", "node8" };
+
+GTEST_TEST(XMLReader, readRoot) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	xml.readRoot();
+
+	EXPECT_TRUE(xml.isStartTag());
+	EXPECT_EQ(xml.getDepth(), 0);
+	EXPECT_STREQ(xml.getName().c_str(), "foo");
+}
+
+GTEST_TEST(XMLReader, readChild) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	xml.readRoot();
+
+	size_t n = 0;
+	while (xml.readChild(0)) {
+		ASSERT_LT(n, ARRAYSIZE(kFirstChildNodes));
+
+		EXPECT_EQ(xml.getDepth(), 1);
+		EXPECT_STREQ(xml.getName().c_str(), kFirstChildNodes[n++]);
+	}
+
+	EXPECT_EQ(n, ARRAYSIZE(kFirstChildNodes));
+
+	EXPECT_TRUE(xml.isEndTag());
+	EXPECT_STREQ(xml.getName().c_str(), "foo");
+
+	EXPECT_FALSE(xml.next());
+}
+
+GTEST_TEST(XMLReader, makeLower) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream, true);
+
+	xml.readRoot();
+
+	while (xml.readChild(0))
+		EXPECT_STRNE(xml.getName().c_str(), "NoDE7");
+}
+
+GTEST_TEST(XMLReader, getProperty) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	xml.readRoot();
+
+	bool found = false;
+	while (xml.readChild(0)) {
+		if (xml.getName() != "node3")
+			continue;
+
+		found = true;
+
+		EXPECT_STREQ(xml.getProperty("prop1").c_str(), "foo");
+		EXPECT_STREQ(xml.getProperty("prop2").c_str(), "bar");
+		EXPECT_STREQ(xml.getProperty("prop3", "def").c_str(), "def");
+	}
+
+	EXPECT_TRUE(found);
+}
+
+GTEST_TEST(XMLReader, readText) {
+	Common::MemoryReadStream stream(kXML);
+	XML::XMLReader xml(stream);
+
+	xml.readRoot();
+
+	while (xml.readChild(0)) {
+		const Common::UString name = xml.getName();
+		const Common::UString text = xml.readText();
+
+		EXPECT_TRUE(xml.isEndTag()) << "With node \"" << name.c_str() << "\"";
+		EXPECT_STREQ(xml.getName().c_str(), name.c_str());
+
+		if      (name == "node4")
+			EXPECT_STREQ(text.c_str(), "blubb");
+		else if (name == "node8")
+			EXPECT_STREQ(text.c_str(), "foobar's barfoo");
+		else
+			EXPECT_TRUE(text.empty()) << "With node \"" << name.c_str() << "\"";
+	}
+}
+
+GTEST_TEST(XMLReader, broken) {
+	Common::MemoryReadStream stream(kXMLBroken);
+	XML::XMLReader xml(stream);
+
+	EXPECT_THROW({
+		xml.readRoot();
+		while (xml.readChild(0))
+			;
+	}, Common::Exception);
+}
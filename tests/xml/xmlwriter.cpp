@@ -0,0 +1,139 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our XML writer.
+ */
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memwritestream.h"
+
+#include "src/xml/xmlwriter.h"
+
+static const char *kHeader = "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n";
+
+static std::string getString(Common::MemoryWriteStreamDynamic &stream) {
+	return std::string(reinterpret_cast<const char *>(stream.getData()), stream.size());
+}
+
+GTEST_TEST(XMLWriter, header) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+	}
+
+	EXPECT_EQ(getString(stream), kHeader);
+}
+
+GTEST_TEST(XMLWriter, tags) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.addProperty("prop", "bar");
+		xml.breakLine();
+
+		xml.openTag("empty");
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.openTag("text");
+		xml.setContents("blubb");
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.closeTag();
+		xml.breakLine();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kHeader) +
+		"<foo prop=\"bar\">\n"
+		"  <empty/>\n"
+		"  <text>blubb</text>\n"
+		"</foo>\n");
+}
+
+GTEST_TEST(XMLWriter, escape) {
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.addProperty("prop", "\"a\" & 'b'");
+		xml.setContents("<c>\r");
+		xml.closeTag();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kHeader) +
+		"<foo prop=\"&quot;a&quot; &amp; &apos;b&apos;\">&lt;c&gt;&#13;</foo>");
+}
+
+GTEST_TEST(XMLWriter, base64) {
+	static const byte kShort[] = { 'f', 'o', 'o', 'b' };
+
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.setContents(kShort, sizeof(kShort));
+		xml.closeTag();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kHeader) + "<foo>Zm9vYg==</foo>");
+}
+
+GTEST_TEST(XMLWriter, base64Lines) {
+	byte data[60];
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = 'a';
+
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	{
+		XML::XMLWriter xml(stream);
+
+		xml.openTag("foo");
+		xml.breakLine();
+
+		xml.openTag("bar");
+		xml.setContents(data, sizeof(data));
+		xml.closeTag();
+		xml.breakLine();
+
+		xml.closeTag();
+	}
+
+	EXPECT_EQ(getString(stream), std::string(kHeader) +
+		"<foo>\n"
+		"  <bar>\n"
+		"    YWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFhYWFh\n"
+		"    YWFhYWFhYWFhYWFh\n"
+		"  </bar>\n"
+		"</foo>");
+}